@@ -0,0 +1,194 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: arena.c
+  Created: 2026-10-19
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file arena.c
+
+#include <stdlib.h> // malloc, aligned_alloc, free
+#include <string.h> // memset, memcpy
+#include <stdio.h> // fprintf, printf
+#include <stdint.h> // SIZE_MAX
+
+#include "arena.h"
+
+//! Bytes at the start of each block holding its struct arena_block.
+#define ARENA_HEADER_SIZE ((sizeof(struct arena_block) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+//! \brief Round a size up to a multiple of ARENA_ALIGNMENT
+//!
+//! \param[in] size bytes to round
+//! \param[out] rounded the rounded size
+//! \return 1 on success, or 0 if the rounded size doesn't fit in a size_t
+int ArenaRoundSize(size_t size, size_t *rounded) {
+        if (size > SIZE_MAX - ARENA_HEADER_SIZE - (ARENA_ALIGNMENT - 1)) {
+                return 0;
+        }
+        *rounded = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+        return 1;
+}
+
+//! \brief Chain a new block onto an arena
+//!
+//! The block holds at least as much as every other block put together, so
+//! an arena that keeps overflowing needs few blocks.
+//!
+//! \param[in,out] arena the arena to add to
+//! \param[in] size bytes the block must hold; a multiple of ARENA_ALIGNMENT
+//! \return the new block, now the one being allocated from, or NULL if it couldn't be allocated
+struct arena_block *ArenaAddBlock(struct arena *arena, size_t size) {
+        if (size < arena->blockSize) {
+                size = arena->blockSize;
+        }
+        if (size < arena->reserved) {
+                size = arena->reserved;
+        }
+        if (size > SIZE_MAX - ARENA_HEADER_SIZE) {
+                fprintf(stderr, "Arena block of %zu bytes is too large\n", size);
+                return NULL;
+        }
+
+        unsigned char *memory = (unsigned char *)aligned_alloc(ARENA_ALIGNMENT, ARENA_HEADER_SIZE + size);
+        if (NULL == memory) {
+                fprintf(stderr, "Couldn't allocate an arena block of %zu bytes\n", size);
+                return NULL;
+        }
+
+        struct arena_block *block = (struct arena_block *)memory;
+        block->next = arena->blocks;
+        block->size = size;
+        block->used = 0;
+        block->data = memory + ARENA_HEADER_SIZE;
+
+        arena->blocks = block;
+        arena->reserved += size;
+        arena->blockAllocations++;
+        return block;
+}
+
+//! \brief Free every block of an arena
+//!
+//! \param[in,out] arena the arena to empty
+void ArenaFreeBlocks(struct arena *arena) {
+        struct arena_block *block = arena->blocks;
+        while (NULL != block) {
+                struct arena_block *next = block->next;
+                free(block);
+                block = next;
+        }
+        arena->blocks = NULL;
+        arena->reserved = 0;
+}
+
+//! \brief Count bytes newly allocated from an arena
+//!
+//! \param[in,out] arena the arena allocated from
+//! \param[in] size bytes allocated, including alignment padding
+void ArenaUse(struct arena *arena, size_t size) {
+        arena->used += size;
+        if (arena->used > arena->peak) {
+                arena->peak = arena->used;
+        }
+}
+
+struct arena *ArenaInit(size_t blockSize) {
+        struct arena *arena = (struct arena *)malloc(sizeof(struct arena));
+        memset(arena, 0, sizeof(struct arena));
+
+        if (!ArenaRoundSize(blockSize, &arena->blockSize)) {
+                arena->blockSize = 0;
+        }
+
+        return arena;
+}
+
+void ArenaDeinit(struct arena *arena) {
+        if (NULL == arena) {
+                return;
+        }
+
+        ArenaFreeBlocks(arena);
+        free(arena);
+}
+
+void *ArenaAlloc(struct arena *arena, size_t size) {
+        size_t rounded;
+        if (!ArenaRoundSize(size, &rounded)) {
+                fprintf(stderr, "Arena allocation of %zu bytes is too large\n", size);
+                return NULL;
+        }
+
+        struct arena_block *block = arena->blocks;
+        if (NULL == block || block->size - block->used < rounded) {
+                block = ArenaAddBlock(arena, rounded);
+                if (NULL == block) {
+                        return NULL;
+                }
+        }
+
+        void *ptr = block->data + block->used;
+        block->used += rounded;
+        ArenaUse(arena, rounded);
+        arena->last = ptr;
+        return ptr;
+}
+
+void *ArenaGrow(struct arena *arena, void *ptr, size_t oldSize, size_t newSize) {
+        if (NULL == ptr) {
+                return ArenaAlloc(arena, newSize);
+        }
+
+        size_t rounded;
+        if (!ArenaRoundSize(newSize, &rounded)) {
+                fprintf(stderr, "Arena allocation of %zu bytes is too large\n", newSize);
+                return NULL;
+        }
+
+        // The latest allocation always lies in the block being allocated from.
+        if (ptr == arena->last) {
+                struct arena_block *block = arena->blocks;
+                size_t offset = (size_t)((unsigned char *)ptr - block->data);
+                if (rounded <= block->size - offset) {
+                        if (offset + rounded > block->used) {
+                                ArenaUse(arena, offset + rounded - block->used);
+                                block->used = offset + rounded;
+                        }
+                        return ptr;
+                }
+        }
+
+        void *grown = ArenaAlloc(arena, newSize);
+        if (NULL != grown) {
+                memcpy(grown, ptr, oldSize < newSize ? oldSize : newSize);
+        }
+        return grown;
+}
+
+void ArenaReset(struct arena *arena) {
+        if (NULL != arena->blocks && NULL != arena->blocks->next) {
+                size_t reserved = arena->reserved;
+                ArenaFreeBlocks(arena);
+                ArenaAddBlock(arena, reserved);
+        } else if (NULL != arena->blocks) {
+                arena->blocks->used = 0;
+        }
+        arena->used = 0;
+        arena->last = NULL;
+}
+
+void ArenaDebug(struct arena *arena, char *name) {
+        printf("%s: %.1f KiB used, %.1f KiB peak, %.1f KiB reserved, %d block allocations\n",
+               name, (double)arena->used / 1024.0, (double)arena->peak / 1024.0,
+               (double)arena->reserved / 1024.0, arena->blockAllocations);
+}
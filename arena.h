@@ -0,0 +1,114 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: arena.h
+  Created: 2026-10-19
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file arena.h
+//! A growable linear allocator for memory that lives until the next reset.
+//!
+//! Allocations are bumped off the end of the current block, each starting on
+//! an ARENA_ALIGNMENT byte boundary. When a block runs out a new one is
+//! chained on; nothing is ever moved. Individual allocations can't be freed,
+//! only the whole arena at once.
+//!
+//! Each new block holds at least as much as all the others together. When a
+//! reset finds more than one block, they are replaced with a single block as
+//! large as all of them, so the arena's capacity doubles whenever it
+//! overflows, and once it has seen its largest workload, allocating never
+//! calls malloc. The most bytes allocated between any two resets is kept as
+//! the arena's peak.
+//!
+//! An arena may only be used by one thread at a time.
+
+#ifndef ARENA_VERSION
+#define ARENA_VERSION "0.1.0" //!< include guard
+
+#include <stddef.h> // size_t
+
+//! Alignment of every allocation and block, in bytes; one cache line.
+#define ARENA_ALIGNMENT 64
+
+//! \brief A block of memory allocations are bumped off
+struct arena_block {
+        struct arena_block *next; //!< the block filled before this one, or NULL
+        size_t size; //!< bytes available for allocations
+        size_t used; //!< bytes allocated, including alignment padding
+        unsigned char *data; //!< ARENA_ALIGNMENT aligned start of the allocations
+};
+
+//! \brief A growable linear allocator
+struct arena {
+        struct arena_block *blocks; //!< the block being allocated from, or NULL
+        size_t blockSize; //!< fewest bytes a new block holds
+        size_t used; //!< bytes allocated since the last reset, including alignment padding
+        size_t peak; //!< most bytes allocated between any two resets
+        size_t reserved; //!< bytes held by every block
+        void *last; //!< the latest allocation, which can grow in place
+        int blockAllocations; //!< blocks allocated since the arena was initialized
+};
+
+//! \brief Initialize an empty arena
+//!
+//! No memory is reserved until the first allocation.
+//!
+//! \param[in] blockSize fewest bytes to reserve whenever the arena runs out
+//! \return the initialized arena
+struct arena *
+ArenaInit(size_t blockSize);
+
+//! \brief De-initialize an arena, freeing every allocation made from it
+//!
+//! \param[in,out] arena the arena to de-initialize, or NULL
+void
+ArenaDeinit(struct arena *arena);
+
+//! \brief Allocate memory that lives until the next reset
+//!
+//! \param[in,out] arena the arena to allocate from
+//! \param[in] size bytes to allocate
+//! \return ARENA_ALIGNMENT aligned, uninitialized memory, or NULL if no more could be reserved
+void *
+ArenaAlloc(struct arena *arena, size_t size);
+
+//! \brief Resize an allocation, keeping its contents
+//!
+//! The latest allocation grows in place while its block has room; anything
+//! else is copied to a new allocation and the old one is wasted until the
+//! next reset.
+//!
+//! \param[in,out] arena the arena ptr was allocated from
+//! \param[in] ptr the allocation to resize, or NULL to allocate
+//! \param[in] oldSize bytes of ptr to keep
+//! \param[in] newSize bytes the allocation must hold
+//! \return the resized allocation, or NULL if no more could be reserved
+void *
+ArenaGrow(struct arena *arena, void *ptr, size_t oldSize, size_t newSize);
+
+//! \brief Free every allocation at once
+//!
+//! If the allocations since the last reset spilled over into more than one
+//! block, the blocks are replaced with one as large as all of them.
+//!
+//! \param[in,out] arena the arena to reset
+void
+ArenaReset(struct arena *arena);
+
+//! \brief Print an arena's usage
+//!
+//! \param[in] arena the arena to describe
+//! \param[in] name label printed with the usage
+void
+ArenaDebug(struct arena *arena, char *name);
+
+#endif // ARENA_VERSION
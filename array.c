@@ -0,0 +1,104 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: array.c
+  Created: 2026-10-19
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file array.c
+
+#include <stdlib.h> // malloc, realloc, free
+#include <string.h> // memset
+#include <stdio.h> // fprintf
+#include <limits.h> // INT_MAX
+#include <stdint.h> // SIZE_MAX
+
+#include "array.h"
+
+//! \brief Make room for more elements, doubling the storage as needed
+//!
+//! \param[in,out] array the array to grow
+//! \param[in] needed number of elements that must fit
+//! \return 1 on success, or 0 if the storage couldn't be grown
+int ArrayReserve(struct array *array, int needed) {
+        if (needed <= array->capacity) {
+                return 1;
+        }
+
+        int capacity = array->capacity > 0 ? array->capacity : 1;
+        while (capacity < needed) {
+                capacity = capacity > INT_MAX / 2 ? needed : capacity * 2;
+        }
+        if ((size_t)capacity > SIZE_MAX / array->elementSize) {
+                fprintf(stderr, "Array of %d elements of %zu bytes is too large\n", capacity, array->elementSize);
+                return 0;
+        }
+
+        unsigned char *data = (unsigned char *)realloc(array->data, array->elementSize * capacity);
+        if (NULL == data) {
+                fprintf(stderr, "Couldn't grow array to %d elements of %zu bytes\n", capacity, array->elementSize);
+                return 0;
+        }
+
+        array->data = data;
+        array->capacity = capacity;
+        return 1;
+}
+
+struct array *ArrayInit(size_t elementSize, int capacity) {
+        struct array *array = (struct array *)malloc(sizeof(struct array));
+        memset(array, 0, sizeof(struct array));
+        array->elementSize = elementSize > 0 ? elementSize : 1;
+
+        if (!ArrayReserve(array, capacity)) {
+                free(array);
+                return NULL;
+        }
+
+        return array;
+}
+
+void ArrayDeinit(struct array *array) {
+        if (NULL == array) {
+                return;
+        }
+
+        free(array->data);
+        free(array);
+}
+
+void *ArrayPush(struct array *array, int count) {
+        if (count < 0 || count > INT_MAX - array->count || !ArrayReserve(array, array->count + count)) {
+                return NULL;
+        }
+
+        void *first = array->data + array->elementSize * array->count;
+        array->count += count;
+        return first;
+}
+
+void *ArrayGet(struct array *array, int index) {
+        if (index < 0 || index >= array->count) {
+                return NULL;
+        }
+        return array->data + array->elementSize * index;
+}
+
+void ArrayTruncate(struct array *array, int count) {
+        if (count >= 0 && count < array->count) {
+                array->count = count;
+        }
+}
+
+void ArrayReset(struct array *array) {
+        array->count = 0;
+}
@@ -0,0 +1,84 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: array.h
+  Created: 2026-10-19
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file array.h
+//! A growable array of same-sized elements, handed out by pointer.
+//!
+//! Elements are never copied in or out: ArrayPush() returns the new slots for
+//! the caller to fill, and ArrayGet() returns a slot to read or modify in
+//! place. When the array is full its storage doubles, so it never wraps or
+//! overwrites anything. ArrayReset() empties the array but keeps its storage,
+//! so an array reused for work of the same size stops allocating.
+//!
+//! Growing moves the storage, which invalidates every pointer into the array.
+
+#ifndef ARRAY_VERSION
+#define ARRAY_VERSION "0.1.0" //!< include guard
+
+#include <stddef.h> // size_t
+
+//! \brief A growable array of same-sized elements
+struct array {
+        unsigned char *data; //!< capacity elements, the first count of which are in use
+        size_t elementSize; //!< bytes per element
+        int count;
+        int capacity;
+};
+
+//! \brief Initialize an empty array
+//!
+//! \param[in] elementSize bytes per element
+//! \param[in] capacity elements to make room for up front
+//! \return the initialized array, or NULL if its storage couldn't be allocated
+struct array *
+ArrayInit(size_t elementSize, int capacity);
+
+//! \brief De-initialize an array
+//!
+//! \param[in,out] array the array to de-initialize, or NULL
+void
+ArrayDeinit(struct array *array);
+
+//! \brief Append uninitialized elements
+//!
+//! \param[in,out] array the array to append to
+//! \param[in] count number of elements to append
+//! \return the first of the new elements, or NULL if the array couldn't grow
+void *
+ArrayPush(struct array *array, int count);
+
+//! \brief Find an element
+//!
+//! \param[in] array the array to read
+//! \param[in] index position of the element
+//! \return the element, or NULL if index is out of range
+void *
+ArrayGet(struct array *array, int index);
+
+//! \brief Drop every element from a position onwards
+//!
+//! \param[in,out] array the array to shorten
+//! \param[in] count number of elements to keep; no more than the array holds
+void
+ArrayTruncate(struct array *array, int count);
+
+//! \brief Drop every element, keeping the storage for reuse
+//!
+//! \param[in,out] array the array to empty
+void
+ArrayReset(struct array *array);
+
+#endif // ARRAY_VERSION
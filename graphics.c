@@ -4,7 +4,7 @@
 
   File: graphics.c
   Created: 2019-06-25
-  Updated: 2019-08-26
+  Updated: 2026-10-19
   Author: Aaron Oman
   Notice: GNU GPLv3 License
 
@@ -16,15 +16,26 @@
 
 //! \file graphics.c
 
-#include <string.h> // memset
-#include <stdio.h> // fprintf
+#include <string.h> // memset, memcpy
+#include <stdio.h> // fprintf, printf
+#include <stdlib.h> // malloc, realloc, free
+#include <math.h> // sqrtf, fabs, fmax, INFINITY
+#include <stdatomic.h> // atomic_*
+#include <pthread.h> // pthread_*
 
 #include "SDL2/SDL.h"
 
 #include "math.h"
 #include "graphics.h"
+#include "mesh.h"
+#include "job.h"
+#include "simd.h"
 #include "texture.h"
 #include "color.h"
+#include "arena.h"
+#include "array.h"
+
+#pragma GCC diagnostic ignored "-Wmissing-braces"
 
 //! \brief A mostly generic implementation of swap
 //!
@@ -42,6 +53,24 @@ void swap_generic(void *v1, void *v2, size_t size) {
         memmove(v2, temp, size);
 }
 
+//! \brief A run of a frame's sorted triangles queued for the raster thread
+struct graphics_batch {
+        struct graphics_frame *frame;
+        int first; //!< first triangle of frame->renderTris
+        int count; //!< number of triangles
+        int last; //!< 1 for the frame's final batch, otherwise 0
+};
+
+//! \brief Bounded single-producer, single-consumer queue of batches
+//!
+//! Only the producer writes tail and only the consumer writes head, each on a
+//! cache line of its own, so neither pushing nor popping ever takes a lock.
+struct graphics_batch_queue {
+        _Alignas(64) atomic_long head; //!< next batch to pop
+        _Alignas(64) atomic_long tail; //!< next slot to push into
+        struct graphics_batch batches[GRAPHICS_QUEUE_SIZE];
+};
+
 //! \brief Graphics state
 struct graphics {
         SDL_Window *window;
@@ -51,11 +80,43 @@ struct graphics {
         unsigned int height;
         unsigned int scale;
 
-        unsigned char *pixels;
+        unsigned char *pixels; //!< owned by the raster thread while rasterization is pipelined
         int bytesPerRow;
+
+        struct graphics_frame frames[GRAPHICS_MAX_LATENCY + 1]; //!< one per frame in flight, plus the one being built
+        struct graphics_frame *frame; //!< the frame being built
+        struct graphics_stages stages;
+        void (*latch)(void *data, struct graphics_view *view);
+        void *latchData;
+
+        struct job_system *jobs; //!< runs chunks in parallel, or NULL to run them on the calling thread
+        struct graphics_worker *workers; //!< one per thread that may run chunks
+        int workerCount;
+
+        int latency; //!< frames between ending a frame and presenting it
+        unsigned int frameNumber; //!< frames begun
+        unsigned int presentedNumber; //!< last frame presented
+        struct graphics_stats presentedStats; //!< stats of the last frame presented
+
+        // The raster thread and its queue, used while latency > 0.
+        // Frame i % (latency + 1) is drawn into framebuffers[i % (latency + 1)].
+        pthread_t rasterThread;
+        int rasterThreadStarted;
+        atomic_int running;
+        atomic_uint rasterized; //!< last frame the raster thread finished
+        atomic_int waiting; //!< threads sleeping on wake
+        pthread_mutex_t mutex;
+        pthread_cond_t wake;
+        struct graphics_batch_queue queue;
+        unsigned char *framebuffers[GRAPHICS_MAX_LATENCY + 1];
 };
 
 struct graphics *GraphicsInit(char *title, int width, int height, int scale) {
+        if (width > GRAPHICS_MAX_SCREEN_SIZE || height > GRAPHICS_MAX_SCREEN_SIZE) {
+                fprintf(stderr, "Screen size %dx%d is over %d pixels\n", width, height, GRAPHICS_MAX_SCREEN_SIZE);
+                return NULL;
+        }
+
         struct graphics *g = (struct graphics *)malloc(sizeof(struct graphics));
         memset(g, 0, sizeof(struct graphics));
 
@@ -63,6 +124,26 @@ struct graphics *GraphicsInit(char *title, int width, int height, int scale) {
         g->height = height;
         g->scale = scale;
 
+        for (int i = 0; i <= GRAPHICS_MAX_LATENCY; i++) {
+                g->frames[i].width = width;
+                g->frames[i].height = height;
+                g->frames[i].arena = ArenaInit(GRAPHICS_ARENA_BLOCK_SIZE);
+                g->frames[i].immediate = GraphicsCommandBufferInit(16, 16);
+        }
+        g->frame = &g->frames[0];
+        g->workers = (struct graphics_worker *)calloc(1, sizeof(struct graphics_worker));
+        g->workers[0].arena = ArenaInit(GRAPHICS_ARENA_BLOCK_SIZE);
+        g->workerCount = 1;
+        g->stages = GraphicsDefaultStages();
+
+        atomic_init(&g->running, 0);
+        atomic_init(&g->rasterized, 0);
+        atomic_init(&g->waiting, 0);
+        atomic_init(&g->queue.head, 0);
+        atomic_init(&g->queue.tail, 0);
+        pthread_mutex_init(&g->mutex, NULL);
+        pthread_cond_init(&g->wake, NULL);
+
         SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_EVENTS);
 
         g->window = SDL_CreateWindow(
@@ -94,11 +175,141 @@ struct graphics *GraphicsInit(char *title, int width, int height, int scale) {
         return g;
 }
 
+//! \brief Free everything a geometry worker has allocated
+//!
+//! \param[in,out] worker the worker to empty
+void GraphicsWorkerDeinit(struct graphics_worker *worker) {
+        ArenaDeinit(worker->arena);
+        free(worker->viewVerts);
+        free(worker->vertexStamp);
+        free(worker->nodeRanges);
+        free(worker->ranges);
+        free(worker->spheres);
+        free(worker->visibility);
+        free(worker->matWorldView);
+        free(worker->matWorldViewProj);
+        ArrayDeinit(worker->clipped[0]);
+        ArrayDeinit(worker->clipped[1]);
+        memset(worker, 0, sizeof(struct graphics_worker));
+}
+
+//! \brief Append a batch to the queue without blocking
+//!
+//! Only the thread ending frames may push.
+//!
+//! \param[in,out] queue the queue to push onto
+//! \param[in] batch the batch to append
+//! \return 1 if the batch was queued, or 0 if the queue is full
+int BatchQueuePush(struct graphics_batch_queue *queue, struct graphics_batch *batch) {
+        long tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        if (tail - atomic_load(&queue->head) == GRAPHICS_QUEUE_SIZE) {
+                return 0;
+        }
+        queue->batches[tail & (GRAPHICS_QUEUE_SIZE - 1)] = *batch;
+        atomic_store(&queue->tail, tail + 1);
+        return 1;
+}
+
+//! \brief Remove the oldest batch from the queue without blocking
+//!
+//! Only the raster thread may pop.
+//!
+//! \param[in,out] queue the queue to pop from
+//! \param[out] batch the batch removed
+//! \return 1 if a batch was removed, or 0 if the queue is empty
+int BatchQueuePop(struct graphics_batch_queue *queue, struct graphics_batch *batch) {
+        long head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+        if (head == atomic_load(&queue->tail)) {
+                return 0;
+        }
+        *batch = queue->batches[head & (GRAPHICS_QUEUE_SIZE - 1)];
+        atomic_store(&queue->head, head + 1);
+        return 1;
+}
+
+//! \brief Wake every thread sleeping on the pipeline's condition variable
+//!
+//! Call after any change another thread might be waiting on. Only takes the
+//! mutex if some thread is actually asleep.
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+void PipelineNotify(struct graphics *graphics) {
+        if (atomic_load(&graphics->waiting) > 0) {
+                pthread_mutex_lock(&graphics->mutex);
+                pthread_cond_broadcast(&graphics->wake);
+                pthread_mutex_unlock(&graphics->mutex);
+        }
+}
+
+//! \brief Body of the raster thread
+//!
+//! Pops batches and rasterizes them in order, sleeping while the queue is
+//! empty. A frame's first batch clears its framebuffer and its last marks the
+//! frame as rasterized. Exits once stopped and the queue has been drained.
+//!
+//! \param[in,out] data the struct graphics to rasterize for
+//! \return NULL
+void *RasterThreadMain(void *data) {
+        struct graphics *graphics = (struct graphics *)data;
+        struct graphics_batch batch;
+
+        while (1) {
+                if (!BatchQueuePop(&graphics->queue, &batch)) {
+                        pthread_mutex_lock(&graphics->mutex);
+                        atomic_fetch_add(&graphics->waiting, 1);
+                        while (atomic_load(&graphics->queue.head) == atomic_load(&graphics->queue.tail) && atomic_load(&graphics->running)) {
+                                pthread_cond_wait(&graphics->wake, &graphics->mutex);
+                        }
+                        atomic_fetch_sub(&graphics->waiting, 1);
+                        pthread_mutex_unlock(&graphics->mutex);
+
+                        if (atomic_load(&graphics->queue.head) == atomic_load(&graphics->queue.tail) && !atomic_load(&graphics->running)) {
+                                break;
+                        }
+                        continue;
+                }
+                PipelineNotify(graphics);
+
+                struct graphics_frame *frame = batch.frame;
+                if (0 == batch.first) {
+                        graphics->pixels = graphics->framebuffers[frame - graphics->frames];
+                        graphics->bytesPerRow = graphics->width * 4;
+                        GraphicsClearScreen(graphics, frame->view.clearColor);
+                }
+                graphics->stages.raster(graphics, frame, batch.first, batch.count);
+                if (batch.last) {
+                        atomic_store(&graphics->rasterized, frame->number);
+                        PipelineNotify(graphics);
+                }
+        }
+
+        return NULL;
+}
+
+//! \brief Stop the raster thread, if running, once it has drained its queue
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+void StopRasterThread(struct graphics *graphics) {
+        if (!graphics->rasterThreadStarted) {
+                return;
+        }
+
+        pthread_mutex_lock(&graphics->mutex);
+        atomic_store(&graphics->running, 0);
+        pthread_cond_broadcast(&graphics->wake);
+        pthread_mutex_unlock(&graphics->mutex);
+
+        pthread_join(graphics->rasterThread, NULL);
+        graphics->rasterThreadStarted = 0;
+}
+
 void GraphicsDeinit(struct graphics *g) {
         if (NULL == g) {
                 return;
         }
 
+        StopRasterThread(g);
+
         if (NULL != g->texture) {
                 SDL_DestroyTexture(g->texture);
         }
@@ -112,6 +323,19 @@ void GraphicsDeinit(struct graphics *g) {
         }
 
         SDL_Quit();
+
+        for (int i = 0; i <= GRAPHICS_MAX_LATENCY; i++) {
+                struct graphics_frame *frame = &g->frames[i];
+                GraphicsCommandBufferDeinit(frame->immediate);
+                ArenaDeinit(frame->arena);
+                free(g->framebuffers[i]);
+        }
+        for (int i = 0; i < g->workerCount; i++) {
+                GraphicsWorkerDeinit(&g->workers[i]);
+        }
+        free(g->workers);
+        pthread_mutex_destroy(&g->mutex);
+        pthread_cond_destroy(&g->wake);
         free(g);
 }
 
@@ -254,10 +478,13 @@ void GraphicsDrawLine(struct graphics *graphics, int x1, int y1, int x2, int y2,
         }
 }
 
-void GraphicsTriangleTextured(struct graphics *graphics, struct triangle tri, struct texture *texture) {
-        int x1 = tri.x1; int y1 = tri.y1; float u1 = tri.u1; float v1 = tri.v1; float w1 = tri.tw1;
-        int x2 = tri.x2; int y2 = tri.y2; float u2 = tri.u2; float v2 = tri.v2; float w2 = tri.tw2;
-        int x3 = tri.x3; int y3 = tri.y3; float u3 = tri.u3; float v3 = tri.v3; float w3 = tri.tw3;
+void GraphicsTriangleTextured(struct graphics *graphics, struct graphics_raster_triangle *tri, struct texture *texture) {
+        struct graphics_raster_vertex *a = &tri->v[0];
+        struct graphics_raster_vertex *b = &tri->v[1];
+        struct graphics_raster_vertex *c = &tri->v[2];
+        int x1 = a->x >> GRAPHICS_SUBPIXEL_BITS; int y1 = a->y >> GRAPHICS_SUBPIXEL_BITS; float u1 = a->u; float v1 = a->v; float w1 = a->w;
+        int x2 = b->x >> GRAPHICS_SUBPIXEL_BITS; int y2 = b->y >> GRAPHICS_SUBPIXEL_BITS; float u2 = b->u; float v2 = b->v; float w2 = b->w;
+        int x3 = c->x >> GRAPHICS_SUBPIXEL_BITS; int y3 = c->y >> GRAPHICS_SUBPIXEL_BITS; float u3 = c->u; float v3 = c->v; float w3 = c->w;
 
         // Sort all vertices by y-value.
         if (y2 < y1) {
@@ -408,10 +635,15 @@ void GraphicsTriangleTextured(struct graphics *graphics, struct triangle tri, st
         }
 }
 
-void GraphicsTriangleWireframe(struct graphics *graphics, struct triangle triangle, unsigned int color) {
-        GraphicsDrawLine(graphics, triangle.x1, triangle.y1, triangle.x2, triangle.y2, color);
-        GraphicsDrawLine(graphics, triangle.x2, triangle.y2, triangle.x3, triangle.y3, color);
-        GraphicsDrawLine(graphics, triangle.x3, triangle.y3, triangle.x1, triangle.y1, color);
+void GraphicsTriangleWireframe(struct graphics *graphics, struct graphics_raster_triangle *triangle, unsigned int color) {
+        for (int c = 0; c < 3; c++) {
+                struct graphics_raster_vertex *from = &triangle->v[c];
+                struct graphics_raster_vertex *to = &triangle->v[(c + 1) % 3];
+                GraphicsDrawLine(graphics,
+                                 from->x >> GRAPHICS_SUBPIXEL_BITS, from->y >> GRAPHICS_SUBPIXEL_BITS,
+                                 to->x >> GRAPHICS_SUBPIXEL_BITS, to->y >> GRAPHICS_SUBPIXEL_BITS,
+                                 color);
+        }
 }
 
 //! Used internally by GraphicsTriangleSolid()
@@ -421,17 +653,15 @@ void TriangleSolidDrawLine(struct graphics *graphics, int xmin, int xmax, int y,
         }
 }
 
-void GraphicsTriangleSolid(struct graphics *graphics, struct triangle triangle, unsigned int color) {
-        GraphicsDrawLine(graphics, triangle.x1, triangle.y1, triangle.x2, triangle.y2, color);
-        GraphicsDrawLine(graphics, triangle.x2, triangle.y2, triangle.x3, triangle.y3, color);
-        GraphicsDrawLine(graphics, triangle.x3, triangle.y3, triangle.x1, triangle.y1, color);
+void GraphicsTriangleSolid(struct graphics *graphics, struct graphics_raster_triangle *triangle, unsigned int color) {
+        GraphicsTriangleWireframe(graphics, triangle, color);
 
-        int x1 = triangle.v[0].x;
-        int y1 = triangle.v[0].y;
-        int x2 = triangle.v[1].x;
-        int y2 = triangle.v[1].y;
-        int x3 = triangle.v[2].x;
-        int y3 = triangle.v[2].y;
+        int x1 = triangle->v[0].x >> GRAPHICS_SUBPIXEL_BITS;
+        int y1 = triangle->v[0].y >> GRAPHICS_SUBPIXEL_BITS;
+        int x2 = triangle->v[1].x >> GRAPHICS_SUBPIXEL_BITS;
+        int y2 = triangle->v[1].y >> GRAPHICS_SUBPIXEL_BITS;
+        int x3 = triangle->v[2].x >> GRAPHICS_SUBPIXEL_BITS;
+        int y3 = triangle->v[2].y >> GRAPHICS_SUBPIXEL_BITS;
 
 	unsigned int t1x,t2x,y,minx,maxx,t1xp,t2xp;
 	int changed1 = 0;
@@ -598,3 +828,1020 @@ next:
                         return;
 	}
 }
+
+//! \brief Smallest doubling of capacity that holds needed elements
+//!
+//! \param[in] capacity current capacity
+//! \param[in] needed number of elements that must fit
+//! \return the new capacity
+int GrowCapacity(int capacity, int needed) {
+        if (capacity < 64) {
+                capacity = 64;
+        }
+        while (capacity < needed) {
+                capacity *= 2;
+        }
+        return capacity;
+}
+
+//! \brief What the default sort stage orders a raster triangle by
+struct graphics_sort_key {
+        float depth;
+        unsigned int material;
+        int index; //!< the triangle's position in frame->renderTris before sorting
+};
+
+//! \brief Compare the Z-Sorting order of two triangles
+//!
+//! Triangles at the same depth are ordered by material, so draws sharing a
+//! texture stay together.
+//!
+//! \param[in] l sort key of a raster triangle
+//! \param[in] r sort key of a raster triangle
+//! \return 0 if their sort values are the same, -1 if l comes first, otherwise 1
+int TriangleCompare(struct graphics_sort_key *l, struct graphics_sort_key *r) {
+        float zl = l->depth;
+        float zr = r->depth;
+
+        if (zl == zr) {
+                return (l->material > r->material) - (l->material < r->material);
+        } else if (zl > zr) {
+                return -1;
+        } else {
+                return 1;
+        }
+}
+
+//! \brief Stable merge sort of raster triangle sort keys
+//!
+//! \param[in,out] keys the keys to sort
+//! \param[out] scratch room for count keys
+//! \param[in] count number of keys
+void SortKeys(struct graphics_sort_key *keys, struct graphics_sort_key *scratch, int count) {
+        if (count < 2) {
+                return;
+        }
+
+        int half = count / 2;
+        SortKeys(keys, scratch, half);
+        SortKeys(&keys[half], scratch, count - half);
+
+        // Ties go to the left run, which keeps equal keys in order. Whatever
+        // is left of the right run is already in place.
+        int l = 0;
+        int r = half;
+        int out = 0;
+        while (l < half && r < count) {
+                if (TriangleCompare(&keys[r], &keys[l]) < 0) {
+                        scratch[out++] = keys[r++];
+                } else {
+                        scratch[out++] = keys[l++];
+                }
+        }
+        while (l < half) {
+                scratch[out++] = keys[l++];
+        }
+        memcpy(keys, scratch, sizeof(struct graphics_sort_key) * out);
+}
+
+//! \brief Whether every vertex of a projected triangle lies on the screen
+//!
+//! Such triangles are unaffected by screen edge clipping.
+//!
+//! \param[in] tri the projected triangle
+//! \param[in] width screen width in pixels
+//! \param[in] height screen height in pixels
+//! \return 1 if the triangle needs no clipping, otherwise 0
+int TriangleInsideScreen(struct triangle *tri, int width, int height) {
+        for (int c = 0; c < 3; c++) {
+                if (tri->v[c].x < 0 || tri->v[c].x > (float)width - 1 ||
+                    tri->v[c].y < 0 || tri->v[c].y > (float)height - 1) {
+                        return 0;
+                }
+        }
+        return 1;
+}
+
+//! \brief Record a frame as presented, just after it was shown
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+//! \param[in] frame the frame just presented
+void FramePresented(struct graphics *graphics, struct graphics_frame *frame) {
+        graphics->presentedNumber = frame->number;
+        graphics->presentedStats = frame->stats;
+        if (0 != frame->view.inputTime) {
+                Uint64 elapsed = SDL_GetPerformanceCounter() - frame->view.inputTime;
+                graphics->presentedStats.inputLatency = (double)elapsed * 1000.0 / (double)SDL_GetPerformanceFrequency();
+        }
+}
+
+//! \brief Hand a frame's sorted triangles to the raster thread
+//!
+//! Blocks only while the queue is full.
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+//! \param[in] frame the frame to rasterize
+void QueueFrame(struct graphics *graphics, struct graphics_frame *frame) {
+        int first = 0;
+        do {
+                struct graphics_batch batch;
+                batch.frame = frame;
+                batch.first = first;
+                batch.count = frame->renderTrisCount - first;
+                if (batch.count > GRAPHICS_BATCH_TRIANGLES) {
+                        batch.count = GRAPHICS_BATCH_TRIANGLES;
+                }
+                batch.last = first + batch.count == frame->renderTrisCount;
+
+                while (!BatchQueuePush(&graphics->queue, &batch)) {
+                        pthread_mutex_lock(&graphics->mutex);
+                        atomic_fetch_add(&graphics->waiting, 1);
+                        while (atomic_load(&graphics->queue.tail) - atomic_load(&graphics->queue.head) == GRAPHICS_QUEUE_SIZE) {
+                                pthread_cond_wait(&graphics->wake, &graphics->mutex);
+                        }
+                        atomic_fetch_sub(&graphics->waiting, 1);
+                        pthread_mutex_unlock(&graphics->mutex);
+                }
+                PipelineNotify(graphics);
+
+                first += batch.count;
+        } while (first < frame->renderTrisCount);
+}
+
+//! \brief Wait for the raster thread to finish a frame, then present it
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+//! \param[in] number the frame to present; every earlier frame must have been presented
+void PresentFrame(struct graphics *graphics, unsigned int number) {
+        if ((int)(atomic_load(&graphics->rasterized) - number) < 0) {
+                pthread_mutex_lock(&graphics->mutex);
+                atomic_fetch_add(&graphics->waiting, 1);
+                while ((int)(atomic_load(&graphics->rasterized) - number) < 0) {
+                        pthread_cond_wait(&graphics->wake, &graphics->mutex);
+                }
+                atomic_fetch_sub(&graphics->waiting, 1);
+                pthread_mutex_unlock(&graphics->mutex);
+        }
+
+        int slot = number % (graphics->latency + 1);
+        unsigned char *framebuffer = graphics->framebuffers[slot];
+        int rowBytes = graphics->width * 4;
+
+        unsigned char *pixels;
+        int bytesPerRow;
+        SDL_LockTexture(graphics->texture, NULL, (void **)&pixels, &bytesPerRow);
+        for (int y = 0; y < graphics->height; y++) {
+                memcpy(&pixels[y * bytesPerRow], &framebuffer[y * rowBytes], rowBytes);
+        }
+        SDL_UnlockTexture(graphics->texture);
+        SDL_RenderClear(graphics->renderer);
+        SDL_RenderCopy(graphics->renderer, graphics->texture, 0, 0);
+        SDL_RenderPresent(graphics->renderer);
+
+        FramePresented(graphics, &graphics->frames[slot]);
+}
+
+//! \brief Present every frame still in flight
+//!
+//! Leaves the raster thread idle and every frame free for reuse.
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+void FlushPipeline(struct graphics *graphics) {
+        if (0 == graphics->latency) {
+                return;
+        }
+        while (graphics->presentedNumber != graphics->frameNumber) {
+                PresentFrame(graphics, graphics->presentedNumber + 1);
+        }
+}
+
+struct graphics_stages GraphicsDefaultStages() {
+        return (struct graphics_stages){
+                GraphicsGeometryStage,
+                GraphicsSortStage,
+                GraphicsRasterStage,
+        };
+}
+
+void GraphicsSetStages(struct graphics *graphics, struct graphics_stages stages) {
+        FlushPipeline(graphics);
+
+        struct graphics_stages defaults = GraphicsDefaultStages();
+        graphics->stages.geometry = NULL != stages.geometry ? stages.geometry : defaults.geometry;
+        graphics->stages.sort = NULL != stages.sort ? stages.sort : defaults.sort;
+        graphics->stages.raster = NULL != stages.raster ? stages.raster : defaults.raster;
+}
+
+void GraphicsBeginFrame(struct graphics *graphics, struct graphics_view *view) {
+        // The frame that last used this slot was presented by the
+        // GraphicsEndFrame() latency frames back.
+        unsigned int number = ++graphics->frameNumber;
+        struct graphics_frame *frame = &graphics->frames[number % (graphics->latency + 1)];
+        graphics->frame = frame;
+
+        frame->number = number;
+        frame->view = *view;
+
+        ArenaReset(frame->arena);
+        frame->submitted = NULL;
+        frame->submittedCount = 0;
+        frame->submittedCapacity = 0;
+        frame->draws = NULL;
+        frame->drawCount = 0;
+        frame->materials = NULL;
+        frame->materialCount = 0;
+        frame->chunks = NULL;
+        frame->chunkCount = 0;
+        frame->renderTris = NULL;
+        frame->renderTrisCount = 0;
+        frame->stats = (struct graphics_stats){ 0 };
+
+        GraphicsCommandBufferReset(frame->immediate);
+        GraphicsSubmit(graphics, frame->immediate);
+}
+
+void GraphicsDrawMesh(struct graphics *graphics, struct mesh *mesh, struct mat4x4 transform, struct material material) {
+        GraphicsRecordDrawMeshInstanced(graphics->frame->immediate, mesh, &transform, NULL, 1, material);
+}
+
+void GraphicsDrawMeshInstanced(struct graphics *graphics, struct mesh *mesh, struct mat4x4 *transforms, int *lods, int count, struct material material) {
+        GraphicsRecordDrawMeshInstanced(graphics->frame->immediate, mesh, transforms, lods, count, material);
+}
+
+void GraphicsSubmit(struct graphics *graphics, struct graphics_command_buffer *buffer) {
+        struct graphics_frame *frame = graphics->frame;
+        if (frame->submittedCount == frame->submittedCapacity) {
+                int capacity = GrowCapacity(frame->submittedCapacity, frame->submittedCount + 1);
+                frame->submitted = (struct graphics_command_buffer **)ArenaGrow(
+                        frame->arena, frame->submitted,
+                        sizeof(struct graphics_command_buffer *) * frame->submittedCount,
+                        sizeof(struct graphics_command_buffer *) * capacity);
+                frame->submittedCapacity = capacity;
+        }
+        frame->submitted[frame->submittedCount++] = buffer;
+}
+
+//! \brief Index of a material in the frame's materials, adding it if it's new
+//!
+//! \param[in,out] frame the frame being built
+//! \param[in] material the material to find
+//! \return index into frame->materials
+int FrameMaterialIndex(struct graphics_frame *frame, struct material material) {
+        for (int i = 0; i < frame->materialCount; i++) {
+                if (frame->materials[i].texture == material.texture && frame->materials[i].color == material.color) {
+                        return i;
+                }
+        }
+        frame->materials[frame->materialCount] = material;
+        return frame->materialCount++;
+}
+
+//! \brief Flatten every submitted buffer into the frame's draws and materials
+//!
+//! Identical materials recorded in different buffers are merged, and
+//! materials are numbered in order of first use. Draws are then grouped by
+//! material, keeping submission order within each group, so the geometry
+//! stage emits each material's triangles together.
+//!
+//! \param[in,out] frame the frame being built
+void ResolveDraws(struct graphics_frame *frame) {
+        int drawCount = 0;
+        int materialCount = 0;
+        for (int b = 0; b < frame->submittedCount; b++) {
+                drawCount += frame->submitted[b]->commandCount;
+                materialCount += frame->submitted[b]->materialCount;
+        }
+        frame->draws = (struct graphics_draw *)ArenaAlloc(frame->arena, sizeof(struct graphics_draw) * drawCount);
+        frame->materials = (struct material *)ArenaAlloc(frame->arena, sizeof(struct material) * materialCount);
+
+        frame->drawCount = 0;
+        frame->materialCount = 0;
+        for (int b = 0; b < frame->submittedCount; b++) {
+                struct graphics_command_buffer *buffer = frame->submitted[b];
+                for (int c = 0; c < buffer->commandCount; c++) {
+                        struct graphics_command *command = &buffer->commands[c];
+                        struct graphics_draw *draw = &frame->draws[frame->drawCount++];
+                        draw->mesh = command->mesh;
+                        draw->transforms = &buffer->transforms[command->firstTransform];
+                        draw->count = command->count;
+                        draw->lods = command->lods;
+                        draw->material = FrameMaterialIndex(frame, buffer->materials[command->material]);
+                }
+        }
+
+        // A stable insertion sort: there are few draws, and they're usually
+        // recorded already grouped.
+        for (int i = 1; i < frame->drawCount; i++) {
+                struct graphics_draw draw = frame->draws[i];
+                int j = i;
+                while (j > 0 && frame->draws[j - 1].material > draw.material) {
+                        frame->draws[j] = frame->draws[j - 1];
+                        j--;
+                }
+                frame->draws[j] = draw;
+        }
+}
+
+//! \brief Split every draw into chunks of at most GRAPHICS_CHUNK_INSTANCES instances
+//!
+//! \param[in,out] frame the frame being built
+void BuildChunks(struct graphics_frame *frame) {
+        int chunkCount = 0;
+        for (int i = 0; i < frame->drawCount; i++) {
+                chunkCount += (frame->draws[i].count + GRAPHICS_CHUNK_INSTANCES - 1) / GRAPHICS_CHUNK_INSTANCES;
+        }
+        frame->chunks = (struct graphics_chunk *)ArenaAlloc(frame->arena, sizeof(struct graphics_chunk) * chunkCount);
+
+        frame->chunkCount = 0;
+        for (int i = 0; i < frame->drawCount; i++) {
+                for (int first = 0; first < frame->draws[i].count; first += GRAPHICS_CHUNK_INSTANCES) {
+                        struct graphics_chunk *chunk = &frame->chunks[frame->chunkCount++];
+                        chunk->draw = i;
+                        chunk->first = first;
+                        chunk->count = frame->draws[i].count - first;
+                        if (chunk->count > GRAPHICS_CHUNK_INSTANCES) {
+                                chunk->count = GRAPHICS_CHUNK_INSTANCES;
+                        }
+                }
+        }
+}
+
+//! \brief Run the geometry stage over a range of chunks
+//!
+//! Job function for JobParallelFor(). Output goes to the calling thread's
+//! worker, and each chunk records where its triangles ended up.
+//!
+//! \param[in,out] data the struct graphics being drawn
+//! \param[in] first first chunk to process
+//! \param[in] count number of chunks to process
+void GeometryChunks(void *data, int first, int count) {
+        struct graphics *graphics = (struct graphics *)data;
+        struct graphics_frame *frame = graphics->frame;
+        int index = NULL != graphics->jobs ? JobThreadIndex(graphics->jobs) : 0;
+        struct graphics_worker *worker = &graphics->workers[index];
+
+        for (int i = first; i < first + count; i++) {
+                struct graphics_chunk *chunk = &frame->chunks[i];
+                chunk->worker = index;
+                chunk->firstTri = worker->trisCount;
+                graphics->stages.geometry(frame, worker, &frame->draws[chunk->draw], chunk->first, chunk->count);
+                chunk->triCount = worker->trisCount - chunk->firstTri;
+        }
+}
+
+//! \brief Concatenate the chunks' triangles into the render list, in chunk order
+//!
+//! Also sums the workers' geometry counters into the frame's.
+//!
+//! \param[in,out] frame the frame being built
+//! \param[in] workers the workers the chunks were processed by
+//! \param[in] workerCount number of workers
+void MergeChunks(struct graphics_frame *frame, struct graphics_worker *workers, int workerCount) {
+        int total = 0;
+        for (int i = 0; i < frame->chunkCount; i++) {
+                total += frame->chunks[i].triCount;
+        }
+        frame->renderTris = (struct graphics_raster_triangle *)ArenaAlloc(frame->arena, sizeof(struct graphics_raster_triangle) * total);
+
+        frame->renderTrisCount = 0;
+        for (int i = 0; i < frame->chunkCount; i++) {
+                struct graphics_chunk *chunk = &frame->chunks[i];
+                memcpy(&frame->renderTris[frame->renderTrisCount], &workers[chunk->worker].tris[chunk->firstTri], sizeof(struct graphics_raster_triangle) * chunk->triCount);
+                frame->renderTrisCount += chunk->triCount;
+        }
+
+        for (int w = 0; w < workerCount; w++) {
+                struct graphics_stats *from = &workers[w].stats;
+                struct graphics_stats *to = &frame->stats;
+                to->instances += from->instances;
+                to->instancesCulled += from->instancesCulled;
+                to->instancesInside += from->instancesInside;
+                to->instancesIntersecting += from->instancesIntersecting;
+                to->instancesSimplified += from->instancesSimplified;
+                to->ranges += from->ranges;
+                to->trisFrustumCulled += from->trisFrustumCulled;
+                to->trisClusterCulled += from->trisClusterCulled;
+                to->trisBackfacing += from->trisBackfacing;
+                to->vertexTransforms += from->vertexTransforms;
+        }
+}
+
+void GraphicsSetJobSystem(struct graphics *graphics, struct job_system *jobs) {
+        int workerCount = NULL != jobs ? JobSystemThreadCount(jobs) : 1;
+        if (workerCount > graphics->workerCount) {
+                graphics->workers = (struct graphics_worker *)realloc(graphics->workers, sizeof(struct graphics_worker) * workerCount);
+                memset(&graphics->workers[graphics->workerCount], 0, sizeof(struct graphics_worker) * (workerCount - graphics->workerCount));
+                for (int w = graphics->workerCount; w < workerCount; w++) {
+                        graphics->workers[w].arena = ArenaInit(GRAPHICS_ARENA_BLOCK_SIZE);
+                }
+                graphics->workerCount = workerCount;
+        }
+        graphics->jobs = jobs;
+}
+
+int GraphicsSetLatency(struct graphics *graphics, int latency) {
+        if (latency < 0) {
+                latency = 0;
+        } else if (latency > GRAPHICS_MAX_LATENCY) {
+                latency = GRAPHICS_MAX_LATENCY;
+        }
+
+        FlushPipeline(graphics);
+
+        if (latency > 0) {
+                for (int i = 0; i <= latency; i++) {
+                        if (NULL == graphics->framebuffers[i]) {
+                                graphics->framebuffers[i] = (unsigned char *)malloc(graphics->width * graphics->height * 4);
+                        }
+                }
+                if (!graphics->rasterThreadStarted) {
+                        atomic_store(&graphics->running, 1);
+                        if (0 != pthread_create(&graphics->rasterThread, NULL, RasterThreadMain, graphics)) {
+                                fprintf(stderr, "Couldn't create raster thread\n");
+                                latency = 0;
+                        } else {
+                                graphics->rasterThreadStarted = 1;
+                        }
+                }
+        } else {
+                StopRasterThread(graphics);
+        }
+
+        graphics->latency = latency;
+        return latency;
+}
+
+void GraphicsSetViewLatch(struct graphics *graphics, void (*latch)(void *data, struct graphics_view *view), void *data) {
+        graphics->latch = latch;
+        graphics->latchData = data;
+}
+
+void GraphicsEndFrame(struct graphics *graphics) {
+        struct graphics_frame *frame = graphics->frame;
+
+        if (NULL != graphics->latch) {
+                graphics->latch(graphics->latchData, &frame->view);
+        }
+
+        ResolveDraws(frame);
+        BuildChunks(frame);
+
+        for (int w = 0; w < graphics->workerCount; w++) {
+                struct graphics_worker *worker = &graphics->workers[w];
+                ArenaReset(worker->arena);
+                worker->tris = NULL;
+                worker->trisCount = 0;
+                worker->trisCapacity = 0;
+                worker->stats = (struct graphics_stats){ 0 };
+        }
+        if (NULL != graphics->jobs) {
+                JobParallelFor(graphics->jobs, GeometryChunks, graphics, frame->chunkCount, 1);
+        } else {
+                GeometryChunks(graphics, 0, frame->chunkCount);
+        }
+
+        frame->stats.draws = frame->drawCount;
+        MergeChunks(frame, graphics->workers, graphics->workerCount);
+        graphics->stages.sort(frame);
+
+        frame->stats.arenaBytes = frame->arena->used;
+        frame->stats.arenaPeak = frame->arena->peak;
+        for (int w = 0; w < graphics->workerCount; w++) {
+                frame->stats.arenaBytes += graphics->workers[w].arena->used;
+                frame->stats.arenaPeak += graphics->workers[w].arena->peak;
+        }
+
+        if (0 == graphics->latency) {
+                GraphicsBegin(graphics);
+                GraphicsClearScreen(graphics, frame->view.clearColor);
+                graphics->stages.raster(graphics, frame, 0, frame->renderTrisCount);
+                GraphicsEnd(graphics);
+                FramePresented(graphics, frame);
+                return;
+        }
+
+        // Queue this frame first so the raster thread can move straight on
+        // to it while the oldest frame in flight is presented.
+        QueueFrame(graphics, frame);
+        if (frame->number > (unsigned int)graphics->latency) {
+                PresentFrame(graphics, frame->number - graphics->latency);
+        }
+}
+
+struct graphics_command_buffer *GraphicsCommandBufferInit(int commandCapacity, int transformCapacity) {
+        struct graphics_command_buffer *buffer = (struct graphics_command_buffer *)malloc(sizeof(struct graphics_command_buffer));
+        memset(buffer, 0, sizeof(struct graphics_command_buffer));
+
+        buffer->commandCapacity = GrowCapacity(0, commandCapacity);
+        buffer->commands = (struct graphics_command *)malloc(sizeof(struct graphics_command) * buffer->commandCapacity);
+
+        buffer->transformCapacity = GrowCapacity(0, transformCapacity);
+        buffer->transforms = (struct mat4x4 *)malloc(sizeof(struct mat4x4) * buffer->transformCapacity);
+
+        buffer->materialCapacity = GrowCapacity(0, 1);
+        buffer->materials = (struct material *)malloc(sizeof(struct material) * buffer->materialCapacity);
+
+        return buffer;
+}
+
+void GraphicsCommandBufferDeinit(struct graphics_command_buffer *buffer) {
+        if (NULL == buffer) {
+                return;
+        }
+
+        free(buffer->commands);
+        free(buffer->transforms);
+        free(buffer->materials);
+        free(buffer);
+}
+
+void GraphicsCommandBufferReset(struct graphics_command_buffer *buffer) {
+        buffer->commandCount = 0;
+        buffer->transformCount = 0;
+        buffer->materialCount = 0;
+}
+
+void GraphicsRecordDrawMeshInstanced(struct graphics_command_buffer *buffer, struct mesh *mesh, struct mat4x4 *transforms, int *lods, int count, struct material material) {
+        if (count <= 0) {
+                return;
+        }
+
+        if (buffer->commandCount == buffer->commandCapacity) {
+                buffer->commandCapacity = GrowCapacity(buffer->commandCapacity, buffer->commandCount + 1);
+                buffer->commands = (struct graphics_command *)realloc(buffer->commands, sizeof(struct graphics_command) * buffer->commandCapacity);
+        }
+        if (buffer->transformCount + count > buffer->transformCapacity) {
+                buffer->transformCapacity = GrowCapacity(buffer->transformCapacity, buffer->transformCount + count);
+                buffer->transforms = (struct mat4x4 *)realloc(buffer->transforms, sizeof(struct mat4x4) * buffer->transformCapacity);
+        }
+
+        // Consecutive commands with the same material share one entry.
+        int materialIndex = buffer->materialCount - 1;
+        if (materialIndex < 0 ||
+            buffer->materials[materialIndex].texture != material.texture ||
+            buffer->materials[materialIndex].color != material.color) {
+                if (buffer->materialCount == buffer->materialCapacity) {
+                        buffer->materialCapacity = GrowCapacity(buffer->materialCapacity, buffer->materialCount + 1);
+                        buffer->materials = (struct material *)realloc(buffer->materials, sizeof(struct material) * buffer->materialCapacity);
+                }
+                materialIndex = buffer->materialCount++;
+                buffer->materials[materialIndex] = material;
+        }
+
+        struct graphics_command *command = &buffer->commands[buffer->commandCount++];
+        command->mesh = mesh;
+        command->firstTransform = buffer->transformCount;
+        command->count = count;
+        command->lods = lods;
+        command->material = materialIndex;
+
+        memcpy(&buffer->transforms[buffer->transformCount], transforms, sizeof(struct mat4x4) * count);
+        buffer->transformCount += count;
+}
+
+struct graphics_stats GraphicsFrameStats(struct graphics *graphics) {
+        return graphics->presentedStats;
+}
+
+void GraphicsStatsDebug(struct graphics_stats stats, char *name) {
+        if (NULL != name)
+                printf("struct graphics_stats %s = ", name);
+        else
+                printf("(struct graphics_stats)");
+
+        printf("{ draws: %d; instances: %d, %d culled, %d inside, %d intersecting, %d simplified; %d ranges; tris: %d frustum culled, %d cluster culled, %d backfacing, %d rasterized; %d vertex transforms; input latency: %.2fms; arenas: %.1f KiB, %.1f KiB peak }\n",
+               stats.draws, stats.instances, stats.instancesCulled, stats.instancesInside, stats.instancesIntersecting,
+               stats.instancesSimplified, stats.ranges, stats.trisFrustumCulled, stats.trisClusterCulled,
+               stats.trisBackfacing, stats.trisRasterized, stats.vertexTransforms, stats.inputLatency,
+               (double)stats.arenaBytes / 1024.0, (double)stats.arenaPeak / 1024.0);
+}
+
+void GraphicsReserveTriangles(struct graphics_worker *worker, int count) {
+        int needed = worker->trisCount + count;
+        if (needed > worker->trisCapacity) {
+                int capacity = GrowCapacity(worker->trisCapacity, needed);
+                worker->tris = (struct graphics_raster_triangle *)ArenaGrow(
+                        worker->arena, worker->tris,
+                        sizeof(struct graphics_raster_triangle) * worker->trisCount,
+                        sizeof(struct graphics_raster_triangle) * capacity);
+                worker->trisCapacity = capacity;
+        }
+}
+
+//! \brief Convert a screen coordinate to fixed point
+//!
+//! \param[in] coordinate screen coordinate in pixels, within the screen or a rounding error off it
+//! \param[in] size screen size along the coordinate's axis
+//! \return the coordinate in steps of 1 / (1 << GRAPHICS_SUBPIXEL_BITS) pixels, rounded down
+unsigned short RasterSubpixel(float coordinate, int size) {
+        float max = (float)(size - 1);
+        coordinate = coordinate < 0.0f ? 0.0f : (coordinate > max ? max : coordinate);
+        return (unsigned short)(coordinate * (float)(1 << GRAPHICS_SUBPIXEL_BITS));
+}
+
+//! \brief Convert a projected triangle, lying within the screen, into a raster triangle
+//!
+//! \param[out] out the raster triangle to fill in
+//! \param[in] t the triangle in screen space
+//! \param[in] depth the sort key
+//! \param[in] width screen width in pixels
+//! \param[in] height screen height in pixels
+void RasterTriangleInit(struct graphics_raster_triangle *out, struct triangle *t, float depth, int width, int height) {
+        for (int c = 0; c < 3; c++) {
+                out->v[c].x = RasterSubpixel(t->v[c].x, width);
+                out->v[c].y = RasterSubpixel(t->v[c].y, height);
+                out->v[c].u = t->t[c].u;
+                out->v[c].v = t->t[c].v;
+                out->v[c].w = t->t[c].w;
+        }
+        out->depth = depth;
+        out->color = t->color;
+        out->material = t->material;
+}
+
+void GraphicsEmitTriangle(struct graphics_frame *frame, struct graphics_worker *worker, struct triangle *projected) {
+        float width = (float)frame->width;
+        float height = (float)frame->height;
+
+        // Pieces are ordered by the depth of the whole triangle.
+        float depth = (projected->v[0].z + projected->v[1].z + projected->v[2].z) / 3.0f;
+
+        if (TriangleInsideScreen(projected, frame->width, frame->height)) {
+                GraphicsReserveTriangles(worker, 1);
+                RasterTriangleInit(&worker->tris[worker->trisCount++], projected, depth, frame->width, frame->height);
+                return;
+        }
+
+        // Each edge can at most double the number of pieces, so there are
+        // never more than 16; the arrays start with room for them all.
+        if (NULL == worker->clipped[0]) {
+                worker->clipped[0] = ArrayInit(sizeof(struct triangle), 16);
+                worker->clipped[1] = ArrayInit(sizeof(struct triangle), 16);
+        }
+        struct array *from = worker->clipped[0];
+        struct array *to = worker->clipped[1];
+
+        // Clip against the top, bottom, left and right edges in turn. The
+        // first edge reads the projected triangle in place.
+        struct vec3 planes[4][2] = {
+                { { 0, 0, 0, 1 }, { 0, 1, 0, 1 } },
+                { { 0, height - 1, 0, 1 }, { 0, -1, 0, 1 } },
+                { { 0, 0, 0, 1 }, { 1, 0, 0, 1 } },
+                { { width - 1, 0, 0, 1 }, { -1, 0, 0, 1 } },
+        };
+        for (int p = 0; p < 4; p++) {
+                ArrayReset(to);
+                int count = 0 == p ? 1 : from->count;
+                for (int i = 0; i < count; i++) {
+                        struct triangle *test = 0 == p ? projected : (struct triangle *)ArrayGet(from, i);
+                        struct triangle *out = (struct triangle *)ArrayPush(to, 2);
+                        int added = TriangleClipAgainstPlane(planes[p][0], planes[p][1], test, &out[0], &out[1]);
+                        ArrayTruncate(to, to->count - 2 + added);
+                }
+
+                struct array *swap = from;
+                from = to;
+                to = swap;
+        }
+
+        GraphicsReserveTriangles(worker, from->count);
+        for (int i = 0; i < from->count; i++) {
+                RasterTriangleInit(&worker->tris[worker->trisCount++], (struct triangle *)ArrayGet(from, i), depth, frame->width, frame->height);
+        }
+}
+
+//! \brief Average the vertex normals of a triangle's corners
+//!
+//! \param[in] mesh the mesh the triangle belongs to
+//! \param[in] index the triangle's three vertex indices
+//! \param[in] plane the triangle's face plane, returned if the normals cancel out
+//! \return the unit length normal to light the triangle by, in object space
+struct vec3 GraphicsCornerNormal(struct mesh *mesh, unsigned int *index, struct vec3 plane) {
+        struct vec3 sum = { 0 };
+        for (int c = 0; c < 3; c++) {
+                if (NULL != mesh->packed) {
+                        sum = Vec3Add(sum, MeshUnpackNormal(&mesh->packed[index[c]]));
+                } else {
+                        sum = Vec3Add(sum, mesh->normals[index[c]]);
+                }
+        }
+        if (0.0f == Vec3DotProduct(sum, sum)) {
+                return plane;
+        }
+        return Vec3Normalize(sum);
+}
+
+//! \brief Choose the level of detail to draw an instance at
+//!
+//! The level is picked from the projected size of the instance's bounding
+//! sphere. The sphere is in world space, so its radius already includes the
+//! instance's scale; MeshSelectLOD() measures error relative to the radius, so
+//! the scale cancels out.
+//!
+//! \param[in] mesh the mesh being drawn
+//! \param[in] matWorldView the instance's world transform followed by the view
+//! \param[in] radius radius of the instance's bounding sphere in world space
+//! \param[in] matProj the projection matrix
+//! \param[in] height screen height in pixels
+//! \param[in] current level the instance was drawn at last frame
+//! \return the level to draw, as returned by MeshSelectLOD()
+int GraphicsSelectLOD(struct mesh *mesh, struct mat4x4 *matWorldView, float radius, struct mat4x4 *matProj, int height, int current) {
+        struct vec3 viewCenter = SimdMat4x4MultiplyVec3(matWorldView, &mesh->sphere.center);
+        float distance = sqrtf(Vec3DotProduct(viewCenter, viewCenter));
+        float screenRadius = INFINITY;
+        if (distance > radius) {
+                screenRadius = radius / distance * matProj->m[1][1] * 0.5f * (float)height;
+        }
+        return MeshSelectLOD(mesh, screenRadius, current);
+}
+
+void GraphicsGeometryStage(struct graphics_frame *frame, struct graphics_worker *worker, struct graphics_draw *draw, int first, int count) {
+        struct mesh *mesh = draw->mesh;
+        struct mat4x4 *transforms = &draw->transforms[first];
+        int *lods = NULL != draw->lods ? &draw->lods[first] : NULL;
+        struct mat4x4 *matView = &frame->view.matView;
+        struct mat4x4 *matProj = &frame->view.matProj;
+        struct graphics_stats *stats = &worker->stats;
+
+        if (NULL == worker->spheres) {
+                worker->spheres = (struct sphere *)malloc(sizeof(struct sphere) * GRAPHICS_CHUNK_INSTANCES);
+                worker->visibility = (int *)malloc(sizeof(int) * GRAPHICS_CHUNK_INSTANCES);
+                worker->matWorldView = (struct mat4x4 *)malloc(sizeof(struct mat4x4) * GRAPHICS_CHUNK_INSTANCES);
+                worker->matWorldViewProj = (struct mat4x4 *)malloc(sizeof(struct mat4x4) * GRAPHICS_CHUNK_INSTANCES);
+        }
+        if (mesh->vertexCount > worker->vertexCapacity) {
+                worker->vertexCapacity = GrowCapacity(worker->vertexCapacity, mesh->vertexCount);
+                worker->viewVerts = (struct vec3 *)realloc(worker->viewVerts, sizeof(struct vec3) * worker->vertexCapacity);
+                free(worker->vertexStamp);
+                worker->vertexStamp = (unsigned int *)calloc(worker->vertexCapacity, sizeof(unsigned int));
+                worker->stamp = 0;
+        }
+        int maxRanges = mesh->nodeCount > mesh->meshletCount ? mesh->nodeCount : mesh->meshletCount;
+        if (maxRanges < 1) {
+                maxRanges = 1;
+        }
+        if (maxRanges > worker->rangeCapacity) {
+                worker->rangeCapacity = GrowCapacity(worker->rangeCapacity, maxRanges);
+                worker->nodeRanges = (struct mesh_range *)realloc(worker->nodeRanges, sizeof(struct mesh_range) * worker->rangeCapacity);
+                worker->ranges = (struct mesh_range *)realloc(worker->ranges, sizeof(struct mesh_range) * worker->rangeCapacity);
+        }
+
+        stats->instances += count;
+
+        struct color baseColor = { frame->materials[draw->material].color };
+        float baseR = ColorGetFloat(baseColor, 'r');
+        float baseG = ColorGetFloat(baseColor, 'g');
+        float baseB = ColorGetFloat(baseColor, 'b');
+
+        // Cull every instance's bounding sphere in world space.
+        struct mat4x4 matViewProj;
+        SimdMat4x4Multiply(&matViewProj, matView, matProj);
+        struct frustum worldFrustum = FrustumInit(matViewProj);
+        for (int n = 0; n < count; n++) {
+                worker->spheres[n] = SphereTransform(mesh->sphere, transforms[n]);
+        }
+        SimdFrustumTestSpheres(&worldFrustum, worker->spheres, worker->visibility, count);
+
+        SimdMat4x4MultiplyBatch(transforms, matView, worker->matWorldView, count);
+        SimdMat4x4MultiplyBatch(worker->matWorldView, matProj, worker->matWorldViewProj, count);
+
+        struct vec3 cameraWorld = Vec3Init(frame->view.camera.x, frame->view.camera.y, frame->view.camera.z);
+
+        // Packed positions are unpacked by folding the scale and offset into
+        // each instance's world view matrix; packed texture coordinates are
+        // unpacked as triangles are assembled.
+        struct mesh_vertex *packed = mesh->packed;
+        struct mat4x4 matUnpack = Mat4x4Identity();
+        if (NULL != packed) {
+                matUnpack = MeshUnpackMatrix(mesh);
+        }
+
+        for (int n = 0; n < count; n++) {
+                struct mat4x4 *matWorld = &transforms[n];
+                struct mat4x4 *matWorldView = &worker->matWorldView[n];
+                struct mat4x4 matPackedView;
+                if (NULL != packed) {
+                        SimdMat4x4Multiply(&matPackedView, &matUnpack, matWorldView);
+                }
+
+                // Instances straddling the frustum get a tighter box test in
+                // object space.
+                struct frustum frustum = FrustumInit(worker->matWorldViewProj[n]);
+                int visibility = worker->visibility[n];
+                if (FRUSTUM_INTERSECT == visibility) {
+                        visibility = FrustumTestAABB(&frustum, mesh->bounds);
+                }
+                if (FRUSTUM_OUTSIDE == visibility) {
+                        stats->instancesCulled++;
+                        continue;
+                }
+
+                worker->stamp++;
+                if (0 == worker->stamp) {
+                        memset(worker->vertexStamp, 0, sizeof(unsigned int) * worker->vertexCapacity);
+                        worker->stamp = 1;
+                }
+
+                // Bring the camera into object space so meshlets and faces
+                // can be culled before any vertex is transformed.
+                struct mat4x4 matWorldInv = Mat4x4InvertAffine(*matWorld);
+                struct vec3 cameraObject = SimdMat4x4MultiplyVec3(&matWorldInv, &cameraWorld);
+                float scale = Mat4x4MaxScale(*matWorld);
+
+                int lodLevel = GraphicsSelectLOD(mesh, matWorldView, worker->spheres[n].radius, matProj, frame->height, NULL != lods ? lods[n] : 0);
+                if (NULL != lods) {
+                        lods[n] = lodLevel;
+                }
+
+                unsigned int *indices = mesh->indices;
+                struct vec3 *planes = mesh->planes;
+                int levelTris = mesh->triCount;
+                if (lodLevel > 0) {
+                        indices = mesh->lods[lodLevel - 1].indices;
+                        planes = mesh->lods[lodLevel - 1].planes;
+                        levelTris = mesh->lods[lodLevel - 1].triCount;
+                        stats->instancesSimplified++;
+                }
+
+                // Instances straddling the frustum are narrowed down to the
+                // hierarchy nodes that may be visible, then to the meshlets
+                // within them that face the camera. Simplified levels have
+                // neither, so they're drawn whole. Ranges entirely inside the
+                // frustum can't cross the near plane, so they skip clipping.
+                struct mesh_range *nodeRanges = worker->nodeRanges;
+                struct mesh_range *ranges = worker->ranges;
+                int nodeRangeCount = 1;
+                if (FRUSTUM_INSIDE == visibility) {
+                        stats->instancesInside++;
+                        nodeRanges[0] = (struct mesh_range){ 0, levelTris, 1 };
+                } else {
+                        stats->instancesIntersecting++;
+                        if (lodLevel > 0) {
+                                nodeRanges[0] = (struct mesh_range){ 0, levelTris, 0 };
+                        } else {
+                                nodeRangeCount = MeshCullBVH(mesh, &frustum, nodeRanges);
+                        }
+                }
+
+                int rangeCount = nodeRangeCount;
+                if (0 == lodLevel) {
+                        rangeCount = MeshCullMeshlets(mesh, &frustum, cameraObject, nodeRanges, nodeRangeCount, ranges);
+                } else {
+                        ranges[0] = nodeRanges[0];
+                }
+
+                stats->ranges += rangeCount;
+                stats->trisFrustumCulled += levelTris;
+                for (int r = 0; r < nodeRangeCount; r++) {
+                        stats->trisFrustumCulled -= nodeRanges[r].triCount;
+                        stats->trisClusterCulled += nodeRanges[r].triCount;
+                }
+                for (int r = 0; r < rangeCount; r++) {
+                        stats->trisClusterCulled -= ranges[r].triCount;
+                }
+
+                for (int r = 0; r < rangeCount; r++) {
+                        int needsClipping = !ranges[r].inside;
+                        int end = ranges[r].firstTri + ranges[r].triCount;
+                        for (int i = ranges[r].firstTri; i < end; i++) {
+                                struct vec3 plane = planes[i];
+                                if (Vec3DotProduct(plane, cameraObject) + plane.w <= 0.0f) {
+                                        stats->trisBackfacing++;
+                                        continue;
+                                }
+
+                                // Illumination, from the corners' normals if
+                                // they came from the file and from the face
+                                // plane otherwise. The world matrix is a
+                                // scaled rotation, so it doubles as the normal
+                                // matrix once the scale is divided out; w = 0
+                                // drops the translation.
+                                unsigned int *index = &indices[i * 3];
+                                struct vec3 facing = plane;
+                                if (mesh->importedNormals) {
+                                        facing = GraphicsCornerNormal(mesh, index, plane);
+                                }
+                                facing.w = 0.0f;
+                                struct vec3 normal = SimdMat4x4MultiplyVec3(matWorld, &facing);
+                                if (1.0f != scale) {
+                                        normal = Vec3Divide(normal, scale);
+                                }
+
+                                // How similar is normal to light direction?
+                                float dp = fmax(0.1f, Vec3DotProduct(normal, frame->view.lightDirection));
+
+                                // Assemble the view space triangle from the index buffer.
+                                struct triangle viewed;
+                                viewed.color = ColorInitFloat(dp * baseR, dp * baseG, dp * baseB, 1.0).rgba;
+                                viewed.material = draw->material;
+                                for (int c = 0; c < 3; c++) {
+                                        unsigned int v = index[c];
+                                        if (worker->stamp != worker->vertexStamp[v]) {
+                                                if (NULL != packed) {
+                                                        struct mesh_vertex *vertex = &packed[v];
+                                                        struct vec3 position = { (float)vertex->position[0], (float)vertex->position[1], (float)vertex->position[2], 1.0f };
+                                                        worker->viewVerts[v] = SimdMat4x4MultiplyVec3(&matPackedView, &position);
+                                                } else {
+                                                        worker->viewVerts[v] = SimdMat4x4MultiplyVec3(matWorldView, &mesh->positions[v]);
+                                                }
+                                                worker->vertexStamp[v] = worker->stamp;
+                                                stats->vertexTransforms++;
+                                        }
+                                        viewed.v[c] = worker->viewVerts[v];
+                                        if (NULL != packed) {
+                                                viewed.t[c] = MeshUnpackUV(mesh, &packed[v]);
+                                        } else {
+                                                viewed.t[c] = mesh->uvs[v];
+                                        }
+                                }
+
+                                struct triangle clipped[2];
+                                struct triangle *pieces = &viewed;
+                                int numClippedTriangles = 1;
+                                if (needsClipping) {
+                                        numClippedTriangles = TriangleClipAgainstPlane(
+                                                (struct vec3){ 0, 0, 0.1f, 1 },
+                                                (struct vec3){ 0, 0, 1, 1 },
+                                                &viewed,
+                                                &clipped[0],
+                                                &clipped[1]);
+                                        pieces = clipped;
+                                }
+
+                                for (int c = 0; c < numClippedTriangles; c++) {
+                                        // Convert from 3D to 2D.
+                                        struct triangle projected = pieces[c];
+                                        SimdVec3TransformBatch(matProj, pieces[c].v, projected.v, 3);
+
+                                        // Project texture coords
+                                        projected.u1 = projected.u1 / projected.w1;
+                                        projected.u2 = projected.u2 / projected.w2;
+                                        projected.u3 = projected.u3 / projected.w3;
+
+                                        projected.v1 = projected.v1 / projected.w1;
+                                        projected.v2 = projected.v2 / projected.w2;
+                                        projected.v3 = projected.v3 / projected.w3;
+
+                                        projected.tw1 = 1.0f / projected.w1;
+                                        projected.tw2 = 1.0f / projected.w2;
+                                        projected.tw3 = 1.0f / projected.w3;
+
+                                        projected.v[0] = Vec3Divide(projected.v[0], projected.v[0].w);
+                                        projected.v[1] = Vec3Divide(projected.v[1], projected.v[1].w);
+                                        projected.v[2] = Vec3Divide(projected.v[2], projected.v[2].w);
+
+                                        struct vec3 offset = { 1, 1, 0, 0 };
+                                        projected.v[0] = Vec3Add(projected.v[0], offset);
+                                        projected.v[1] = Vec3Add(projected.v[1], offset);
+                                        projected.v[2] = Vec3Add(projected.v[2], offset);
+
+                                        projected.v[0].x *= 0.5f * (float)frame->width;
+                                        projected.v[0].y *= 0.5f * (float)frame->height;
+                                        projected.v[1].x *= 0.5f * (float)frame->width;
+                                        projected.v[1].y *= 0.5f * (float)frame->height;
+                                        projected.v[2].x *= 0.5f * (float)frame->width;
+                                        projected.v[2].y *= 0.5f * (float)frame->height;
+
+                                        GraphicsEmitTriangle(frame, worker, &projected);
+                                }
+                        }
+                }
+        }
+}
+
+void GraphicsSortStage(struct graphics_frame *frame) {
+        int count = frame->renderTrisCount;
+        if (count < 2) {
+                return;
+        }
+
+        struct graphics_sort_key *keys = (struct graphics_sort_key *)ArenaAlloc(frame->arena, sizeof(struct graphics_sort_key) * count);
+        struct graphics_sort_key *scratch = (struct graphics_sort_key *)ArenaAlloc(frame->arena, sizeof(struct graphics_sort_key) * count);
+        struct graphics_raster_triangle *sorted = (struct graphics_raster_triangle *)ArenaAlloc(frame->arena, sizeof(struct graphics_raster_triangle) * count);
+
+        for (int i = 0; i < count; i++) {
+                keys[i].depth = frame->renderTris[i].depth;
+                keys[i].material = frame->renderTris[i].material;
+                keys[i].index = i;
+        }
+        SortKeys(keys, scratch, count);
+        for (int i = 0; i < count; i++) {
+                sorted[i] = frame->renderTris[keys[i].index];
+        }
+        frame->renderTris = sorted;
+}
+
+void GraphicsRasterStage(struct graphics *graphics, struct graphics_frame *frame, int first, int count) {
+        frame->stats.trisRasterized += count;
+        for (int i = first; i < first + count; i++) {
+                struct graphics_raster_triangle *t = &frame->renderTris[i];
+                struct material *material = &frame->materials[t->material];
+                if (NULL != material->texture) {
+                        GraphicsTriangleTextured(graphics, t, material->texture);
+                } else {
+                        GraphicsTriangleSolid(graphics, t, t->color);
+                }
+                // Draw wireframe faces.
+                // GraphicsTriangleWireframe(graphics, t, ColorCyan.rgba);
+        }
+}
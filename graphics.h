@@ -4,7 +4,7 @@
 
   File: graphics.h
   Created: 2019-07-16
-  Updated: 2019-08-25
+  Updated: 2026-10-19
   Author: Aaron Oman
   Notice: GNU GPLv3 License
 
@@ -16,14 +16,266 @@
 
 //! \file graphics.h
 //! Drawing interface to the operating system.
+//!
+//! Besides the immediate mode triangle drawing routines, graphics provides a
+//! retained draw API. Meshes are submitted with GraphicsDrawMesh() between
+//! GraphicsBeginFrame() and GraphicsEndFrame(). Nothing is drawn until the end
+//! of the frame, when every draw is run through the pipeline stages in
+//! struct graphics_stages. Graphics owns every transient buffer the pipeline
+//! needs, allocated from per-frame and per-worker arenas that are reset
+//! rather than freed, and each stage can be replaced with GraphicsSetStages().
+//!
+//! Draws can also be recorded ahead of time into command buffers, one per
+//! thread if need be, and handed to GraphicsSubmit(). Buffers are drawn in the
+//! order they're submitted, after any draws made directly on graphics, so the
+//! result doesn't depend on which thread finished recording first. Submission
+//! doesn't consume a buffer: one holding static content can be submitted
+//! again every frame without being re-recorded.
+//!
+//! Rasterization can be pipelined with GraphicsSetLatency(). The sorted
+//! triangles of a frame are then handed to a dedicated raster thread in
+//! batches, through a bounded lock-free queue, and GraphicsEndFrame() returns
+//! without waiting for them to be drawn. The geometry of the next frame
+//! overlaps the rasterization of this one, and each frame is presented that
+//! many frames after it was ended.
 
 #ifndef GRAPHICS_VERSION
 #define GRAPHICS_VERSION "0.1.0" //!< include guard
 
+#include <stddef.h> // size_t
+
 #include "SDL2/SDL.h"
 
+#include "math.h"
+
+struct graphics;
 struct triangle;
 struct texture;
+struct mesh;
+struct mesh_range;
+struct job_system;
+struct arena;
+struct array;
+
+//! Maximum number of instances of a draw processed by one geometry job.
+#define GRAPHICS_CHUNK_INSTANCES 64
+
+//! Maximum number of sorted triangles handed to the raster thread at once.
+#define GRAPHICS_BATCH_TRIANGLES 512
+
+//! Fractional bits of the fixed point screen coordinates of raster triangles.
+#define GRAPHICS_SUBPIXEL_BITS 4
+
+//! Largest screen width or height raster triangle coordinates can address.
+#define GRAPHICS_MAX_SCREEN_SIZE (65536 >> GRAPHICS_SUBPIXEL_BITS)
+
+//! Number of batches the raster thread can have queued; a power of two.
+#define GRAPHICS_QUEUE_SIZE 1024
+
+//! Largest number of frames GraphicsSetLatency() allows in flight.
+#define GRAPHICS_MAX_LATENCY 2
+
+//! Bytes each frame's and worker's arena first reserves.
+#define GRAPHICS_ARENA_BLOCK_SIZE (256 * 1024)
+
+//! \brief Surface properties of a draw
+struct material {
+        struct texture *texture; //!< texture to sample, or NULL to fill with the lit color
+        unsigned int color; //!< 32-bit RGBA base color, used when there is no texture
+};
+
+//! \brief Camera and lighting for a frame
+struct graphics_view {
+        struct mat4x4 matView; //!< world to view space
+        struct mat4x4 matProj; //!< view to clip space
+        struct vec3 camera; //!< world space camera position
+        struct vec3 lightDirection; //!< unit world space direction towards the light
+        unsigned int clearColor; //!< 32-bit RGBA color the screen is cleared to
+        Uint64 inputTime; //!< SDL_GetPerformanceCounter() when the input the view reflects was sampled, or 0
+};
+
+//! \brief Counters describing the work done in a single frame
+struct graphics_stats {
+        int draws; //!< draw calls submitted
+        int instances; //!< mesh instances submitted
+        int instancesCulled; //!< instances entirely outside the view frustum
+        int instancesInside; //!< instances entirely inside the view frustum, drawn without clipping
+        int instancesIntersecting; //!< instances straddling the view frustum
+        int instancesSimplified; //!< instances drawn at a simplified level of detail
+        int ranges; //!< contiguous triangle ranges left after hierarchy and meshlet culling
+        int trisFrustumCulled; //!< triangles in hierarchy nodes outside the view frustum
+        int trisClusterCulled; //!< triangles in meshlets that are backfacing or outside the view frustum
+        int trisBackfacing; //!< triangles rejected by backface culling
+        int trisRasterized; //!< triangles sent to the rasterizer after clipping
+        int vertexTransforms; //!< vertices transformed into view space
+        double inputLatency; //!< milliseconds from the view's inputTime to presentation, or 0 without one
+        size_t arenaBytes; //!< bytes allocated from the frame's and workers' arenas
+        size_t arenaPeak; //!< most bytes the frame's and workers' arenas have held between resets
+};
+
+//! \brief A mesh draw recorded into a command buffer
+struct graphics_command {
+        struct mesh *mesh;
+        int firstTransform; //!< index of the first instance's world matrix in the buffer's transforms
+        int count; //!< number of instances
+        int *lods; //!< count levels of detail each instance was last drawn at, or NULL
+        int material; //!< index into the buffer's materials
+};
+
+//! \brief An append-only list of draw commands
+//!
+//! Recording only touches the buffer itself, so any number of threads may
+//! record at once as long as each has its own buffer. Reset buffers keep
+//! their storage; recording only allocates when a buffer outgrows everything
+//! it has held before.
+struct graphics_command_buffer {
+        struct graphics_command *commands;
+        int commandCount;
+        int commandCapacity;
+
+        struct mat4x4 *transforms; //!< world matrices of every instance of every command
+        int transformCount;
+        int transformCapacity;
+
+        struct material *materials; //!< materials referenced by the commands
+        int materialCount;
+        int materialCapacity;
+};
+
+//! \brief A draw ready for the pipeline, resolved from a submitted command
+struct graphics_draw {
+        struct mesh *mesh;
+        struct mat4x4 *transforms; //!< count object to world matrices, owned by the submitted buffer
+        int count; //!< number of instances
+        int *lods; //!< count levels of detail each instance was last drawn at, or NULL
+        int material; //!< index into graphics_frame.materials
+};
+
+//! \brief A run of instances of one draw, processed by the geometry stage as a unit
+struct graphics_chunk {
+        int draw; //!< index into graphics_frame.draws
+        int first; //!< first instance of the draw
+        int count; //!< number of instances
+        int worker; //!< worker the chunk's triangles were written to
+        int firstTri; //!< first of the chunk's triangles in the worker's list
+        int triCount; //!< number of triangles the chunk produced
+};
+
+//! \brief A corner of a raster triangle
+//!
+//! Texture coordinates are divided by the clip space w so they interpolate
+//! linearly across the screen; dividing by the interpolated 1 / w recovers
+//! them. See GraphicsTriangleTextured().
+struct graphics_raster_vertex {
+        unsigned short x; //!< screen x in steps of 1 / (1 << GRAPHICS_SUBPIXEL_BITS) pixels
+        unsigned short y; //!< screen y in steps of 1 / (1 << GRAPHICS_SUBPIXEL_BITS) pixels
+        float u; //!< u / w
+        float v; //!< v / w
+        float w; //!< 1 / w
+};
+
+//! \brief A projected triangle, clipped to the screen, as the raster stage reads it
+//!
+//! Exactly one cache line: the vertices carry only what's interpolated across
+//! the screen, and depth is reduced to the single key the sort stage orders
+//! by. See GraphicsEmitTriangle().
+struct graphics_raster_triangle {
+        _Alignas(64) struct graphics_raster_vertex v[3];
+        float depth; //!< sort key; deeper triangles are drawn first
+        unsigned int color; //!< lit color, drawn when the material has no texture
+        unsigned int material; //!< index into graphics_frame.materials
+};
+
+//! \brief Per-thread output and scratch space of the geometry stage
+//!
+//! Each thread appends the triangles of every chunk it processes to its own
+//! worker, so chunks never contend for anything. GraphicsEndFrame() then
+//! concatenates the chunks' triangles in chunk order, which makes the render
+//! list independent of how chunks were spread over threads.
+struct graphics_worker {
+        struct arena *arena; //!< holds tris; reset before every frame's geometry
+        struct graphics_raster_triangle *tris; //!< raster triangles of every chunk this worker processed
+        int trisCount;
+        int trisCapacity;
+
+        struct graphics_stats stats; //!< geometry counters of every chunk this worker processed
+
+        // Scratch space for GraphicsGeometryStage().
+        // Vertices are transformed into view space at most once per
+        // instance, and only when a front facing triangle uses them.
+        // vertexStamp records which instance viewVerts[i] was last
+        // computed for.
+        struct vec3 *viewVerts;
+        unsigned int *vertexStamp;
+        unsigned int stamp;
+        int vertexCapacity;
+
+        struct mesh_range *nodeRanges;
+        struct mesh_range *ranges;
+        int rangeCapacity;
+
+        // Scratch space for GraphicsEmitTriangle(). Each screen edge clips
+        // the triangles of one array into the other.
+        struct array *clipped[2];
+
+        struct sphere *spheres; //!< world space bounds of each instance in the chunk
+        int *visibility; //!< FRUSTUM_* classification of each instance in the chunk
+        struct mat4x4 *matWorldView;
+        struct mat4x4 *matWorldViewProj;
+};
+
+//! \brief Transient state of the frame being built
+//!
+//! Every array is allocated from the frame's arena, which is reset when the
+//! frame is begun. The arena keeps the largest size any frame has needed, so
+//! steady-state frames don't allocate.
+//!
+//! Graphics keeps one frame per frame in flight, plus the one being built, so
+//! a frame is left untouched until it has been presented.
+struct graphics_frame {
+        unsigned int number; //!< frames begun before and including this one
+        struct graphics_view view;
+        int width; //!< screen width in pixels
+        int height; //!< screen height in pixels
+        struct arena *arena; //!< holds every array below; stages may allocate scratch space from it too
+
+        struct graphics_command_buffer *immediate; //!< draws made directly on graphics; always submitted first
+        struct graphics_command_buffer **submitted; //!< buffers in submission order
+        int submittedCount;
+        int submittedCapacity;
+
+        struct graphics_draw *draws; //!< every submitted command, resolved in submission order
+        int drawCount;
+
+        struct material *materials; //!< materials of every submitted buffer, concatenated
+        int materialCount;
+
+        struct graphics_chunk *chunks; //!< every draw split into runs of instances, in submission order
+        int chunkCount;
+
+        struct graphics_raster_triangle *renderTris; //!< raster triangles waiting to be sorted and drawn
+        int renderTrisCount;
+
+        struct graphics_stats stats;
+};
+
+//! \brief The replaceable steps of the retained draw pipeline
+//!
+//! GraphicsEndFrame() calls geometry once per chunk of at most
+//! GRAPHICS_CHUNK_INSTANCES instances of a draw, then sort once, then raster
+//! once per batch of at most GRAPHICS_BATCH_TRIANGLES sorted triangles, in
+//! order. Geometry may be called from several threads at once, each with its
+//! own worker; it must not modify anything else. When rasterization is
+//! pipelined, raster is called on the raster thread and may only modify the
+//! pixels and frame->stats.trisRasterized.
+struct graphics_stages {
+        //! Cull, light, project and clip instances [first, first + count) of a draw into worker->tris.
+        void (*geometry)(struct graphics_frame *frame, struct graphics_worker *worker, struct graphics_draw *draw, int first, int count);
+        //! Order frame->renderTris for drawing.
+        void (*sort)(struct graphics_frame *frame);
+        //! Draw frame->renderTris [first, first + count).
+        void (*raster)(struct graphics *graphics, struct graphics_frame *frame, int first, int count);
+};
 
 //! \brief Creates and initializes a new graphics object isntance
 //!
@@ -36,21 +288,25 @@ struct texture;
 //! being scale^2
 //!
 //! \param[in] title The title displayed in the window titlebar
-//! \param[in] width Width of the display area of the window, in pixels
-//! \param[in] height Height of the display are of the window, in pixels
+//! \param[in] width Width of the display area of the window, in pixels, at most GRAPHICS_MAX_SCREEN_SIZE
+//! \param[in] height Height of the display are of the window, in pixels, at most GRAPHICS_MAX_SCREEN_SIZE
 //! \param[in] scale Size and rendering scale, natural number multiple
-//! \return The initialized graphics object
+//! \return The initialized graphics object, or NULL on failure
 struct graphics *
 GraphicsInit(char *title, int width, int height, int scale);
 
 //! \brief De-initializes and frees memory for the given graphics object
+//!
+//! Waits for the raster thread to finish every frame in flight, so any
+//! textures those frames use must still be valid.
 //! \param[in,out] graphics The initialized opcode object to be cleaned and reclaimed
 void
 GraphicsDeinit(struct graphics *graphics);
 
 //! \brief Initializes the graphics subsystem for drawing routines
 //!
-//! Internally locks streaming texture for direct manipulation.
+//! Internally locks streaming texture for direct manipulation. Immediate mode
+//! drawing is only available while rasterization isn't pipelined.
 //!
 //! \param[in, out] graphics Graphics state to be manipulated
 void
@@ -64,6 +320,229 @@ GraphicsBegin(struct graphics *graphics);
 void
 GraphicsEnd(struct graphics *graphics);
 
+//! \brief The stages GraphicsInit() configures
+//!
+//! \return GraphicsGeometryStage(), GraphicsSortStage() and GraphicsRasterStage()
+struct graphics_stages
+GraphicsDefaultStages();
+
+//! \brief Replace the pipeline stages used by GraphicsEndFrame()
+//!
+//! Any stage left NULL is reset to its default. Every frame still in flight
+//! is presented first, so this mustn't be called between
+//! GraphicsBeginFrame() and GraphicsEndFrame().
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+//! \param[in] stages the new stages
+void
+GraphicsSetStages(struct graphics *graphics, struct graphics_stages stages);
+
+//! \brief Run the geometry stage on a job system
+//!
+//! Chunks of instances are spread over every thread of the job system.
+//! Without one they all run on the thread calling GraphicsEndFrame().
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+//! \param[in] jobs the job system to use, or NULL; must outlive its use by graphics
+void
+GraphicsSetJobSystem(struct graphics *graphics, struct job_system *jobs);
+
+//! \brief Refresh each frame's view just before the geometry stage reads it
+//!
+//! GraphicsEndFrame() calls latch with the frame's view before doing anything
+//! else, so the camera can be updated from input sampled as late as possible
+//! rather than when the frame was begun. latch runs on the thread calling
+//! GraphicsEndFrame().
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+//! \param[in] latch called with data and the view to update, or NULL to use the view given to GraphicsBeginFrame() as is
+//! \param[in] data passed to latch
+void
+GraphicsSetViewLatch(struct graphics *graphics, void (*latch)(void *data, struct graphics_view *view), void *data);
+
+//! \brief Pipeline rasterization on a thread of its own
+//!
+//! With a latency of 0, GraphicsEndFrame() rasterizes and presents each frame
+//! before returning. With a latency of 1 or 2, a frame is rasterized on a
+//! dedicated thread while the caller moves on to the next one, and is
+//! presented by the GraphicsEndFrame() that many frames later. A latency of
+//! 1 overlaps one frame's geometry with the previous frame's rasterization; 2
+//! also lets the raster thread run a whole frame behind to absorb frames
+//! with uneven geometry and raster costs.
+//!
+//! Every frame still in flight is presented before the latency changes, so
+//! this mustn't be called between GraphicsBeginFrame() and GraphicsEndFrame().
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+//! \param[in] latency frames between ending a frame and presenting it, clamped to [0, GRAPHICS_MAX_LATENCY]
+//! \return the latency now in effect; 0 if the raster thread couldn't be started
+int
+GraphicsSetLatency(struct graphics *graphics, int latency);
+
+//! \brief Start recording draws for a new frame
+//!
+//! Discards the draws, transforms and materials of the previous frame and
+//! resets the frame stats.
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+//! \param[in] view camera and lighting used by every draw in the frame
+void
+GraphicsBeginFrame(struct graphics *graphics, struct graphics_view *view);
+
+//! \brief Record a draw of a single mesh
+//!
+//! Equivalent to recording into a command buffer submitted before any other.
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+//! \param[in] mesh the mesh to draw; must stay valid until GraphicsEndFrame()
+//! \param[in] transform object to world space
+//! \param[in] material surface properties
+void
+GraphicsDrawMesh(struct graphics *graphics, struct mesh *mesh, struct mat4x4 transform, struct material material);
+
+//! \brief Record a draw of many instances of a mesh
+//!
+//! The transforms are copied. Transforms may rotate, translate and scale
+//! uniformly.
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+//! \param[in] mesh the mesh to draw; must stay valid until GraphicsEndFrame()
+//! \param[in] transforms count object to world space matrices, one per instance
+//! \param[in,out] lods count levels of detail each instance was last drawn at, updated at the end of the frame; or NULL
+//! \param[in] count number of instances
+//! \param[in] material surface properties shared by every instance
+void
+GraphicsDrawMeshInstanced(struct graphics *graphics, struct mesh *mesh, struct mat4x4 *transforms, int *lods, int count, struct material material);
+
+//! \brief Submit a command buffer for drawing in the current frame
+//!
+//! The buffer is drawn after every buffer submitted before it. It isn't
+//! copied, so it must not be modified until GraphicsEndFrame() returns.
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+//! \param[in] buffer the commands to draw
+void
+GraphicsSubmit(struct graphics *graphics, struct graphics_command_buffer *buffer);
+
+//! \brief Run every recorded draw through the pipeline and present the result
+//!
+//! Calls GraphicsBegin(), clears the screen and calls GraphicsEnd() itself.
+//! When rasterization is pipelined the frame is instead queued for the raster
+//! thread, and the frame ended latency frames ago is presented. Materials'
+//! textures must stay valid until the frame has been presented.
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+void
+GraphicsEndFrame(struct graphics *graphics);
+
+//! \brief Initialize a new, empty command buffer
+//!
+//! \param[in] commandCapacity number of commands to reserve space for
+//! \param[in] transformCapacity number of instance transforms to reserve space for
+//! \return an empty command buffer
+struct graphics_command_buffer *
+GraphicsCommandBufferInit(int commandCapacity, int transformCapacity);
+
+//! \brief De-initialize a command buffer
+//!
+//! \param[in,out] buffer the command buffer to be de-initialized
+void
+GraphicsCommandBufferDeinit(struct graphics_command_buffer *buffer);
+
+//! \brief Discard every command in a buffer, keeping its storage
+//!
+//! \param[in,out] buffer the command buffer to empty
+void
+GraphicsCommandBufferReset(struct graphics_command_buffer *buffer);
+
+//! \brief Record a draw of many instances of a mesh into a command buffer
+//!
+//! The transforms are copied. Consecutive commands with the same material
+//! share one material entry.
+//!
+//! \param[in,out] buffer the command buffer to append to
+//! \param[in] mesh the mesh to draw; must stay valid until the buffer is last drawn
+//! \param[in] transforms count object to world space matrices, one per instance
+//! \param[in,out] lods count levels of detail each instance was last drawn at, updated whenever the buffer is drawn; or NULL
+//! \param[in] count number of instances
+//! \param[in] material surface properties shared by every instance
+void
+GraphicsRecordDrawMeshInstanced(struct graphics_command_buffer *buffer, struct mesh *mesh, struct mat4x4 *transforms, int *lods, int count, struct material material);
+
+//! \brief Counters for the last frame presented by GraphicsEndFrame()
+//!
+//! \param[in] graphics Graphics state to query
+//! \return the frame's stats
+struct graphics_stats
+GraphicsFrameStats(struct graphics *graphics);
+
+//! \brief Prints debug information about frame stats
+//!
+//! \param[in] stats the stats to print
+//! \param[in] name optional name to label the output with, or NULL
+void
+GraphicsStatsDebug(struct graphics_stats stats, char *name);
+
+//! \brief Make room for count more triangles in a worker's output
+//!
+//! For use by geometry stages.
+//!
+//! \param[in,out] worker the worker about to append
+//! \param[in] count number of triangles about to be appended
+void
+GraphicsReserveTriangles(struct graphics_worker *worker, int count);
+
+//! \brief Clip a projected triangle to the screen and append it to a worker's output
+//!
+//! For use by geometry stages. Every piece of the clipped triangle keeps the
+//! whole triangle's depth, so the pieces are sorted together.
+//!
+//! \param[in] frame the frame being built
+//! \param[in,out] worker the worker to append to
+//! \param[in] projected triangle in screen space: x and y in pixels, texture coordinates divided by w
+void
+GraphicsEmitTriangle(struct graphics_frame *frame, struct graphics_worker *worker, struct triangle *projected);
+
+//! \brief Default geometry stage
+//!
+//! The mesh's bounds, face planes, index buffers and vertices are shared by
+//! every instance; only the transforms differ. Instance bounding spheres are
+//! culled against the world space frustum four at a time, and the world-view
+//! and world-view-projection matrices of every instance are composed in one
+//! batch. Visible instances are then narrowed down with the mesh's hierarchy
+//! and meshlets, backface culled, lit, clipped to the near plane, projected
+//! and emitted with GraphicsEmitTriangle().
+//!
+//! \param[in] frame the frame being built
+//! \param[in,out] worker the calling thread's output and scratch space
+//! \param[in] draw the draw to process
+//! \param[in] first first instance to process
+//! \param[in] count number of instances to process, at most GRAPHICS_CHUNK_INSTANCES
+void
+GraphicsGeometryStage(struct graphics_frame *frame, struct graphics_worker *worker, struct graphics_draw *draw, int first, int count);
+
+//! \brief Default sort stage: orders triangles from back to front
+//!
+//! Triangles at the same depth are ordered by material, and otherwise keep
+//! their order. Only a small key per triangle is merge sorted, in scratch
+//! space from the frame's arena; the triangles are then copied once, into
+//! their sorted order, and renderTris is pointed at the copy.
+//!
+//! \param[in,out] frame the frame being built
+void
+GraphicsSortStage(struct graphics_frame *frame);
+
+//! \brief Default raster stage
+//!
+//! Draws each triangle textured, or solid if its material has no texture.
+//!
+//! \param[in,out] graphics Graphics state to be manipulated
+//! \param[in,out] frame the frame being drawn
+//! \param[in] first first triangle of frame->renderTris to draw
+//! \param[in] count number of triangles to draw
+void
+GraphicsRasterStage(struct graphics *graphics, struct graphics_frame *frame, int first, int count);
+
 //! \brief Sets all pixels in the screen to the given color
 //!
 //! \param[in, out] graphics Graphics state to be manipulated
@@ -80,7 +559,7 @@ GraphicsClearScreen(struct graphics *graphics, unsigned int color);
 //! \param[in] triangle The triangle to draw
 //! \param[in] color What color the wireframe should be rendered with
 void
-GraphicsTriangleWireframe(struct graphics *graphics, struct triangle triangle, unsigned int color);
+GraphicsTriangleWireframe(struct graphics *graphics, struct graphics_raster_triangle *triangle, unsigned int color);
 
 //! \brief Draw a triangle with the given set of x and y coordinates
 //!
@@ -92,7 +571,7 @@ GraphicsTriangleWireframe(struct graphics *graphics, struct triangle triangle, u
 //!
 //! \see Source: http://www.sunshine2k.de/coding/java/TriangleRasterization/TriangleRasterization.html
 void
-GraphicsTriangleSolid(struct graphics *graphics, struct triangle triangle, unsigned int color);
+GraphicsTriangleSolid(struct graphics *graphics, struct graphics_raster_triangle *triangle, unsigned int color);
 
 //! \brief Draw a textured triangle with the given set of x and y coordinates
 //!
@@ -104,6 +583,6 @@ GraphicsTriangleSolid(struct graphics *graphics, struct triangle triangle, unsig
 //!
 //! \see Source: https://github.com/OneLoneCoder/videos/blob/master/OneLoneCoder_olcEngine3D_Part4.cpp
 void
-GraphicsTriangleTextured(struct graphics *graphics, struct triangle tri, struct texture *texture);
+GraphicsTriangleTextured(struct graphics *graphics, struct graphics_raster_triangle *tri, struct texture *texture);
 
 #endif // GRAPHICS_VERSION
@@ -0,0 +1,422 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: heightmap.c
+  Created: 2026-10-18
+  Updated: 2026-10-18
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+#include <stdlib.h> // malloc, realloc, free
+#include <string.h> // memset
+#include <stdio.h> // printf, fprintf
+#include <math.h> // sqrtf, fabsf
+
+#include "heightmap.h"
+#include "mesh.h"
+#include "graphics.h"
+#include "simd.h"
+#include "external/stb_image.h"
+
+//! \brief World space height of a sample
+//!
+//! \param[in] heightmap the heightmap to sample
+//! \param[in] x sample column, clamped to the heightmap
+//! \param[in] z sample row, clamped to the heightmap
+//! \return the height
+float HeightmapHeight(struct heightmap *heightmap, int x, int z) {
+        x = x < 0 ? 0 : (x >= heightmap->width ? heightmap->width - 1 : x);
+        z = z < 0 ? 0 : (z >= heightmap->depth ? heightmap->depth - 1 : z);
+        return (float)heightmap->heights[z * heightmap->width + x] * (heightmap->scale / 65535.0f);
+}
+
+//! \brief Height of a level's triangles over a sample of a patch
+//!
+//! Each cell of the level is split along the diagonal from its +x corner to
+//! its +z corner, as HeightmapGenerate() splits it.
+//!
+//! \param[in] heightmap the heightmap
+//! \param[in] x0 first sample column of the patch
+//! \param[in] z0 first sample row of the patch
+//! \param[in] i sample column within the patch
+//! \param[in] j sample row within the patch
+//! \param[in] step samples between the level's vertices
+//! \return the interpolated height
+float HeightmapLevelHeight(struct heightmap *heightmap, int x0, int z0, int i, int j, int step) {
+        int ci = i / step * step;
+        int cj = j / step * step;
+        if (ci == HEIGHTMAP_PATCH_SIZE) ci -= step;
+        if (cj == HEIGHTMAP_PATCH_SIZE) cj -= step;
+        float u = (float)(i - ci) / (float)step;
+        float v = (float)(j - cj) / (float)step;
+
+        float h00 = HeightmapHeight(heightmap, x0 + ci, z0 + cj);
+        float h10 = HeightmapHeight(heightmap, x0 + ci + step, z0 + cj);
+        float h01 = HeightmapHeight(heightmap, x0 + ci, z0 + cj + step);
+        float h11 = HeightmapHeight(heightmap, x0 + ci + step, z0 + cj + step);
+        if (u + v <= 1.0f) {
+                return h00 + u * (h10 - h00) + v * (h01 - h00);
+        }
+        return h11 + (1.0f - u) * (h01 - h11) + (1.0f - v) * (h10 - h11);
+}
+
+//! \brief Compute a patch's bounds and the height error of each of its levels
+//!
+//! \param[in] heightmap the heightmap
+//! \param[in] px patch column
+//! \param[in] pz patch row
+//! \param[out] patch the patch to fill in
+void HeightmapMeasurePatch(struct heightmap *heightmap, int px, int pz, struct heightmap_patch *patch) {
+        int x0 = px * HEIGHTMAP_PATCH_SIZE;
+        int z0 = pz * HEIGHTMAP_PATCH_SIZE;
+
+        float low = INFINITY;
+        float high = -INFINITY;
+        for (int j = 0; j <= HEIGHTMAP_PATCH_SIZE; j++) {
+                for (int i = 0; i <= HEIGHTMAP_PATCH_SIZE; i++) {
+                        float h = HeightmapHeight(heightmap, x0 + i, z0 + j);
+                        low = h < low ? h : low;
+                        high = h > high ? h : high;
+                }
+        }
+        float size = (float)HEIGHTMAP_PATCH_SIZE * heightmap->spacing;
+        patch->bounds.min = Vec3Init(heightmap->origin.x + (float)x0 * heightmap->spacing, low, heightmap->origin.z + (float)z0 * heightmap->spacing);
+        patch->bounds.max = Vec3Init(patch->bounds.min.x + size, high, patch->bounds.min.z + size);
+
+        // Errors never shrink from one level to the next, so the coarsest
+        // acceptable level can be found by searching down from the top.
+        patch->error[0] = 0.0f;
+        for (int level = 1; level < HEIGHTMAP_LEVELS; level++) {
+                float error = patch->error[level - 1];
+                for (int j = 0; j <= HEIGHTMAP_PATCH_SIZE; j++) {
+                        for (int i = 0; i <= HEIGHTMAP_PATCH_SIZE; i++) {
+                                float h = HeightmapHeight(heightmap, x0 + i, z0 + j);
+                                float d = fabsf(h - HeightmapLevelHeight(heightmap, x0, z0, i, j, 1 << level));
+                                error = d > error ? d : error;
+                        }
+                }
+                patch->error[level] = error;
+        }
+}
+
+//! \brief Bytes of storage of a patch mesh allocated for a level
+//!
+//! \param[in] level the level the storage was allocated for
+//! \return the size in bytes
+size_t HeightmapMeshBytes(int level) {
+        int quads = HEIGHTMAP_PATCH_SIZE >> level;
+        size_t vertices = (size_t)(quads + 1) * (quads + 1);
+        size_t tris = (size_t)quads * quads * 2;
+        return sizeof(struct mesh) + sizeof(struct bvh_node) +
+               vertices * (sizeof(struct vec3) * 2 + sizeof(struct vec2)) +
+               tris * (sizeof(unsigned int) * 3 + sizeof(struct vec3));
+}
+
+struct heightmap *HeightmapInit(char *file, float spacing, float scale) {
+        int width, depth, channels;
+        unsigned short *heights = stbi_load_16(file, &width, &depth, &channels, 1);
+        if (NULL == heights) {
+                fprintf(stderr, "Couldn't load heightmap %s\n", file);
+                return NULL;
+        }
+        if (width <= HEIGHTMAP_PATCH_SIZE || depth <= HEIGHTMAP_PATCH_SIZE) {
+                fprintf(stderr, "Heightmap %s is smaller than a patch\n", file);
+                stbi_image_free(heights);
+                return NULL;
+        }
+
+        struct heightmap *heightmap = (struct heightmap *)malloc(sizeof(struct heightmap));
+        memset(heightmap, 0, sizeof(struct heightmap));
+        heightmap->heights = heights;
+        heightmap->width = width;
+        heightmap->depth = depth;
+        heightmap->spacing = spacing;
+        heightmap->scale = scale;
+        heightmap->transform = Mat4x4Identity();
+
+        heightmap->patchesX = (width - 1) / HEIGHTMAP_PATCH_SIZE;
+        heightmap->patchesZ = (depth - 1) / HEIGHTMAP_PATCH_SIZE;
+        float sizeX = (float)(heightmap->patchesX * HEIGHTMAP_PATCH_SIZE) * spacing;
+        float sizeZ = (float)(heightmap->patchesZ * HEIGHTMAP_PATCH_SIZE) * spacing;
+        heightmap->origin = Vec3Init(-sizeX * 0.5f, 0.0f, -sizeZ * 0.5f);
+
+        int count = heightmap->patchesX * heightmap->patchesZ;
+        heightmap->patches = (struct heightmap_patch *)calloc(count, sizeof(struct heightmap_patch));
+        for (int pz = 0; pz < heightmap->patchesZ; pz++) {
+                for (int px = 0; px < heightmap->patchesX; px++) {
+                        HeightmapMeasurePatch(heightmap, px, pz, &heightmap->patches[pz * heightmap->patchesX + px]);
+                }
+        }
+
+        heightmap->stats.heightBytes = sizeof(unsigned short) * (size_t)width * depth;
+        return heightmap;
+}
+
+void HeightmapDeinit(struct heightmap *heightmap) {
+        if (NULL == heightmap) {
+                return;
+        }
+
+        for (int i = 0; i < heightmap->patchesX * heightmap->patchesZ; i++) {
+                MeshDeinit(heightmap->patches[i].mesh);
+        }
+        for (int level = 0; level < HEIGHTMAP_LEVELS; level++) {
+                for (int i = 0; i < heightmap->spareCount[level]; i++) {
+                        MeshDeinit(heightmap->spare[level][i]);
+                }
+                free(heightmap->spare[level]);
+        }
+        free(heightmap->patches);
+        stbi_image_free(heightmap->heights);
+        free(heightmap);
+}
+
+//! \brief Give a patch's mesh back for reuse
+//!
+//! \param[in,out] heightmap the heightmap owning the patch
+//! \param[in,out] patch the patch, which is left without a mesh
+void HeightmapReleaseMesh(struct heightmap *heightmap, struct heightmap_patch *patch) {
+        if (NULL == patch->mesh) {
+                return;
+        }
+
+        int level = patch->meshLevel;
+        if (heightmap->spareCount[level] == heightmap->spareCapacity[level]) {
+                heightmap->spareCapacity[level] = heightmap->spareCapacity[level] < 16 ? 16 : heightmap->spareCapacity[level] * 2;
+                heightmap->spare[level] = (struct mesh **)realloc(heightmap->spare[level], sizeof(struct mesh *) * heightmap->spareCapacity[level]);
+        }
+        heightmap->spare[level][heightmap->spareCount[level]++] = patch->mesh;
+        patch->mesh = NULL;
+}
+
+//! \brief Make sure a patch has a mesh with room for a level
+//!
+//! \param[in,out] heightmap the heightmap owning the patch
+//! \param[in,out] patch the patch
+//! \param[in] level the level the mesh must hold
+void HeightmapReserveMesh(struct heightmap *heightmap, struct heightmap_patch *patch, int level) {
+        if (NULL != patch->mesh && patch->meshLevel <= level) {
+                return;
+        }
+        HeightmapReleaseMesh(heightmap, patch);
+
+        if (heightmap->spareCount[level] > 0) {
+                patch->mesh = heightmap->spare[level][--heightmap->spareCount[level]];
+        } else {
+                int quads = HEIGHTMAP_PATCH_SIZE >> level;
+                patch->mesh = MeshInit((quads + 1) * (quads + 1), quads * quads * 2);
+                patch->mesh->nodes = (struct bvh_node *)malloc(sizeof(struct bvh_node));
+                patch->mesh->nodeCount = 1;
+                heightmap->stats.meshBytes += HeightmapMeshBytes(level);
+        }
+        patch->meshLevel = level;
+}
+
+//! \brief Generate a patch's triangles at a level of detail
+//!
+//! Edges shared with a coarser neighbour take their heights from the
+//! neighbour's samples, so both sides of the edge follow the same line.
+//!
+//! \param[in] heightmap the heightmap
+//! \param[in] px patch column
+//! \param[in] pz patch row
+//! \param[in] level the level to generate
+//! \param[in] edges levels the -x, +x, -z and +z edges must match, each no finer than level
+//! \param[in,out] mesh storage with room for the level
+void HeightmapGenerate(struct heightmap *heightmap, int px, int pz, int level, int edges[4], struct mesh *mesh) {
+        int step = 1 << level;
+        int quads = HEIGHTMAP_PATCH_SIZE >> level;
+        int x0 = px * HEIGHTMAP_PATCH_SIZE;
+        int z0 = pz * HEIGHTMAP_PATCH_SIZE;
+        float spacing = heightmap->spacing;
+        float uScale = 1.0f / (float)(heightmap->width - 1);
+        float vScale = 1.0f / (float)(heightmap->depth - 1);
+
+        int vertex = 0;
+        for (int b = 0; b <= quads; b++) {
+                for (int a = 0; a <= quads; a++) {
+                        int i = a * step;
+                        int j = b * step;
+                        int x = x0 + i;
+                        int z = z0 + j;
+
+                        // Find the edge, if any, that must follow a coarser
+                        // neighbour, and the sample offset along it.
+                        int edgeStep = step;
+                        int along = 0;
+                        if (0 == a || quads == a) {
+                                edgeStep = edges[0 == a ? 0 : 1];
+                                along = j;
+                        }
+                        if ((0 == b || quads == b) && edges[0 == b ? 2 : 3] > edgeStep) {
+                                edgeStep = edges[0 == b ? 2 : 3];
+                                along = i;
+                        }
+
+                        float h = HeightmapHeight(heightmap, x, z);
+                        int offset = along % edgeStep;
+                        if (edgeStep > step && 0 != offset) {
+                                float t = (float)offset / (float)edgeStep;
+                                float h0, h1;
+                                if (along == j) {
+                                        h0 = HeightmapHeight(heightmap, x, z - offset);
+                                        h1 = HeightmapHeight(heightmap, x, z - offset + edgeStep);
+                                } else {
+                                        h0 = HeightmapHeight(heightmap, x - offset, z);
+                                        h1 = HeightmapHeight(heightmap, x - offset + edgeStep, z);
+                                }
+                                h = h0 + (h1 - h0) * t;
+                        }
+
+                        float dx = HeightmapHeight(heightmap, x + 1, z) - HeightmapHeight(heightmap, x - 1, z);
+                        float dz = HeightmapHeight(heightmap, x, z + 1) - HeightmapHeight(heightmap, x, z - 1);
+                        struct vec3 normal = Vec3Normalize(Vec3Init(-dx, 2.0f * spacing, -dz));
+                        normal.w = 0.0f;
+
+                        mesh->positions[vertex] = Vec3Init(heightmap->origin.x + (float)x * spacing, h, heightmap->origin.z + (float)z * spacing);
+                        mesh->normals[vertex] = normal;
+                        mesh->uvs[vertex].u = (float)x * uScale;
+                        mesh->uvs[vertex].v = (float)z * vScale;
+                        mesh->uvs[vertex].w = 1.0f;
+                        vertex++;
+                }
+        }
+
+        // Two triangles per cell, split from the +x corner to the +z corner
+        // and wound so their face normals point up.
+        unsigned int *index = mesh->indices;
+        for (int b = 0; b < quads; b++) {
+                for (int a = 0; a < quads; a++) {
+                        unsigned int v00 = (unsigned int)(b * (quads + 1) + a);
+                        unsigned int v10 = v00 + 1;
+                        unsigned int v01 = v00 + (unsigned int)quads + 1;
+                        unsigned int v11 = v01 + 1;
+                        *index++ = v00;
+                        *index++ = v01;
+                        *index++ = v10;
+                        *index++ = v10;
+                        *index++ = v01;
+                        *index++ = v11;
+                }
+        }
+
+        mesh->vertexCount = vertex;
+        mesh->triCount = quads * quads * 2;
+        MeshComputeFacePlanes(mesh);
+        MeshComputeBounds(mesh);
+        mesh->nodes[0].bounds = mesh->bounds;
+        mesh->nodes[0].firstTri = 0;
+        mesh->nodes[0].triCount = mesh->triCount;
+        mesh->nodes[0].left = 0;
+}
+
+//! \brief Distance from a point to the nearest point of a box
+//!
+//! \param[in] box the box
+//! \param[in] point the point
+//! \return 0 if the point is inside the box, otherwise the distance
+float HeightmapBoxDistance(struct aabb box, struct vec3 point) {
+        float sum = 0.0f;
+        for (int a = 0; a < 3; a++) {
+                float d = 0.0f;
+                if (point.p[a] < box.min.p[a]) d = box.min.p[a] - point.p[a];
+                if (point.p[a] > box.max.p[a]) d = point.p[a] - box.max.p[a];
+                sum += d * d;
+        }
+        return sqrtf(sum);
+}
+
+void HeightmapUpdate(struct heightmap *heightmap, struct vec3 camera, struct mat4x4 matView, struct mat4x4 matProj, int screenHeight) {
+        struct heightmap_stats *stats = &heightmap->stats;
+        stats->patches = 0;
+        stats->generated = 0;
+        stats->triangles = 0;
+        memset(stats->levels, 0, sizeof(stats->levels));
+
+        // Pixels per world unit of height error at a distance of one.
+        float projScale = matProj.m[1][1] * 0.5f * (float)screenHeight;
+
+        // Each patch takes the coarsest level whose error projects to under
+        // the tolerance. Coarsening takes a little more, so patches near a
+        // threshold don't flicker between levels.
+        for (int i = 0; i < heightmap->patchesX * heightmap->patchesZ; i++) {
+                struct heightmap_patch *patch = &heightmap->patches[i];
+                float distance = HeightmapBoxDistance(patch->bounds, camera);
+                int level = 0;
+                for (int l = HEIGHTMAP_LEVELS - 1; l > 0; l--) {
+                        float tolerance = l > patch->level ? MESH_LOD_TOLERANCE * MESH_LOD_HYSTERESIS : MESH_LOD_TOLERANCE;
+                        if (patch->error[l] * projScale <= tolerance * distance) {
+                                level = l;
+                                break;
+                        }
+                }
+                patch->level = level;
+        }
+
+        struct mat4x4 matCull = matProj;
+        matCull.m[0][0] *= HEIGHTMAP_CULL_SCALE;
+        matCull.m[1][1] *= HEIGHTMAP_CULL_SCALE;
+        struct mat4x4 matViewCull;
+        SimdMat4x4Multiply(&matViewCull, &matView, &matCull);
+        struct frustum frustum = FrustumInit(matViewCull);
+
+        for (int pz = 0; pz < heightmap->patchesZ; pz++) {
+                for (int px = 0; px < heightmap->patchesX; px++) {
+                        struct heightmap_patch *patch = &heightmap->patches[pz * heightmap->patchesX + px];
+                        if (FRUSTUM_OUTSIDE == FrustumTestAABB(&frustum, patch->bounds)) {
+                                HeightmapReleaseMesh(heightmap, patch);
+                                continue;
+                        }
+
+                        // Each edge follows the coarser of the two patches
+                        // sharing it.
+                        int level = patch->level;
+                        int neighbours[4] = {
+                                px > 0 ? patch[-1].level : level,
+                                px < heightmap->patchesX - 1 ? patch[1].level : level,
+                                pz > 0 ? patch[-heightmap->patchesX].level : level,
+                                pz < heightmap->patchesZ - 1 ? patch[heightmap->patchesX].level : level,
+                        };
+                        int edges[4];
+                        int key = level;
+                        for (int e = 0; e < 4; e++) {
+                                edges[e] = 1 << (neighbours[e] > level ? neighbours[e] : level);
+                                key = key * HEIGHTMAP_LEVELS + (neighbours[e] > level ? neighbours[e] : level);
+                        }
+
+                        if (NULL == patch->mesh || key != patch->key) {
+                                HeightmapReserveMesh(heightmap, patch, level);
+                                HeightmapGenerate(heightmap, px, pz, level, edges, patch->mesh);
+                                patch->key = key;
+                                stats->generated++;
+                        }
+
+                        stats->patches++;
+                        stats->triangles += patch->mesh->triCount;
+                        stats->levels[level]++;
+                }
+        }
+}
+
+void HeightmapRecord(struct heightmap *heightmap, struct graphics_command_buffer *buffer, struct material material) {
+        for (int i = 0; i < heightmap->patchesX * heightmap->patchesZ; i++) {
+                if (NULL != heightmap->patches[i].mesh) {
+                        GraphicsRecordDrawMeshInstanced(buffer, heightmap->patches[i].mesh, &heightmap->transform, NULL, 1, material);
+                }
+        }
+}
+
+void HeightmapDebug(struct heightmap *heightmap, char *name) {
+        struct heightmap_stats *stats = &heightmap->stats;
+        printf("%s: %d patches in view, %d generated, %d tris; levels", name, stats->patches, stats->generated, stats->triangles);
+        for (int level = 0; level < HEIGHTMAP_LEVELS; level++) {
+                printf(" %d", stats->levels[level]);
+        }
+        printf("; heights %.1f KiB, patch meshes %.1f KiB\n", (double)stats->heightBytes / 1024.0, (double)stats->meshBytes / 1024.0);
+}
@@ -0,0 +1,155 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: heightmap.h
+  Created: 2026-10-18
+  Updated: 2026-10-18
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file heightmap.h
+//! Terrain drawn from a heightmap image by geomipmapping.
+//!
+//! Only the heights are kept, one 16-bit sample per texel. The grid is split
+//! into square patches of HEIGHTMAP_PATCH_SIZE quads, and every update each
+//! patch picks the coarsest level of detail whose largest height error
+//! projects to under MESH_LOD_TOLERANCE pixels. Level l samples every 2^l-th
+//! height.
+//!
+//! Triangles are generated only for patches in view, and only again when a
+//! patch's level or one of its neighbours' changes. Where a patch meets a
+//! coarser neighbour, the heights along their shared edge are interpolated
+//! from the neighbour's samples so the two edges coincide and no cracks
+//! open.
+//!
+//! Only the thread that created the heightmap may update or draw it.
+
+#ifndef HEIGHTMAP_VERSION
+#define HEIGHTMAP_VERSION "0.1.0" //!< include guard
+
+#include <stddef.h> // size_t
+
+#include "math.h"
+
+struct mesh;
+struct graphics_command_buffer;
+struct material;
+
+//! Quads along each side of a patch; a power of two.
+#define HEIGHTMAP_PATCH_SIZE 32
+
+//! Levels of detail of a patch: from one quad per texel to a single quad.
+#define HEIGHTMAP_LEVELS 6
+
+//! Factor applied to the projection's focal lengths when culling patches,
+//! widening the view so patches turned into view before the next update are
+//! already built.
+#define HEIGHTMAP_CULL_SCALE 0.75f
+
+//! \brief A square of the heightmap's grid drawn at one level of detail
+struct heightmap_patch {
+        struct aabb bounds; //!< world space bounds of every height in the patch
+        float error[HEIGHTMAP_LEVELS]; //!< largest world space height error of each level
+        int level; //!< level chosen by the last update
+        struct mesh *mesh; //!< generated triangles while the patch is in view, otherwise NULL
+        int meshLevel; //!< level of the mesh's storage, which fits any level from it up
+        int key; //!< levels of the patch and its neighbours the mesh was generated for
+};
+
+//! \brief Counters describing the last update
+struct heightmap_stats {
+        int patches; //!< patches in view
+        int generated; //!< patches whose triangles were generated
+        int triangles; //!< triangles in every patch in view
+        int levels[HEIGHTMAP_LEVELS]; //!< patches in view at each level
+        size_t heightBytes; //!< bytes of heights
+        size_t meshBytes; //!< bytes of generated patch meshes, in use and spare
+};
+
+//! \brief A heightmap and the patches generated from it
+struct heightmap {
+        unsigned short *heights; //!< width * depth samples, row by row along x
+        int width; //!< samples along the x axis
+        int depth; //!< samples along the z axis
+        float spacing; //!< world units between neighbouring samples
+        float scale; //!< world height of the largest sample
+        struct vec3 origin; //!< world position of the first sample at height 0
+
+        struct heightmap_patch *patches; //!< patchesX * patchesZ patches, row by row along x
+        int patchesX;
+        int patchesZ;
+        struct mat4x4 transform; //!< identity; patches are generated in world space
+
+        // Meshes of patches that left the view, by the level of their
+        // storage, ready for reuse.
+        struct mesh **spare[HEIGHTMAP_LEVELS];
+        int spareCount[HEIGHTMAP_LEVELS];
+        int spareCapacity[HEIGHTMAP_LEVELS];
+
+        struct heightmap_stats stats;
+};
+
+//! \brief Initialize a heightmap from an image file
+//!
+//! The image is read with stb_image and converted to 16-bit greyscale. Its
+//! width and height, less one, are rounded down to multiples of
+//! HEIGHTMAP_PATCH_SIZE; any samples beyond are ignored. The heightmap is
+//! centred on the origin in x and z.
+//!
+//! \param[in] file path to the image
+//! \param[in] spacing world units between neighbouring samples
+//! \param[in] scale world height of a white sample
+//! \return the heightmap, or NULL if the image couldn't be read or is smaller than one patch
+struct heightmap *
+HeightmapInit(char *file, float spacing, float scale);
+
+//! \brief De-initialize a heightmap
+//!
+//! Nothing may be drawing its patches.
+//!
+//! \param[in,out] heightmap the heightmap to be de-initialized
+void
+HeightmapDeinit(struct heightmap *heightmap);
+
+//! \brief Choose every patch's level of detail and generate those in view
+//!
+//! A patch's screen space error is its level's height error projected from
+//! the point of its bounds nearest the camera. Patches whose bounds are
+//! outside a slightly widened view frustum release their triangles.
+//!
+//! Regenerated patches are rewritten in place, so this must be called
+//! between frames, before the heightmap is recorded.
+//!
+//! \param[in,out] heightmap the heightmap to update
+//! \param[in] camera world space camera position
+//! \param[in] matView world to view space
+//! \param[in] matProj view to clip space
+//! \param[in] screenHeight height of the screen in pixels
+void
+HeightmapUpdate(struct heightmap *heightmap, struct vec3 camera, struct mat4x4 matView, struct mat4x4 matProj, int screenHeight);
+
+//! \brief Record a draw of every patch in view into a command buffer
+//!
+//! The recorded meshes stay valid until the next HeightmapUpdate().
+//!
+//! \param[in,out] heightmap the heightmap to draw
+//! \param[in,out] buffer the command buffer to append to
+//! \param[in] material surface properties of every patch
+void
+HeightmapRecord(struct heightmap *heightmap, struct graphics_command_buffer *buffer, struct material material);
+
+//! \brief Print the counters of a heightmap's last update
+//!
+//! \param[in] heightmap the heightmap to describe
+//! \param[in] name label printed with the counters
+void
+HeightmapDebug(struct heightmap *heightmap, char *name);
+
+#endif // HEIGHTMAP_VERSION
@@ -4,7 +4,7 @@
 
   File: input.c
   Created: 2019-06-21
-  Updated: 2019-08-27
+  Updated: 2026-10-18
   Author: Aaron Oman
   Notice: GNU GPLv3 License
 
@@ -18,24 +18,24 @@
 
 #include "SDL2/SDL.h"
 
-#include "math.h"
-
-extern struct vec3 camera; //!< global camera state
-extern struct vec3 lookDir; //!< global look direction state
-extern struct vec3 up; //!< global up vector state
-extern float yaw; //!< global view direction state
-extern double elapsedTime; //!< global time state
+#include "input.h"
 
 //! \brief Keypress state. Unexported.
 struct input {
         const unsigned char *sdlKeyStates;
+        void (*callback)(void *data, unsigned int keys, double seconds);
+        void *data;
+        Uint64 sampleTime; //!< performance counter at the last update, or 0
+        int quit;
 };
 
-struct input *InputInit() {
+struct input *InputInit(void (*callback)(void *data, unsigned int keys, double seconds), void *data) {
         struct input *i = (struct input *)malloc(sizeof(struct input));
         memset(i, 0, sizeof(struct input));
 
         i->sdlKeyStates = SDL_GetKeyboardState(NULL);
+        i->callback = callback;
+        i->data = data;
 
         return i;
 }
@@ -67,41 +67,49 @@ int InputIsQuitPressed(SDL_Event *event) {
         return 0;
 }
 
-void InputProcess(struct input *i) {
-        double t = elapsedTime / 1000.0f;
-        struct vec3 forward = Vec3Multiply(lookDir, 8.0f * t);
-        struct vec3 right = Vec3CrossProduct(up, lookDir);
-        right = Vec3Multiply(Vec3Normalize(right), 8.0f * t);
-
-        if (i->sdlKeyStates[SDL_SCANCODE_LEFT]) {
-                yaw += 2.0f * t;
-        }
-
-        if (i->sdlKeyStates[SDL_SCANCODE_RIGHT]) {
-                yaw -= 2.0f * t;
+void InputUpdate(struct input *i) {
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+                i->quit |= InputIsQuitPressed(&event);
         }
 
-        if (i->sdlKeyStates[SDL_SCANCODE_UP]) {
-                camera.y += 8.0f * t;
+        Uint64 now = SDL_GetPerformanceCounter();
+        double seconds = 0;
+        if (0 != i->sampleTime) {
+                seconds = (double)(now - i->sampleTime) / (double)SDL_GetPerformanceFrequency();
         }
-
-        if (i->sdlKeyStates[SDL_SCANCODE_DOWN]) {
-                camera.y -= 8.0f * t;
+        i->sampleTime = now;
+
+        static const struct {
+                SDL_Scancode scancode;
+                unsigned int key;
+        } bindings[] = {
+                { SDL_SCANCODE_LEFT, INPUT_KEY_LEFT },
+                { SDL_SCANCODE_RIGHT, INPUT_KEY_RIGHT },
+                { SDL_SCANCODE_UP, INPUT_KEY_UP },
+                { SDL_SCANCODE_DOWN, INPUT_KEY_DOWN },
+                { SDL_SCANCODE_W, INPUT_KEY_FORWARD },
+                { SDL_SCANCODE_S, INPUT_KEY_BACK },
+                { SDL_SCANCODE_A, INPUT_KEY_STRAFE_LEFT },
+                { SDL_SCANCODE_D, INPUT_KEY_STRAFE_RIGHT },
+        };
+
+        unsigned int keys = 0;
+        for (int b = 0; b < (int)(sizeof(bindings) / sizeof(bindings[0])); b++) {
+                if (i->sdlKeyStates[bindings[b].scancode]) {
+                        keys |= bindings[b].key;
+                }
         }
 
-        if (i->sdlKeyStates[SDL_SCANCODE_W]) {
-                camera = Vec3Add(camera, forward);
-        }
-
-        if (i->sdlKeyStates[SDL_SCANCODE_S]) {
-                camera = Vec3Subtract(camera, forward);
+        if (NULL != i->callback) {
+                i->callback(i->data, keys, seconds);
         }
+}
 
-        if (i->sdlKeyStates[SDL_SCANCODE_A]) {
-                camera = Vec3Subtract(camera, right);
-        }
+int InputQuitRequested(struct input *i) {
+        return i->quit;
+}
 
-        if (i->sdlKeyStates[SDL_SCANCODE_D]) {
-                camera = Vec3Add(camera, right);
-        }
+Uint64 InputSampleTime(struct input *i) {
+        return i->sampleTime;
 }
@@ -4,7 +4,7 @@
 
   File: input.h
   Created: 2019-07-21
-  Updated: 2019-08-27
+  Updated: 2026-10-18
   Author: Aaron Oman
   Notice: GNU GPLv3 License
 
@@ -16,19 +16,40 @@
 
 //! \file input.h
 //! A small interface to manage handling input separately from main().
+//!
+//! Input doesn't know what the keys it watches are for. Every call to
+//! InputUpdate() drains pending events, samples the keys held down and hands
+//! them to a callback along with the time since the previous sample. Calling
+//! InputUpdate() as late as possible before the result is needed, and as often
+//! as is convenient, keeps what's drawn close to what the user is doing.
 
 #ifndef INPUT_VERSION
 #define INPUT_VERSION "0.1.0" //!< include guard
 
 #include "SDL.h"
 
+#define INPUT_KEY_LEFT (1 << 0) //!< turn left
+#define INPUT_KEY_RIGHT (1 << 1) //!< turn right
+#define INPUT_KEY_UP (1 << 2) //!< move up
+#define INPUT_KEY_DOWN (1 << 3) //!< move down
+#define INPUT_KEY_FORWARD (1 << 4) //!< move forward
+#define INPUT_KEY_BACK (1 << 5) //!< move back
+#define INPUT_KEY_STRAFE_LEFT (1 << 6) //!< move left
+#define INPUT_KEY_STRAFE_RIGHT (1 << 7) //!< move right
+
 struct input;
-struct system;
 
 //! \brief Creates and initializes a new input object
+//!
+//! callback is called with every sample taken by InputUpdate(), with the
+//! INPUT_KEY_* bits of every key held down and the time since the previous
+//! sample.
+//!
+//! \param[in] callback called with data, the keys held down and the seconds since the previous sample
+//! \param[in] data passed to callback
 //! \return The initialized input object
 struct input *
-InputInit();
+InputInit(void (*callback)(void *data, unsigned int keys, double seconds), void *data);
 
 //! \brief De-initializes and frees memory for the given input object
 //! \param[in,out] input The initialized input object to be cleaned and reclaimed
@@ -42,16 +63,26 @@ InputDeinit(struct input *input);
 int
 InputIsQuitPressed(SDL_Event *event);
 
-//! \brief Handle input
-//!
-//! This function reaches into global state and changes it based on user input,
-//! doing things like changing the view direction.
+//! \brief Handle pending events and sample the keyboard
 //!
-//! This interface is a prime candidate to be reworked into something far less
-//! intrusive, like a callback mechanism.
+//! Must be called from the thread that initialized SDL.
 //!
 //! \param[in,out] input Input state to be updated
 void
-InputProcess(struct input *input);
+InputUpdate(struct input *input);
+
+//! \brief Whether quit has been pressed in any update so far
+//!
+//! \param[in] input Input state to query
+//! \return 1 if quit has been pressed, otherwise zero
+int
+InputQuitRequested(struct input *input);
+
+//! \brief When the latest sample was taken
+//!
+//! \param[in] input Input state to query
+//! \return value of SDL_GetPerformanceCounter() at the last InputUpdate(), or 0 before the first
+Uint64
+InputSampleTime(struct input *input);
 
 #endif // INPUT_VERSION
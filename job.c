@@ -0,0 +1,407 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: job.c
+  Created: 2026-10-18
+  Updated: 2026-10-18
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file job.c
+
+#include <stdlib.h> // malloc, free
+#include <string.h> // memset, memcpy
+#include <stdio.h> // fprintf
+#include <stdatomic.h> // atomic_*
+#include <pthread.h> // pthread_*
+#include <sched.h> // sched_yield
+#include <unistd.h> // sysconf
+
+#include "job.h"
+
+//! \brief A unit of work
+struct job {
+        void (*function)(void *data);
+        struct job *parent;
+        atomic_int unfinished; //!< 1 until function returns, plus one per unfinished child
+        atomic_int pending; //!< 1 until JobRun(), plus one per unfinished dependency
+        atomic_int continuationCount;
+        struct job *continuations[JOB_MAX_CONTINUATIONS]; //!< jobs depending on this one
+        _Alignas(16) unsigned char data[JOB_DATA_SIZE];
+};
+
+//! \brief Lock-free work stealing deque
+//!
+//! The owning thread pushes and takes at bottom; other threads steal at top.
+//! Chase and Lev's algorithm, with the C11 orderings from Lê et al., "Correct
+//! and Efficient Work-Stealing for Weak Memory Models".
+struct job_deque {
+        _Atomic(struct job *) jobs[JOB_DEQUE_SIZE];
+        _Alignas(64) atomic_long top;
+        _Alignas(64) atomic_long bottom;
+};
+
+//! \brief Per-thread state
+struct job_worker {
+        struct job_deque deque;
+        struct job *pool; //!< JOB_POOL_SIZE jobs handed out in a ring
+        unsigned int next; //!< next pool slot to hand out
+        unsigned int random; //!< xorshift state for picking steal victims
+        pthread_t thread;
+        struct job_system *jobs;
+        int index;
+};
+
+//! \brief Job system state
+struct job_system {
+        struct job_worker *workers;
+        int threadCount;
+
+        atomic_int running;
+        atomic_int queued; //!< jobs sitting in some deque
+        atomic_int sleeping; //!< workers waiting on wake
+        pthread_mutex_t mutex;
+        pthread_cond_t wake;
+};
+
+//! Index of the calling thread in its job system. Threads that aren't workers
+//! are treated as the creating thread.
+static _Thread_local int threadIndex = 0;
+
+//! \brief Push a job onto the bottom of the owner's deque
+//!
+//! \param[in,out] deque the calling thread's deque
+//! \param[in] job the job to push
+//! \return 1 on success, 0 if the deque is full
+int JobDequePush(struct job_deque *deque, struct job *job) {
+        long b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+        long t = atomic_load_explicit(&deque->top, memory_order_acquire);
+        if (b - t >= JOB_DEQUE_SIZE) {
+                return 0;
+        }
+        atomic_store_explicit(&deque->jobs[b & (JOB_DEQUE_SIZE - 1)], job, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+        return 1;
+}
+
+//! \brief Take the most recently pushed job from the owner's deque
+//!
+//! \param[in,out] deque the calling thread's deque
+//! \return a job, or NULL if the deque is empty
+struct job *JobDequeTake(struct job_deque *deque) {
+        long b = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+        atomic_store_explicit(&deque->bottom, b, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        long t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+        struct job *job = NULL;
+        if (t <= b) {
+                job = atomic_load_explicit(&deque->jobs[b & (JOB_DEQUE_SIZE - 1)], memory_order_relaxed);
+                if (t == b) {
+                        // Last job: race any thieves for it.
+                        if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+                                job = NULL;
+                        }
+                        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+                }
+        } else {
+                atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+        }
+        return job;
+}
+
+//! \brief Steal the oldest job from another thread's deque
+//!
+//! \param[in,out] deque the deque to steal from
+//! \return a job, or NULL if the deque is empty or another thread won the race
+struct job *JobDequeSteal(struct job_deque *deque) {
+        long t = atomic_load_explicit(&deque->top, memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        long b = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+        if (t < b) {
+                struct job *job = atomic_load_explicit(&deque->jobs[t & (JOB_DEQUE_SIZE - 1)], memory_order_relaxed);
+                if (atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+                        return job;
+                }
+        }
+        return NULL;
+}
+
+//! \brief Find a job for a thread to run
+//!
+//! Tries the thread's own deque first, then one other thread's.
+//!
+//! \param[in,out] jobs the job system
+//! \param[in,out] worker the calling thread's state
+//! \return a job, or NULL if none was found
+struct job *JobFind(struct job_system *jobs, struct job_worker *worker) {
+        struct job *job = JobDequeTake(&worker->deque);
+        if (NULL == job && jobs->threadCount > 1) {
+                worker->random ^= worker->random << 13;
+                worker->random ^= worker->random >> 17;
+                worker->random ^= worker->random << 5;
+                int victim = worker->random % (jobs->threadCount - 1);
+                if (victim >= worker->index) {
+                        victim++;
+                }
+                job = JobDequeSteal(&jobs->workers[victim].deque);
+        }
+        if (NULL != job) {
+                atomic_fetch_sub(&jobs->queued, 1);
+        }
+        return job;
+}
+
+//! \brief Queue a job whose dependencies have all finished
+//!
+//! \param[in,out] jobs the job system
+//! \param[in,out] job the job to queue
+void JobSchedule(struct job_system *jobs, struct job *job);
+
+//! \brief Mark one unit of a job's work done
+//!
+//! When the job and all of its children are done, its dependents are released
+//! and its parent is notified in turn.
+//!
+//! \param[in,out] jobs the job system
+//! \param[in,out] job the job to update
+void JobFinish(struct job_system *jobs, struct job *job) {
+        if (1 != atomic_fetch_sub(&job->unfinished, 1)) {
+                return;
+        }
+
+        int count = atomic_load(&job->continuationCount);
+        for (int i = 0; i < count; i++) {
+                struct job *continuation = job->continuations[i];
+                if (1 == atomic_fetch_sub(&continuation->pending, 1)) {
+                        JobSchedule(jobs, continuation);
+                }
+        }
+
+        if (NULL != job->parent) {
+                JobFinish(jobs, job->parent);
+        }
+}
+
+//! \brief Run a job's function and finish it
+//!
+//! \param[in,out] jobs the job system
+//! \param[in,out] job the job to execute
+void JobExecute(struct job_system *jobs, struct job *job) {
+        if (NULL != job->function) {
+                job->function(job->data);
+        }
+        JobFinish(jobs, job);
+}
+
+void JobSchedule(struct job_system *jobs, struct job *job) {
+        struct job_worker *worker = &jobs->workers[threadIndex];
+        if (!JobDequePush(&worker->deque, job)) {
+                JobExecute(jobs, job);
+                return;
+        }
+
+        atomic_fetch_add(&jobs->queued, 1);
+        if (atomic_load(&jobs->sleeping) > 0) {
+                pthread_mutex_lock(&jobs->mutex);
+                pthread_cond_signal(&jobs->wake);
+                pthread_mutex_unlock(&jobs->mutex);
+        }
+}
+
+//! \brief Worker thread entry point
+//!
+//! Runs jobs until the job system shuts down, sleeping while there are none.
+//!
+//! \param[in,out] arg the worker's struct job_worker
+//! \return NULL
+void *JobWorkerMain(void *arg) {
+        struct job_worker *worker = (struct job_worker *)arg;
+        struct job_system *jobs = worker->jobs;
+        threadIndex = worker->index;
+
+        while (atomic_load(&jobs->running)) {
+                struct job *job = JobFind(jobs, worker);
+                if (NULL != job) {
+                        JobExecute(jobs, job);
+                        continue;
+                }
+
+                pthread_mutex_lock(&jobs->mutex);
+                atomic_fetch_add(&jobs->sleeping, 1);
+                while (0 == atomic_load(&jobs->queued) && atomic_load(&jobs->running)) {
+                        pthread_cond_wait(&jobs->wake, &jobs->mutex);
+                }
+                atomic_fetch_sub(&jobs->sleeping, 1);
+                pthread_mutex_unlock(&jobs->mutex);
+        }
+
+        return NULL;
+}
+
+struct job_system *JobSystemInit(int threadCount) {
+        if (threadCount <= 0) {
+                threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+                if (threadCount <= 0) {
+                        threadCount = 1;
+                }
+        }
+
+        struct job_system *jobs = (struct job_system *)malloc(sizeof(struct job_system));
+        memset(jobs, 0, sizeof(struct job_system));
+
+        jobs->threadCount = threadCount;
+        atomic_init(&jobs->running, 1);
+        atomic_init(&jobs->queued, 0);
+        atomic_init(&jobs->sleeping, 0);
+        pthread_mutex_init(&jobs->mutex, NULL);
+        pthread_cond_init(&jobs->wake, NULL);
+
+        jobs->workers = (struct job_worker *)aligned_alloc(64, sizeof(struct job_worker) * threadCount);
+        memset(jobs->workers, 0, sizeof(struct job_worker) * threadCount);
+        for (int i = 0; i < threadCount; i++) {
+                struct job_worker *worker = &jobs->workers[i];
+                worker->pool = (struct job *)aligned_alloc(64, sizeof(struct job) * JOB_POOL_SIZE);
+                worker->random = 2463534242u + i;
+                worker->jobs = jobs;
+                worker->index = i;
+        }
+
+        threadIndex = 0;
+        for (int i = 1; i < threadCount; i++) {
+                if (0 != pthread_create(&jobs->workers[i].thread, NULL, JobWorkerMain, &jobs->workers[i])) {
+                        fprintf(stderr, "Couldn't start job worker %d\n", i);
+                        jobs->threadCount = i;
+                        JobSystemDeinit(jobs);
+                        return NULL;
+                }
+        }
+
+        return jobs;
+}
+
+void JobSystemDeinit(struct job_system *jobs) {
+        if (NULL == jobs) {
+                return;
+        }
+
+        pthread_mutex_lock(&jobs->mutex);
+        atomic_store(&jobs->running, 0);
+        pthread_cond_broadcast(&jobs->wake);
+        pthread_mutex_unlock(&jobs->mutex);
+
+        for (int i = 1; i < jobs->threadCount; i++) {
+                pthread_join(jobs->workers[i].thread, NULL);
+        }
+        for (int i = 0; i < jobs->threadCount; i++) {
+                free(jobs->workers[i].pool);
+        }
+
+        pthread_cond_destroy(&jobs->wake);
+        pthread_mutex_destroy(&jobs->mutex);
+        free(jobs->workers);
+        free(jobs);
+}
+
+int JobSystemThreadCount(struct job_system *jobs) {
+        return jobs->threadCount;
+}
+
+int JobThreadIndex(struct job_system *jobs) {
+        return threadIndex;
+}
+
+struct job *JobCreate(struct job_system *jobs, void (*function)(void *data), void *data, int size, struct job *parent) {
+        struct job_worker *worker = &jobs->workers[threadIndex];
+        struct job *job = &worker->pool[worker->next++ & (JOB_POOL_SIZE - 1)];
+
+        job->function = function;
+        job->parent = parent;
+        atomic_init(&job->unfinished, 1);
+        atomic_init(&job->pending, 1);
+        atomic_init(&job->continuationCount, 0);
+        if (NULL != data && size > 0) {
+                memcpy(job->data, data, size);
+        }
+
+        if (NULL != parent) {
+                atomic_fetch_add(&parent->unfinished, 1);
+        }
+
+        return job;
+}
+
+void JobDependsOn(struct job *job, struct job *dependency) {
+        int slot = atomic_fetch_add(&dependency->continuationCount, 1);
+        if (slot >= JOB_MAX_CONTINUATIONS) {
+                fprintf(stderr, "Too many jobs depend on one job\n");
+                abort();
+        }
+        dependency->continuations[slot] = job;
+        atomic_fetch_add(&job->pending, 1);
+}
+
+void JobRun(struct job_system *jobs, struct job *job) {
+        if (1 == atomic_fetch_sub(&job->pending, 1)) {
+                JobSchedule(jobs, job);
+        }
+}
+
+void JobWait(struct job_system *jobs, struct job *job) {
+        struct job_worker *worker = &jobs->workers[threadIndex];
+        while (atomic_load(&job->unfinished) > 0) {
+                struct job *next = JobFind(jobs, worker);
+                if (NULL != next) {
+                        JobExecute(jobs, next);
+                } else {
+                        sched_yield();
+                }
+        }
+}
+
+//! \brief Payload of a JobParallelFor() chunk
+struct job_range {
+        void (*function)(void *data, int first, int count);
+        void *data;
+        int first;
+        int count;
+};
+
+//! \brief Job function running one JobParallelFor() chunk
+//!
+//! \param[in] data the chunk's struct job_range
+void JobRangeMain(void *data) {
+        struct job_range *range = (struct job_range *)data;
+        range->function(range->data, range->first, range->count);
+}
+
+void JobParallelFor(struct job_system *jobs, void (*function)(void *data, int first, int count), void *data, int count, int chunkSize) {
+        if (count <= 0) {
+                return;
+        }
+        if (chunkSize < 1) {
+                chunkSize = 1;
+        }
+        int maxChunks = JOB_POOL_SIZE / 2;
+        if ((count + chunkSize - 1) / chunkSize > maxChunks) {
+                chunkSize = (count + maxChunks - 1) / maxChunks;
+        }
+
+        struct job *root = JobCreate(jobs, NULL, NULL, 0, NULL);
+        for (int first = 0; first < count; first += chunkSize) {
+                struct job_range range = { function, data, first, count - first < chunkSize ? count - first : chunkSize };
+                struct job *job = JobCreate(jobs, JobRangeMain, &range, sizeof(range), root);
+                JobRun(jobs, job);
+        }
+        JobRun(jobs, root);
+        JobWait(jobs, root);
+}
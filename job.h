@@ -0,0 +1,133 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: job.h
+  Created: 2026-10-18
+  Updated: 2026-10-18
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file job.h
+//! A work stealing job system on top of pthreads.
+//!
+//! Every thread, including the one that created the job system, owns a deque
+//! of runnable jobs. A thread pushes and pops jobs at one end of its own deque
+//! without locking; idle threads steal from the other end of someone else's.
+//!
+//! Jobs are allocated from a ring owned by the creating thread, so creating a
+//! job never calls malloc. A ring slot is reused after JOB_POOL_SIZE more jobs
+//! have been created on the same thread; no thread may have more jobs than
+//! that outstanding.
+//!
+//! A job finishes once its function has returned and every child created with
+//! it as parent has finished. A job may also depend on other jobs, in which
+//! case it isn't started until they have all finished.
+//!
+//! Only the thread that created the job system and the job system's own
+//! workers may create, run or wait on jobs.
+
+#ifndef JOB_VERSION
+#define JOB_VERSION "0.1.0" //!< include guard
+
+//! Number of jobs each thread can have outstanding.
+#define JOB_POOL_SIZE 4096
+
+//! Capacity of each thread's deque. Jobs run when a deque is full are
+//! executed immediately instead.
+#define JOB_DEQUE_SIZE 4096
+
+//! Bytes of user data copied into each job.
+#define JOB_DATA_SIZE 64
+
+//! Maximum number of jobs that may depend on a single job.
+#define JOB_MAX_CONTINUATIONS 8
+
+struct job;
+struct job_system;
+
+//! \brief Initialize a new job system and start its worker threads
+//!
+//! \param[in] threadCount total number of threads, including the calling thread; 0 or less for one per online CPU
+//! \return the initialized job system, or NULL on failure
+struct job_system *
+JobSystemInit(int threadCount);
+
+//! \brief Stop the worker threads and de-initialize the job system
+//!
+//! Every job must have finished.
+//!
+//! \param[in,out] jobs the job system to be de-initialized
+void
+JobSystemDeinit(struct job_system *jobs);
+
+//! \brief Number of threads running jobs, including the creating thread
+//!
+//! \param[in] jobs the job system to query
+//! \return the thread count
+int
+JobSystemThreadCount(struct job_system *jobs);
+
+//! \brief Index of the calling thread within the job system
+//!
+//! Useful for indexing per-thread scratch space from inside a job.
+//!
+//! \param[in] jobs the job system to query
+//! \return 0 for the thread that created the job system, otherwise 1 to JobSystemThreadCount() - 1
+int
+JobThreadIndex(struct job_system *jobs);
+
+//! \brief Create a new job without starting it
+//!
+//! \param[in,out] jobs the job system to allocate from
+//! \param[in] function called with a pointer to the job's copy of data; may be NULL
+//! \param[in] data bytes passed to function, copied into the job; may be NULL
+//! \param[in] size number of bytes of data, at most JOB_DATA_SIZE
+//! \param[in,out] parent a job that won't finish until this one has, or NULL
+//! \return the new job
+struct job *
+JobCreate(struct job_system *jobs, void (*function)(void *data), void *data, int size, struct job *parent);
+
+//! \brief Prevent a job from starting until another has finished
+//!
+//! Must be called before either job is run.
+//!
+//! \param[in,out] job the job to hold back
+//! \param[in,out] dependency the job that must finish first
+void
+JobDependsOn(struct job *job, struct job *dependency);
+
+//! \brief Allow a job to run once all of its dependencies have finished
+//!
+//! \param[in,out] jobs the job system the job was created with
+//! \param[in,out] job the job to run
+void
+JobRun(struct job_system *jobs, struct job *job);
+
+//! \brief Run other jobs until the given job has finished
+//!
+//! \param[in,out] jobs the job system the job was created with
+//! \param[in] job the job to wait on
+void
+JobWait(struct job_system *jobs, struct job *job);
+
+//! \brief Call function over [0, count) split into chunks, in parallel, and wait
+//!
+//! Chunks may run on any thread and in any order. chunkSize is raised if
+//! needed to keep the number of chunks within JOB_POOL_SIZE.
+//!
+//! \param[in,out] jobs the job system to run on
+//! \param[in] function called once per chunk with data and the chunk's first index and length
+//! \param[in] data passed to every call of function
+//! \param[in] count number of indices to cover
+//! \param[in] chunkSize maximum number of indices per call
+void
+JobParallelFor(struct job_system *jobs, void (*function)(void *data, int first, int count), void *data, int count, int chunkSize);
+
+#endif // JOB_VERSION
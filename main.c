@@ -2,7 +2,7 @@
   GrooveStomp's 3D Software Renderer
   Copyright (c) 2019 Aaron Oman (GrooveStomp)
 
-  File: triangle_list.h
+  File: main.c
   Created: 2019-08-07
   Updated: 2019-08-27
   Author: Aaron Oman
@@ -23,9 +23,15 @@
 #include "graphics.h"
 #include "input.h"
 #include "math.h"
+#include "mesh.h"
+#include "scene.h"
+#include "job.h"
+#include "simd.h"
 #include "color.h"
-#include "triangle_list.h"
 #include "texture.h"
+#include "obj.h"
+#include "terrain.h"
+#include "heightmap.h"
 
 #pragma GCC diagnostic ignored "-Wmissing-braces"
 
@@ -37,53 +43,224 @@
 #define SCREEN_WIDTH 512
 #define SCREEN_HEIGHT 512
 
+#define STATS_INTERVAL 60 //!< Print frame stats every this many frames
+#define RECORD_PARTITIONS 4 //!< Command buffers the scene's draws are recorded into in parallel
+#define TERRAIN_BUDGET (1 << 20) //!< Bytes of full terrain chunks kept resident
+#define HEIGHTMAP_SPACING 1.0f //!< World units between heightmap samples
+#define HEIGHTMAP_SCALE 48.0f //!< World height of a white heightmap sample
+
 const double msPerFrame = HZ_TO_MS(60);
 
-// Externally exposed vars
+// Camera state, moved by MoveCamera()
 struct vec3 camera;
 struct vec3 lookDir;
 struct vec3 up;
 float yaw;
-double elapsedTime;
+int cameraMoved;
 
-//! \brief Compare the Z-Sorting order of two triangles
+struct graphics *graphics;
+struct input *input;
+struct texture_cache *textures;
+struct mesh **meshes;
+int meshCount;
+struct scene *scene;
+struct job_system *jobs;
+struct graphics_command_buffer *recorders[RECORD_PARTITIONS];
+struct terrain *terrain;
+struct graphics_command_buffer *terrainRecorder;
+struct heightmap *heightmap;
+
+//! \brief One of the meshes made from the obj file, with the material it's drawn with
+struct part {
+        struct mesh *mesh;
+        struct material material;
+        int *lods; //!< level of detail each instance was last drawn at
+};
+
+struct part *parts;
+
+//! \brief A contiguous run of instances recorded into one command buffer
 //!
-//! \param left pointer to a triangle
-//! \param right pointer to a triangle
-//! \return 0 if their sort values are the same, -1 if left comes first, otherwise 1
-int TriangleCompareFn(const void *left, const void *right) {
-        const struct triangle *l = (const struct triangle *)left;
-        const struct triangle *r = (const struct triangle *)right;
-
-        float zl = (l->v[0].z + l->v[1].z + l->v[2].z / 3.0f);
-        float zr = (r->v[0].z + r->v[1].z + r->v[2].z / 3.0f);
-
-        if (zl == zr) {
-                return 0;
-        } else if (zl > zr) {
-                return -1;
-        } else {
-                return 1;
+//! Every part is recorded for each instance in the run.
+struct record_job {
+        struct graphics_command_buffer *buffer;
+        struct mat4x4 *transforms;
+        int first; //!< index of the run's first instance
+        int count;
+};
+
+//! \brief Record a range of record_jobs, each into its own buffer
+//!
+//! Job function for JobParallelFor().
+//!
+//! \param[in,out] data array of struct record_job
+//! \param[in] first first job to record
+//! \param[in] count number of jobs to record
+void RecordJobs(void *data, int first, int count) {
+        struct record_job *records = (struct record_job *)data;
+        for (int i = first; i < first + count; i++) {
+                struct record_job *job = &records[i];
+                GraphicsCommandBufferReset(job->buffer);
+                for (int p = 0; p < meshCount; p++) {
+                        GraphicsRecordDrawMeshInstanced(job->buffer, parts[p].mesh, job->transforms, &parts[p].lods[job->first], job->count, parts[p].material);
+                }
         }
 }
 
-struct graphics *graphics;
-struct input *input;
-struct texture *texture;
-struct mesh *mesh;
+//! \brief Look up the material a mesh was made with
+//!
+//! Materials with a diffuse texture map are drawn with that texture, loaded
+//! through the texture cache; the rest are filled with their diffuse color.
+//! Meshes without a material, or whose material can't be found, are drawn
+//! with the debug texture.
+//!
+//! \param[in] mesh the mesh to look up
+//! \param[in] library materials read from the mesh's material library
+//! \param[in] libraryCount number of materials in library
+//! \return the material to draw the mesh with
+struct material PartMaterial(struct mesh *mesh, struct obj_material *library, int libraryCount) {
+        struct material material = { TextureCacheGet(textures, "debug_texture.png"), ColorWhite.rgba };
+        if (NULL == mesh->material) {
+                return material;
+        }
+
+        for (int i = 0; i < libraryCount; i++) {
+                if (0 != strcmp(library[i].name, mesh->material)) {
+                        continue;
+                }
+
+                if (NULL != library[i].texture) {
+                        material.texture = TextureCacheGet(textures, library[i].texture);
+                }
+                if (NULL == library[i].texture || NULL == material.texture) {
+                        material.texture = NULL;
+                        material.color = ColorInitFloat(library[i].diffuse.x, library[i].diffuse.y, library[i].diffuse.z, 1.0f).rgba;
+                }
+                return material;
+        }
+
+        fprintf(stderr, "Couldn't find material %s\n", mesh->material);
+        return material;
+}
+
+//! \brief Move the camera according to the keys held down
+//!
+//! Input callback.
+//!
+//! \param[in] data unused
+//! \param[in] keys INPUT_KEY_* bits of every key held down
+//! \param[in] seconds time since the previous sample
+void MoveCamera(void *data, unsigned int keys, double seconds) {
+        float t = (float)seconds;
+
+        up = (struct vec3){ 0, 1, 0, 1 };
+        lookDir = Mat4x4MultiplyVec3(Mat4x4RotateY(yaw), (struct vec3){ 0, 0, 1, 1 });
+        struct vec3 forward = Vec3Multiply(lookDir, 8.0f * t);
+        struct vec3 right = Vec3CrossProduct(up, lookDir);
+        right = Vec3Multiply(Vec3Normalize(right), 8.0f * t);
+
+        if (keys & INPUT_KEY_LEFT) {
+                yaw += 2.0f * t;
+        }
+
+        if (keys & INPUT_KEY_RIGHT) {
+                yaw -= 2.0f * t;
+        }
+
+        if (keys & INPUT_KEY_UP) {
+                camera.y += 8.0f * t;
+        }
+
+        if (keys & INPUT_KEY_DOWN) {
+                camera.y -= 8.0f * t;
+        }
+
+        if (keys & INPUT_KEY_FORWARD) {
+                camera = Vec3Add(camera, forward);
+        }
+
+        if (keys & INPUT_KEY_BACK) {
+                camera = Vec3Subtract(camera, forward);
+        }
+
+        if (keys & INPUT_KEY_STRAFE_LEFT) {
+                camera = Vec3Subtract(camera, right);
+        }
+
+        if (keys & INPUT_KEY_STRAFE_RIGHT) {
+                camera = Vec3Add(camera, right);
+        }
+
+        cameraMoved |= 0 != keys;
+        lookDir = Mat4x4MultiplyVec3(Mat4x4RotateY(yaw), (struct vec3){ 0, 0, 1, 1 });
+}
+
+//! \brief Sample input and point the view through the camera
+//!
+//! View latch called by GraphicsEndFrame() just before the geometry stage,
+//! so the frame shows the camera as of then rather than as of the start of
+//! the frame.
+//!
+//! \param[in] data pointer to the index of the camera's scene node
+//! \param[in,out] view the view of the frame being ended
+void LatchView(void *data, struct graphics_view *view) {
+        int cameraNode = *(int *)data;
+
+        InputUpdate(input);
+        if (cameraMoved) {
+                struct vec3 target = Vec3Add(camera, lookDir);
+                SceneSetLocal(scene, cameraNode, Mat4x4PointAt(camera, target, up));
+                SceneUpdate(scene);
+                cameraMoved = 0;
+        }
+
+        view->matView = Mat4x4InvertFast(scene->world[cameraNode]);
+        view->camera = camera;
+        view->inputTime = InputSampleTime(input);
+}
 
 void Shutdown(int code) {
-        if (NULL != texture)
-                TextureDeinit(texture);
+        for (int i = 0; i < RECORD_PARTITIONS; i++) {
+                GraphicsCommandBufferDeinit(recorders[i]);
+        }
+        GraphicsCommandBufferDeinit(terrainRecorder);
+
+        // Graphics goes first: frames still in flight may be drawing with
+        // the textures.
+        if (NULL != graphics)
+                GraphicsDeinit(graphics);
+
+        if (NULL != terrain)
+                TerrainDeinit(terrain);
+
+        if (NULL != heightmap)
+                HeightmapDeinit(heightmap);
+
+        if (NULL != textures)
+                TextureCacheDeinit(textures);
 
-        if (NULL != mesh)
-                MeshDeinit(mesh);
+        if (NULL != scene)
+                SceneDeinit(scene);
+
+        if (NULL != parts) {
+                for (int i = 0; i < meshCount; i++) {
+                        free(parts[i].lods);
+                }
+                free(parts);
+        }
+
+        if (NULL != meshes) {
+                for (int i = 0; i < meshCount; i++) {
+                        MeshDeinit(meshes[i]);
+                }
+                free(meshes);
+        }
 
         if (NULL != input)
                 InputDeinit(input);
 
-        if (NULL != graphics)
-                GraphicsDeinit(graphics);
+        if (NULL != jobs)
+                JobSystemDeinit(jobs);
 
         exit(code);
 }
@@ -98,34 +275,174 @@ int main(int argc, char **argv) {
                 Shutdown(1);
         }
 
-        input = InputInit();
+        input = InputInit(MoveCamera, NULL);
         if (NULL == input) {
                 fprintf(stderr, "Couldn't initialize input");
                 Shutdown(1);
         }
 
-        texture = TextureInitFromFile("debug_texture.png");
-        if (NULL == texture) {
+        textures = TextureCacheInit();
+        if (NULL == TextureCacheGet(textures, "debug_texture.png")) {
                 fprintf(stderr, "Couldn't initialize texture");
                 Shutdown(1);
         }
 
-        struct mesh *mesh = MeshInitFromObj("cube-textured.obj");
-        if (NULL == mesh) {
-                fprintf(stderr, "There was a problem initializing the mesh");
+        char *objFile = "cube-textured.obj";
+        if (argc > 1) {
+                objFile = argv[1];
+        }
+
+        int instanceCount = 1;
+        if (argc > 2) {
+                instanceCount = atoi(argv[2]);
+                if (instanceCount < 1) {
+                        fprintf(stderr, "Instance count must be at least 1");
+                        Shutdown(1);
+                }
+        }
+
+        int threadCount = 0;
+        if (argc > 3) {
+                threadCount = atoi(argv[3]);
+        }
+
+        jobs = JobSystemInit(threadCount);
+        if (NULL == jobs) {
+                fprintf(stderr, "Couldn't initialize the job system");
+                Shutdown(1);
+        }
+        GraphicsSetJobSystem(graphics, jobs);
+
+        int latency = 1;
+        if (argc > 4) {
+                latency = atoi(argv[4]);
+        }
+        GraphicsSetLatency(graphics, latency);
+
+        int meshFlags = MESH_LOAD_MESHLETS | MESH_LOAD_LODS | MESH_LOAD_CACHE;
+        if (argc > 5 && 0 != atoi(argv[5])) {
+                meshFlags |= MESH_LOAD_QUANTIZE;
+        }
+
+        // A .terrain file is streamed in chunks from the obj file of the
+        // same name instead of being drawn as instances.
+        size_t nameLength = strlen(objFile);
+        if (nameLength > 8 && 0 == strcmp(objFile + nameLength - 8, ".terrain")) {
+                terrain = TerrainInit(objFile, MESH_LOAD_MESHLETS | MESH_LOAD_LODS, TERRAIN_BUDGET, jobs);
+                if (NULL == terrain) {
+                        fprintf(stderr, "There was a problem initializing the terrain");
+                        Shutdown(1);
+                }
+                int chunkCount = terrain->chunksX * terrain->chunksZ;
+                terrainRecorder = GraphicsCommandBufferInit(chunkCount, chunkCount);
+                instanceCount = 0;
+        } else if (nameLength > 4 && 0 == strcmp(objFile + nameLength - 4, ".png")) {
+                // A .png file is a heightmap, drawn by geomipmapping.
+                heightmap = HeightmapInit(objFile, HEIGHTMAP_SPACING, HEIGHTMAP_SCALE);
+                if (NULL == heightmap) {
+                        fprintf(stderr, "There was a problem initializing the heightmap");
+                        Shutdown(1);
+                }
+                int patchCount = heightmap->patchesX * heightmap->patchesZ;
+                terrainRecorder = GraphicsCommandBufferInit(patchCount, patchCount);
+                instanceCount = 0;
+        } else {
+                meshes = MeshInitFromObj(objFile, meshFlags, jobs, &meshCount);
+                if (NULL == meshes) {
+                        fprintf(stderr, "There was a problem initializing the mesh");
+                        Shutdown(1);
+                }
+        }
+
+        // Every mesh made from the obj file shares its material library.
+        float radius = 0.0f;
+        if (NULL != meshes) {
+                int libraryCount = 0;
+                struct obj_material *library = NULL;
+                if (NULL != meshes[0]->materialLibrary) {
+                        library = ObjMaterialsInit(meshes[0]->materialLibrary, &libraryCount);
+                }
+
+                parts = (struct part *)calloc(meshCount, sizeof(struct part));
+                for (int i = 0; i < meshCount; i++) {
+                        MeshDebug(meshes[i], NULL != meshes[i]->material ? meshes[i]->material : objFile);
+                        parts[i].mesh = meshes[i];
+                        parts[i].material = PartMaterial(meshes[i], library, libraryCount);
+                        parts[i].lods = calloc(instanceCount, sizeof(int));
+                        if (meshes[i]->sphere.radius > radius) {
+                                radius = meshes[i]->sphere.radius;
+                        }
+                }
+                ObjMaterialsDeinit(library, libraryCount);
         }
 
         camera = (struct vec3){ 0 };
+        up = (struct vec3){ 0, 1, 0, 1 };
+        lookDir = (struct vec3){ 0, 0, 1, 1 };
         yaw = 0;
-        elapsedTime = 0;
+        cameraMoved = 1;
+        if (NULL != terrain) {
+                // Start at the near edge of the terrain, above its highest point.
+                camera.x = (terrain->bounds.min.x + terrain->bounds.max.x) * 0.5f;
+                camera.y = terrain->bounds.max.y;
+                camera.z = terrain->bounds.min.z;
+        }
+        if (NULL != heightmap) {
+                camera.y = heightmap->scale;
+                camera.z = heightmap->origin.z;
+        }
 
         struct mat4x4 matProj = Mat4x4Project(90.0f, (float)SCREEN_HEIGHT / (float)SCREEN_WIDTH, 0.1f, 1000.0f);
 
-        struct triangle *renderTris = malloc(sizeof(struct triangle) * mesh->count * 2);
-        int renderTrisCount = 0;
+        // The camera is a node of its own. A single instance sits in front
+        // of it; more are laid out on a square grid receding from it. Each
+        // instance is a static placement node with a spinning model node
+        // beneath it. The model nodes are added last so their world matrices
+        // form one contiguous array of transforms.
+        scene = SceneInit(1 + instanceCount * 2);
+        int cameraNode = SceneAddNode(scene, SCENE_ROOT, Mat4x4Identity());
+        int firstPlacement = scene->count;
+        if (1 == instanceCount) {
+                SceneAddNode(scene, SCENE_ROOT, Mat4x4Translate(-0.5f, -0.5f, 3.0f));
+        } else {
+                int side = (int)ceilf(sqrtf((float)instanceCount));
+                float spacing = radius * 2.5f;
+                for (int n = 0; n < instanceCount; n++) {
+                        float x = ((float)(n % side) - (float)(side - 1) * 0.5f) * spacing;
+                        float z = (float)(n / side + 1) * spacing;
+                        SceneAddNode(scene, SCENE_ROOT, Mat4x4Translate(x, -spacing * 0.5f, z));
+                }
+        }
+        int firstModel = scene->count;
+        for (int n = 0; n < instanceCount; n++) {
+                SceneAddNode(scene, firstPlacement + n, Mat4x4Identity());
+        }
+
+        // Instances are split into contiguous runs, each recorded into its
+        // own command buffer by whichever thread picks it up. The buffers
+        // are submitted in run order so the frame is the same no matter
+        // which thread finishes first.
+        int partitions = instanceCount < RECORD_PARTITIONS ? instanceCount : RECORD_PARTITIONS;
+        // Terrain has no texture coordinates worth sampling; it is shaded
+        // by lighting alone.
+        struct material terrainMaterial = { NULL, ColorWhite.rgba };
+        struct record_job records[RECORD_PARTITIONS];
+        for (int i = 0; i < partitions; i++) {
+                int first = instanceCount * i / partitions;
+                int last = instanceCount * (i + 1) / partitions;
+                recorders[i] = GraphicsCommandBufferInit(meshCount, meshCount * (last - first));
+                records[i] = (struct record_job){ recorders[i], &scene->world[firstModel + first], first, last - first };
+        }
+
+        // The camera and view matrix are filled in by LatchView().
+        struct graphics_view view = { 0 };
+        view.matProj = matProj;
+        view.lightDirection = Vec3Normalize((struct vec3){ 0.0f, 1.0f, -1.0f });
+        view.clearColor = ColorBlack.rgba;
+        GraphicsSetViewLatch(graphics, LatchView, &cameraNode);
 
         double count = 0.0;
-        SDL_Event event;
+        unsigned int frame = 0;
         int running = 1;
 
         while (running) {
@@ -138,199 +455,67 @@ int main(int argc, char **argv) {
                 struct mat4x4 matRotZ = Mat4x4RotateZ(theta);
                 struct mat4x4 matRotX = Mat4x4RotateX(theta * 0.5f);
                 struct mat4x4 matRotY = Mat4x4Identity();
-                struct mat4x4 matTrans = Mat4x4Translate(-0.5f, -0.5f, 3.0f);
-
-                struct mat4x4 matWorld = Mat4x4Identity();
-                matWorld = Mat4x4Multiply(matRotZ, matRotX);
-                matWorld = Mat4x4Multiply(matWorld, matRotY);
-                matWorld = Mat4x4Multiply(matWorld, matTrans);
-
-                up = (struct vec3){ 0, 1, 0, 1 };
-                struct vec3 target = { 0, 0, 1, 1 };
-                struct mat4x4 matCameraRot = Mat4x4RotateY(yaw);
-                lookDir = Mat4x4MultiplyVec3(matCameraRot, target);
-                target = Vec3Add(camera, lookDir);
-
-                struct mat4x4 matCamera = Mat4x4PointAt(camera, target, up);
-                struct mat4x4 matView = Mat4x4InvertFast(matCamera);
-
-                GraphicsBegin(graphics);
-                GraphicsClearScreen(graphics, ColorBlack.rgba);
-
-                renderTrisCount = 0;
-                for (int i = 0; i < mesh->count; i++) {
-                        // World matrix transform.
-                        struct triangle transformed = mesh->tris[i];
-                        transformed.v[0] = Mat4x4MultiplyVec3(matWorld, transformed.v[0]);
-                        transformed.v[1] = Mat4x4MultiplyVec3(matWorld, transformed.v[1]);
-                        transformed.v[2] = Mat4x4MultiplyVec3(matWorld, transformed.v[2]);
-
-                        // Calculate the normal.
-                        struct vec3 line1 = Vec3Subtract(transformed.v[1], transformed.v[0]);
-                        struct vec3 line2 = Vec3Subtract(transformed.v[2], transformed.v[0]);
-                        struct vec3 normal = Vec3CrossProduct(line1, line2);
-                        normal = Vec3Normalize(normal);
-
-                        if (Vec3DotProduct(normal, Vec3Subtract(transformed.v[0], camera)) < 0.0f) {
-                                // Illumination
-                                struct vec3 lightDirection = { 0.0f, 1.0f, -1.0f };
-                                lightDirection = Vec3Normalize(lightDirection);
-
-                                // How similar is normal to light direction?
-                                float dp = fmax(0.1f, Vec3DotProduct(normal, lightDirection));
-                                transformed.color = ColorInitFloat(dp, dp, dp, 1.0).rgba;
-
-                                // Convert from world space to view space.
-                                struct triangle viewed = transformed;
-                                viewed.v[0] = Mat4x4MultiplyVec3(matView, transformed.v[0]);
-                                viewed.v[1] = Mat4x4MultiplyVec3(matView, transformed.v[1]);
-                                viewed.v[2] = Mat4x4MultiplyVec3(matView, transformed.v[2]);
-
-                                struct triangle clipped[2];
-                                int numClippedTriangles = TriangleClipAgainstPlane(
-                                        (struct vec3){ 0, 0, 0.1f, 1 },
-                                        (struct vec3){ 0, 0, 1, 1 },
-                                        viewed,
-                                        &clipped[0],
-                                        &clipped[1]);
-
-                                for (int n = 0; n < numClippedTriangles; n++) {
-                                        // Convert from 3D to 2D.
-                                        struct triangle projected = clipped[n];
-                                        projected.v[0] = Mat4x4MultiplyVec3(matProj, clipped[n].v[0]);
-                                        projected.v[1] = Mat4x4MultiplyVec3(matProj, clipped[n].v[1]);
-                                        projected.v[2] = Mat4x4MultiplyVec3(matProj, clipped[n].v[2]);
-
-                                        // Project texture coords
-                                        projected.u1 = projected.u1 / projected.w1;
-                                        projected.u2 = projected.u2 / projected.w2;
-                                        projected.u3 = projected.u3 / projected.w3;
-
-                                        projected.v1 = projected.v1 / projected.w1;
-                                        projected.v2 = projected.v2 / projected.w2;
-                                        projected.v3 = projected.v3 / projected.w3;
-
-                                        projected.tw1 = 1.0f / projected.w1;
-                                        projected.tw2 = 1.0f / projected.w2;
-                                        projected.tw3 = 1.0f / projected.w3;
-
-                                        projected.v[0] = Vec3Divide(projected.v[0], projected.v[0].w);
-                                        projected.v[1] = Vec3Divide(projected.v[1], projected.v[1].w);
-                                        projected.v[2] = Vec3Divide(projected.v[2], projected.v[2].w);
-
-                                        struct vec3 offset = { 1, 1, 0, 0 };
-                                        projected.v[0] = Vec3Add(projected.v[0], offset);
-                                        projected.v[1] = Vec3Add(projected.v[1], offset);
-                                        projected.v[2] = Vec3Add(projected.v[2], offset);
-
-                                        projected.v[0].x *= 0.5f * (float)SCREEN_WIDTH;
-                                        projected.v[0].y *= 0.5f * (float)SCREEN_HEIGHT;
-                                        projected.v[1].x *= 0.5f * (float)SCREEN_WIDTH;
-                                        projected.v[1].y *= 0.5f * (float)SCREEN_HEIGHT;
-                                        projected.v[2].x *= 0.5f * (float)SCREEN_WIDTH;
-                                        projected.v[2].y *= 0.5f * (float)SCREEN_HEIGHT;
-
-                                        // Store triangles for sorting.
-                                        renderTris[renderTrisCount] = projected;
-                                        renderTrisCount++;
-                                }
-                        }
+
+                struct mat4x4 matRot;
+                SimdMat4x4Multiply(&matRot, &matRotZ, &matRotX);
+                SimdMat4x4Multiply(&matRot, &matRot, &matRotY);
+                for (int n = 0; n < instanceCount; n++) {
+                        SceneSetLocal(scene, firstModel + n, matRot);
                 }
 
-                // Sort the triangles from back to front.
-                qsort(renderTris, renderTrisCount, sizeof(struct triangle), TriangleCompareFn);
-
-                for (int i = 0; i < renderTrisCount; i++) {
-                        // 16 because we potentially get two triangles per clip,
-                        // and each triangle can beget up to two more per side.
-                        // Side 1: 1 -> 2
-                        // Side 2: 2 -> 4
-                        // Side 3: 4 -> 8
-                        // Side 4: 8 -> 16
-                        struct triangle_list triangleList = TriangleListInit();
-
-                        TriangleListPushBack(&triangleList, renderTris[i]);
-                        int numNewTriangles = 1;
-
-                        // Now do screen edge clipping.
-                        for (int p = 0; p < 4; p++) {
-                                struct triangle clipped[2];
-                                int numTrisToAdd = 0;
-                                while (numNewTriangles > 0) {
-                                        struct triangle test = TriangleListPopFront(&triangleList);
-                                        numNewTriangles--;
-
-                                        switch(p) {
-                                                case 0:
-                                                        numTrisToAdd = TriangleClipAgainstPlane(
-                                                                (struct vec3){ 0, 0, 0, 1 },
-                                                                (struct vec3){ 0, 1, 0, 1 },
-                                                                test,
-                                                                &clipped[0],
-                                                                &clipped[1]);
-                                                        break;
-                                                case 1:
-                                                        numTrisToAdd = TriangleClipAgainstPlane(
-                                                                (struct vec3){ 0, (float)SCREEN_HEIGHT - 1, 0, 1 },
-                                                                (struct vec3){ 0, -1, 0, 1 },
-                                                                test,
-                                                                &clipped[0],
-                                                                &clipped[1]);
-                                                        break;
-                                                case 2:
-                                                        numTrisToAdd = TriangleClipAgainstPlane(
-                                                                (struct vec3){ 0, 0, 0, 1 },
-                                                                (struct vec3){ 1, 0, 0, 1 },
-                                                                test,
-                                                                &clipped[0],
-                                                                &clipped[1]);
-                                                        break;
-                                                case 3:
-                                                        numTrisToAdd = TriangleClipAgainstPlane(
-                                                                (struct vec3){ (float)SCREEN_WIDTH - 1, 0, 0, 1 },
-                                                                (struct vec3){ -1, 0, 0, 1 },
-                                                                test,
-                                                                &clipped[0],
-                                                                &clipped[1]);
-                                                        break;
-                                        }
-
-                                        for (int w = 0; w < numTrisToAdd; w++) {
-                                                TriangleListPushBack(&triangleList, clipped[w]);
-                                        }
-                                }
-                                numNewTriangles = TriangleListSize(&triangleList);
-                        }
+                frame++;
+                int nodesUpdated = SceneUpdate(scene);
 
-                        int listSize = TriangleListSize(&triangleList);
-                        for (int b = 0; b < listSize; b++) {
-                                struct triangle t = TriangleListPopFront(&triangleList);
-                                GraphicsTriangleTextured(graphics, t, texture);
-                                // Draw solid faces.
-                                // GraphicsTriangleSolid(graphics, t, t.color);
-                                // Draw wireframe faces.
-                                // GraphicsTriangleWireframe(graphics, t, ColorCyan.rgba);
-                        }
+                // Loaded chunks are swapped in and unwanted ones evicted
+                // between frames, while nothing is drawing them.
+                if (NULL != terrain) {
+                        TerrainUpdate(terrain, camera, lookDir);
+                }
+                if (NULL != heightmap) {
+                        struct mat4x4 matView = Mat4x4InvertFast(Mat4x4PointAt(camera, Vec3Add(camera, lookDir), up));
+                        HeightmapUpdate(heightmap, camera, matView, matProj, SCREEN_HEIGHT);
                 }
 
-                GraphicsEnd(graphics);
+                GraphicsBeginFrame(graphics, &view);
+                JobParallelFor(jobs, RecordJobs, records, partitions, 1);
+                for (int i = 0; i < partitions; i++) {
+                        GraphicsSubmit(graphics, recorders[i]);
+                }
+                if (NULL != terrain) {
+                        GraphicsCommandBufferReset(terrainRecorder);
+                        TerrainRecord(terrain, terrainRecorder, terrainMaterial);
+                        GraphicsSubmit(graphics, terrainRecorder);
+                }
+                if (NULL != heightmap) {
+                        GraphicsCommandBufferReset(terrainRecorder);
+                        HeightmapRecord(heightmap, terrainRecorder, terrainMaterial);
+                        GraphicsSubmit(graphics, terrainRecorder);
+                }
+                GraphicsEndFrame(graphics);
 
-                while (SDL_PollEvent(&event)) {
-                        running = !InputIsQuitPressed(&event);
+                if (0 == frame % STATS_INTERVAL) {
+                        printf("scene nodes updated: %d\n", nodesUpdated);
+                        GraphicsStatsDebug(GraphicsFrameStats(graphics), "stats");
+                        if (NULL != terrain) {
+                                TerrainDebug(terrain, "terrain");
+                        }
+                        if (NULL != heightmap) {
+                                HeightmapDebug(heightmap, "heightmap");
+                        }
                 }
-                InputProcess(input);
+
+                running = !InputQuitRequested(input);
 
                 struct timespec end;
                 clock_gettime(CLOCK_REALTIME, &end);
 
-                elapsedTime = S_TO_MS(end.tv_sec - start.tv_sec);
+                double elapsedTime = S_TO_MS(end.tv_sec - start.tv_sec);
                 elapsedTime += NS_TO_MS(end.tv_nsec - start.tv_nsec);
 
                 struct timespec sleep = { .tv_sec = 0, .tv_nsec = MS_TO_NS(msPerFrame - elapsedTime) };
                 nanosleep(&sleep, NULL);
         }
 
-        free(renderTris);
         Shutdown(0);
 
         return 0;
@@ -4,7 +4,7 @@
 
   File: math.c
   Created: 2019-08-07
-  Updated: 2019-08-24
+  Updated: 2026-10-19
   Author: Aaron Oman
   Notice: GNU GPLv3 License
 
@@ -188,7 +188,7 @@ struct triangle TriangleInit(
         return t;
 }
 
-int TriangleClipAgainstPlane(struct vec3 plane, struct vec3 normal, struct triangle in, struct triangle *out1, struct triangle *out2) {
+int TriangleClipAgainstPlane(struct vec3 plane, struct vec3 normal, struct triangle *in, struct triangle *out1, struct triangle *out2) {
         normal = Vec3Normalize(normal);
 
         struct vec3* insidePoints[3];  int insidePointsCount = 0;
@@ -196,32 +196,32 @@ int TriangleClipAgainstPlane(struct vec3 plane, struct vec3 normal, struct trian
         struct vec2* insideTex[3];     int insideTexCount = 0;
         struct vec2* outsideTex[3];    int outsideTexCount = 0;
 
-        float d0 = ShortestDistToPlane(in.v[0], plane, normal);
-        float d1 = ShortestDistToPlane(in.v[1], plane, normal);
-        float d2 = ShortestDistToPlane(in.v[2], plane, normal);
+        float d0 = ShortestDistToPlane(in->v[0], plane, normal);
+        float d1 = ShortestDistToPlane(in->v[1], plane, normal);
+        float d2 = ShortestDistToPlane(in->v[2], plane, normal);
 
         if (d0 >= 0 ) {
-                insidePoints[insidePointsCount++] = &in.v[0];
-                insideTex[insideTexCount++] = &in.t[0];
+                insidePoints[insidePointsCount++] = &in->v[0];
+                insideTex[insideTexCount++] = &in->t[0];
         } else {
-                outsidePoints[outsidePointsCount++] = &in.v[0];
-                outsideTex[outsideTexCount++] = &in.t[0];
+                outsidePoints[outsidePointsCount++] = &in->v[0];
+                outsideTex[outsideTexCount++] = &in->t[0];
         }
 
         if (d1 >= 0 ) {
-                insidePoints[insidePointsCount++] = &in.v[1];
-                insideTex[insideTexCount++] = &in.t[1];
+                insidePoints[insidePointsCount++] = &in->v[1];
+                insideTex[insideTexCount++] = &in->t[1];
         } else {
-                outsidePoints[outsidePointsCount++] = &in.v[1];
-                outsideTex[outsideTexCount++] = &in.t[1];
+                outsidePoints[outsidePointsCount++] = &in->v[1];
+                outsideTex[outsideTexCount++] = &in->t[1];
         }
 
         if (d2 >= 0 ) {
-                insidePoints[insidePointsCount++] = &in.v[2];
-                insideTex[insideTexCount++] = &in.t[2];
+                insidePoints[insidePointsCount++] = &in->v[2];
+                insideTex[insideTexCount++] = &in->t[2];
         } else {
-                outsidePoints[outsidePointsCount++] = &in.v[2];
-                outsideTex[outsideTexCount++] = &in.t[2];
+                outsidePoints[outsidePointsCount++] = &in->v[2];
+                outsideTex[outsideTexCount++] = &in->t[2];
         }
 
         // Now classify the triangle points.
@@ -234,7 +234,7 @@ int TriangleClipAgainstPlane(struct vec3 plane, struct vec3 normal, struct trian
 
         if (insidePointsCount == 3) {
                 // All points lie on the inside of the plan, so do nothing.
-                *out1 = in;
+                *out1 = *in;
 
                 return 1; // Just one returned triangle is valid.
         }
@@ -245,7 +245,8 @@ int TriangleClipAgainstPlane(struct vec3 plane, struct vec3 normal, struct trian
                 // plane.  Create a new, smaller triangle.
 
                 *out1 = (struct triangle){ 0 };
-                out1->color = in.color;
+                out1->color = in->color;
+                out1->material = in->material;
                 // The inside point is valid, so keep it.
                 out1->v[0] = *insidePoints[0];
                 // out1->color = ColorRed.rgba; // Debug color.
@@ -273,10 +274,12 @@ int TriangleClipAgainstPlane(struct vec3 plane, struct vec3 normal, struct trian
                 // this into two triangles.
 
                 *out1 = (struct triangle){ 0 };
-                out1->color = in.color;
+                out1->color = in->color;
+                out1->material = in->material;
                 // out1->color = ColorGreen.rgba; // Debug color.
                 *out2 = (struct triangle){ 0 };
-                out2->color = in.color;
+                out2->color = in->color;
+                out2->material = in->material;
                 // out2->color = ColorBlue.rgba; // Debug color.
 
                 // The first triangle consists of the two inside points and a
@@ -311,144 +314,6 @@ int TriangleClipAgainstPlane(struct vec3 plane, struct vec3 normal, struct trian
         return 0;
 }
 
-struct mesh *MeshInit(int numTris) {
-        struct mesh *mesh = (struct mesh *)malloc(sizeof(struct mesh));
-        memset(mesh, 0, sizeof(struct mesh));
-
-        mesh->tris = (struct triangle *)malloc(sizeof(struct triangle) * numTris);
-        memset(mesh->tris, 0, sizeof(struct triangle) * numTris);
-
-        mesh->count = numTris;
-
-        return mesh;
-}
-
-struct mesh *MeshInitFromObj(char *objFile) {
-        FILE *file = fopen(objFile, "r");
-        if (NULL == file) {
-                fprintf(stderr, "Couldn't open %s", objFile);
-                return NULL;
-        }
-
-        // First scan through the file to see how much data we need to read.
-        int numFaces = 0;
-        int numVertices = 0;
-        int numTexCoords = 0;
-        char line[256];
-        while (NULL != fgets(line, sizeof(line), file)) {
-                switch (line[0]) {
-                        case 'v':
-                                if ('t' == line[1]) {
-                                        numTexCoords++;
-                                } else {
-                                        numVertices++;
-                                }
-                                break;
-                        case 'f':
-                                numFaces++;
-                                break;
-                }
-        }
-        if (ferror(file)) {
-                fprintf(stderr, "I/O error while reading %s", objFile);
-                return NULL;
-        }
-        rewind(file);
-
-        // Now size our data containers appropriately.
-        struct mesh *mesh = (struct mesh *)malloc(sizeof(struct mesh));
-        memset(mesh, 0, sizeof(struct mesh));
-
-        mesh->tris = (struct triangle *)malloc(sizeof(struct triangle) * numFaces);
-        memset(mesh->tris, 0, sizeof(struct triangle) * numFaces);
-
-        mesh->count = numFaces;
-
-        struct vec3 *vertex = (struct vec3 *)malloc(sizeof(struct vec3) * numVertices);
-        memset(vertex, 0, sizeof(struct vec3) * numVertices);
-
-        struct vec2 *tex = (struct vec2 *)malloc(sizeof(struct vec2) * numTexCoords);
-        memset(tex, 0, sizeof(struct vec2) * numTexCoords);
-
-        int vertIdx = 0;
-        int faceIdx = 0;
-        int texIdx = 0;
-        // Finally, read through the file, filling out our data containers.
-        while (NULL != fgets(line, sizeof(line), file)) {
-                float x, y, z;
-                int vi1, vi2, vi3, ti1, ti2, ti3;
-
-                switch (line[0]) {
-                        case 'v': {
-                                if ('t' == line[1]) {
-                                        sscanf(line, "vt %f %f", &x, &y);
-                                        tex[texIdx].u = x;
-                                        tex[texIdx].v = y;
-                                        tex[texIdx].w = 1.0f;
-                                        texIdx++;
-                                } else {
-                                        sscanf(line, "v %f %f %f", &x, &y, &z);
-                                        vertex[vertIdx].x = x;
-                                        vertex[vertIdx].y = y;
-                                        vertex[vertIdx].z = z;
-                                        vertex[vertIdx].w = 1.0f;
-                                        vertIdx++;
-                                }
-                                break;
-                        }
-                        case 'f': {
-                                int numAssigned = sscanf(line, "f %d/%d %d/%d %d/%d", &vi1, &ti1, &vi2, &ti2, &vi3, &ti3);
-                                if (6 == numAssigned) {
-                                        mesh->tris[faceIdx].v[0] = vertex[vi1 - 1];
-                                        mesh->tris[faceIdx].v[1] = vertex[vi2 - 1];
-                                        mesh->tris[faceIdx].v[2] = vertex[vi3 - 1];
-                                        mesh->tris[faceIdx].t[0] = tex[ti1 - 1];
-                                        mesh->tris[faceIdx].t[1] = tex[ti2 - 1];
-                                        mesh->tris[faceIdx].t[2] = tex[ti3 - 1];
-                                        faceIdx++;
-                                        break;
-                                }
-
-                                numAssigned = sscanf(line, "f %d %d %d", &vi1, &vi2, &vi3);
-                                if (3 == numAssigned) {
-                                        mesh->tris[faceIdx].v[0] = vertex[vi1 - 1];
-                                        mesh->tris[faceIdx].v[1] = vertex[vi2 - 1];
-                                        mesh->tris[faceIdx].v[2] = vertex[vi3 - 1];
-                                        faceIdx++;
-                                        break;
-                                }
-
-                                fprintf(stderr, "Couldn't read face line: %s\n", line);
-                                break;
-                        }
-                }
-        }
-        if (ferror(file)) {
-                fprintf(stderr, "I/O error while reading %s", objFile);
-                free(vertex);
-                free(mesh->tris);
-                free(mesh);
-                return NULL;
-        }
-
-        fclose(file);
-        free(vertex);
-
-        return mesh;
-}
-
-void MeshDeinit(struct mesh *mesh) {
-        if (NULL == mesh) {
-                return;
-        }
-
-        if (NULL != mesh->tris) {
-                free(mesh->tris);
-        }
-
-        free(mesh);
-}
-
 struct vec3 Mat4x4MultiplyVec3(struct mat4x4 mat, struct vec3 vec) {
         struct vec3 res;
         res.x = vec.x * mat.m[0][0] + vec.y * mat.m[1][0] + vec.z * mat.m[2][0] + vec.w * mat.m[3][0];
@@ -557,6 +422,45 @@ struct mat4x4 Mat4x4InvertFast(struct mat4x4 matrix) {
         return res;
 }
 
+struct mat4x4 Mat4x4InvertAffine(struct mat4x4 matrix) {
+        float (*m)[4] = matrix.m;
+
+        // Inverse of the upper 3x3 by cofactors.
+        float c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+        float c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+        float c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+        float invDet = 1.0f / (m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02);
+
+        struct mat4x4 res = { 0 };
+        res.m[0][0] = c00 * invDet;
+        res.m[1][0] = c01 * invDet;
+        res.m[2][0] = c02 * invDet;
+        res.m[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * invDet;
+        res.m[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * invDet;
+        res.m[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * invDet;
+        res.m[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * invDet;
+        res.m[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * invDet;
+        res.m[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * invDet;
+
+        res.m[3][0] = -(m[3][0] * res.m[0][0] + m[3][1] * res.m[1][0] + m[3][2] * res.m[2][0]);
+        res.m[3][1] = -(m[3][0] * res.m[0][1] + m[3][1] * res.m[1][1] + m[3][2] * res.m[2][1]);
+        res.m[3][2] = -(m[3][0] * res.m[0][2] + m[3][1] * res.m[1][2] + m[3][2] * res.m[2][2]);
+
+        res.m[3][3] = 1.0f;
+        return res;
+}
+
+float Mat4x4MaxScale(struct mat4x4 matrix) {
+        float max = 0.0f;
+        for (int r = 0; r < 3; r++) {
+                float lenSq = matrix.m[r][0] * matrix.m[r][0] + matrix.m[r][1] * matrix.m[r][1] + matrix.m[r][2] * matrix.m[r][2];
+                if (lenSq > max) {
+                        max = lenSq;
+                }
+        }
+        return sqrtf(max);
+}
+
 struct mat4x4 Mat4x4PointAt(struct vec3 pos, struct vec3 target, struct vec3 up) {
         struct vec3 forward = Vec3Subtract(target, pos);
         forward = Vec3Normalize(forward);
@@ -591,3 +495,84 @@ void Mat4x4Debug(struct mat4x4 mat, char *name) {
         }
         printf("}\n");
 }
+
+struct frustum FrustumInit(struct mat4x4 mat) {
+        // Clip coordinates are p * mat, so each clip component is the dot
+        // product of p with a column of mat.
+        struct vec3 col[4];
+        for (int c = 0; c < 4; c++) {
+                col[c].x = mat.m[0][c];
+                col[c].y = mat.m[1][c];
+                col[c].z = mat.m[2][c];
+                col[c].w = mat.m[3][c];
+        }
+
+        struct frustum frustum;
+        for (int i = 0; i < 4; i++) {
+                float sign = (i & 1) ? -1.0f : 1.0f;
+                struct vec3 *axis = &col[i / 2];
+                frustum.planes[i].x = col[3].x + sign * axis->x;
+                frustum.planes[i].y = col[3].y + sign * axis->y;
+                frustum.planes[i].z = col[3].z + sign * axis->z;
+                frustum.planes[i].w = col[3].w + sign * axis->w;
+        }
+        frustum.planes[4] = col[2];
+        frustum.planes[5].x = col[3].x - col[2].x;
+        frustum.planes[5].y = col[3].y - col[2].y;
+        frustum.planes[5].z = col[3].z - col[2].z;
+        frustum.planes[5].w = col[3].w - col[2].w;
+
+        for (int i = 0; i < 6; i++) {
+                float len = sqrtf(Vec3DotProduct(frustum.planes[i], frustum.planes[i]));
+                frustum.planes[i].x /= len;
+                frustum.planes[i].y /= len;
+                frustum.planes[i].z /= len;
+                frustum.planes[i].w /= len;
+        }
+
+        return frustum;
+}
+
+struct sphere SphereTransform(struct sphere sphere, struct mat4x4 mat) {
+        struct sphere res;
+        res.center = Mat4x4MultiplyVec3(mat, sphere.center);
+        res.radius = sphere.radius * Mat4x4MaxScale(mat);
+        return res;
+}
+
+int FrustumTestSphere(const struct frustum *frustum, struct sphere sphere) {
+        int result = FRUSTUM_INSIDE;
+        for (int i = 0; i < 6; i++) {
+                struct vec3 plane = frustum->planes[i];
+                float dist = Vec3DotProduct(plane, sphere.center) + plane.w;
+                if (dist < -sphere.radius) {
+                        return FRUSTUM_OUTSIDE;
+                }
+                if (dist < sphere.radius) {
+                        result = FRUSTUM_INTERSECT;
+                }
+        }
+        return result;
+}
+
+int FrustumTestAABB(const struct frustum *frustum, struct aabb box) {
+        int result = FRUSTUM_INSIDE;
+        for (int i = 0; i < 6; i++) {
+                struct vec3 plane = frustum->planes[i];
+
+                // The corners furthest along and against the plane normal.
+                struct vec3 far, near;
+                for (int a = 0; a < 3; a++) {
+                        far.p[a] = plane.p[a] >= 0.0f ? box.max.p[a] : box.min.p[a];
+                        near.p[a] = plane.p[a] >= 0.0f ? box.min.p[a] : box.max.p[a];
+                }
+
+                if (Vec3DotProduct(plane, far) + plane.w < 0.0f) {
+                        return FRUSTUM_OUTSIDE;
+                }
+                if (Vec3DotProduct(plane, near) + plane.w < 0.0f) {
+                        result = FRUSTUM_INTERSECT;
+                }
+        }
+        return result;
+}
@@ -4,7 +4,7 @@
 
   File: math.h
   Created: 2019-08-13
-  Updated: 2019-08-27
+  Updated: 2026-10-19
   Author: Aaron Oman
   Notice: GNU GPLv3 License
 
@@ -39,6 +39,9 @@ struct vec2 {
 //!
 //! A 4-element structure used to represent 3D coordinate space with 3 cartesian
 //! coordinates and a homogeouns 4th coordinate for projection.
+//!
+//! Aligned to 16 bytes so it can be loaded directly into an SSE register.
+//! \see simd.h
 struct vec3 {
         union {
                 struct {
@@ -47,17 +50,19 @@ struct vec3 {
                         float z;
                         float w;
                 };
-                float p[4];
+                _Alignas(16) float p[4];
         };
 };
 
 //! \brief Triangular mesh face
 //!
 //! A mesh face consisting solely of homogenous 3D coordinates and homogenous 2D
-//! texture coordinates, and a color attribute.
+//! texture coordinates, a color attribute and a material index.
 //!
-//! Currently the color attribute is not used, but it is useful for debugging or
-//! falling back to in lieu of texture values or coordinate values.
+//! The color attribute holds the lit color used when the triangle's material
+//! has no texture. The material index is only meaningful to whoever produced
+//! the triangle; the retained draw API in graphics.h uses it to index the
+//! frame's materials.
 struct triangle {
         union {
                 struct {
@@ -91,19 +96,45 @@ struct triangle {
                 struct vec2 t[3];
         };
         unsigned int color;
-};
-
-//! A collection of triangles representing some kind of 3D model.
-struct mesh {
-        struct triangle *tris;
-        int count;
+        unsigned int material;
 };
 
 //! A 3D matrix using homogenous coordinates.
+//!
+//! Aligned to 16 bytes so each row can be loaded directly into an SSE register.
+//! \see simd.h
 struct mat4x4 {
-        float m[4][4];
+        _Alignas(16) float m[4][4];
+};
+
+//! Axis-aligned bounding box.
+struct aabb {
+        struct vec3 min;
+        struct vec3 max;
+};
+
+//! Bounding sphere.
+struct sphere {
+        struct vec3 center;
+        float radius;
+};
+
+//! \brief The six planes bounding a view volume
+//!
+//! Each plane stores its unit normal in xyz and its distance from the origin in
+//! w. Normals point into the volume, so a point p is inside a plane when
+//! dot(plane.xyz, p) + plane.w >= 0.
+struct frustum {
+        struct vec3 planes[6]; //!< left, right, bottom, top, near, far
 };
 
+//! Result of a frustum test: the volume is entirely outside the frustum.
+#define FRUSTUM_OUTSIDE 0
+//! Result of a frustum test: the volume straddles at least one plane.
+#define FRUSTUM_INTERSECT 1
+//! Result of a frustum test: the volume is entirely inside the frustum.
+#define FRUSTUM_INSIDE 2
+
 //! \brief Prints debug information about the homogenous 3D vector
 void
 Vec3Debug(struct vec3 vec3, char *name);
@@ -159,49 +190,18 @@ struct triangle TriangleInit(
 //!
 //! \param[in] plane point on the plane to clip against
 //! \param[in] normal normal of the plane to clip against
-//! \param[in] in the triangle to clip
+//! \param[in] in the triangle to clip; must not overlap out1 or out2
 //! \param[out] out1 one of the smaller triangles resulting from the clipping, if necessary
 //! \param[out] out2 one of the smaller triangles resulting from the clipping, if necessary
 //! \return 0 if all points are outside the plane, 1 if the triangle is not
 //! clipped, otherwise the number of smaller triangles resulting from clipping.
 int
-TriangleClipAgainstPlane(struct vec3 plane, struct vec3 normal, struct triangle in, struct triangle *out1, struct triangle *out2);
+TriangleClipAgainstPlane(struct vec3 plane, struct vec3 normal, struct triangle *in, struct triangle *out1, struct triangle *out2);
 
 //! \brief Prints debug information about the triangle face.
 void
 TriangleDebug(struct triangle triangle, char *name);
 
-//! \brief Initialize a new mesh object
-//!
-//! This function is useful if a mesh needs to be explicitly, manually defined.
-//! Initialization here only refers to setting a valid "zero" state.
-//!
-//! \param[in] numTris the number of triangular faces the mesh will hold.
-//! \return a properly "zeroed" mesh object that can support numTris faces.
-struct mesh *
-MeshInit(int numTris);
-
-//! \brief Initialize a new mesh object from an obj file
-//!
-//! Loads the specified obj file and constructs a new mesh object representation of it.
-//!
-//! Note: This doesn't read material definitions properly, instead explicitly loading a predefined texture out-of-band and applying it if there are texture coordinates in the obj file.
-//!
-//! \param[in] objFile path to the obj file to read
-//! \return a mesh object representing the data in the obj file
-//!
-//! \see \ref features
-struct mesh *
-MeshInitFromObj(char *objFile);
-
-//! \brief De-initializes the mesh object
-//!
-//! Frees any memory allocated by the object and frees the pointer to the object itself.
-//!
-//! \param[in,out] mesh The mesh to be de-initialized
-void
-MeshDeinit(struct mesh *mesh);
-
 struct vec3
 Mat4x4MultiplyVec3(struct mat4x4 mat, struct vec3 vec);
 
@@ -230,6 +230,21 @@ Mat4x4Multiply(struct mat4x4 left, struct mat4x4 right);
 struct mat4x4
 Mat4x4InvertFast(struct mat4x4 matrix);
 
+//! \brief Inverse of an affine matrix: any rotation, scale or shear plus translation
+//!
+//! Slower than Mat4x4InvertFast() but correct for scaled transforms. The
+//! result is undefined if the matrix is singular.
+struct mat4x4
+Mat4x4InvertAffine(struct mat4x4 matrix);
+
+//! \brief Largest factor by which the matrix scales any direction's length
+//!
+//! Exact for any rotation combined with scaling applied before it, which
+//! includes every uniformly scaled rigid transform. Shearing matrices may be
+//! underestimated.
+float
+Mat4x4MaxScale(struct mat4x4 matrix);
+
 struct mat4x4
 Mat4x4PointAt(struct vec3 pos, struct vec3 target, struct vec3 up);
 
@@ -237,4 +252,41 @@ Mat4x4PointAt(struct vec3 pos, struct vec3 target, struct vec3 up);
 void
 Mat4x4Debug(struct mat4x4 mat, char *name);
 
+//! \brief Extract the view frustum from a projection matrix
+//!
+//! The planes are expressed in whatever space mat transforms from. Passing a
+//! world * view * projection matrix gives an object space frustum, view *
+//! projection a world space frustum, and so on.
+//!
+//! Expects the clip space conventions of Mat4x4Project(): -w <= x, y <= w and
+//! 0 <= z <= w.
+//!
+//! \param[in] mat matrix transforming points into clip space
+//! \return the frustum
+//!
+//! \see Fast Extraction of Viewing Frustum Planes from the World-View-Projection
+//! Matrix, Gil Gribb and Klaus Hartmann
+struct frustum
+FrustumInit(struct mat4x4 mat);
+
+//! \brief Transform a sphere, growing it to contain the transformed original
+//!
+//! \param[in] sphere the sphere to transform
+//! \param[in] mat affine transform to apply
+//! \return a sphere containing every transformed point of the original
+struct sphere
+SphereTransform(struct sphere sphere, struct mat4x4 mat);
+
+//! \brief Classify a sphere against a frustum
+//!
+//! \return FRUSTUM_OUTSIDE, FRUSTUM_INTERSECT or FRUSTUM_INSIDE
+int
+FrustumTestSphere(const struct frustum *frustum, struct sphere sphere);
+
+//! \brief Classify an axis-aligned box against a frustum
+//!
+//! \return FRUSTUM_OUTSIDE, FRUSTUM_INTERSECT or FRUSTUM_INSIDE
+int
+FrustumTestAABB(const struct frustum *frustum, struct aabb box);
+
 #endif // MATH_VERSION
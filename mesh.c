@@ -0,0 +1,2110 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: mesh.c
+  Created: 2026-10-18
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file mesh.c
+
+#include <stdlib.h> // malloc, free
+#include <string.h> // memset, memcpy, strlen
+#include <stdio.h> // printf, fopen, rename
+#include <stdint.h> // uint64_t
+#include <math.h> // sqrtf, powf
+#include <fcntl.h> // open
+#include <unistd.h> // close, sysconf
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // stat
+
+#include "mesh.h"
+#include "obj.h"
+
+//! \brief Open addressing hash table mapping obj (position, texcoord, normal)
+//! index triples to mesh vertex indices. Used only while loading.
+struct vertex_map {
+        struct obj_corner *keys;
+        unsigned int *values;
+        unsigned int mask;
+};
+
+//! Marks an unused slot in vertex_map. Valid keys never have a negative position.
+#define VERTEX_MAP_EMPTY -1
+
+struct vertex_map VertexMapInit(int numEntries) {
+        unsigned int size = 16;
+        while (size < (unsigned int)numEntries * 2) {
+                size <<= 1;
+        }
+
+        struct vertex_map map;
+        map.keys = (struct obj_corner *)malloc(sizeof(struct obj_corner) * size);
+        for (unsigned int i = 0; i < size; i++) {
+                map.keys[i].position = VERTEX_MAP_EMPTY;
+        }
+        map.values = (unsigned int *)malloc(sizeof(unsigned int) * size);
+        map.mask = size - 1;
+        return map;
+}
+
+void VertexMapDeinit(struct vertex_map *map) {
+        free(map->keys);
+        free(map->values);
+}
+
+//! \brief Find the vertex for key, or insert it with value if it is missing
+//!
+//! \param[in,out] map the map to search
+//! \param[in] key obj position, texcoord and normal indices
+//! \param[in] value vertex index to store if key isn't present
+//! \param[out] inserted set to 1 if key was inserted, otherwise 0
+//! \return the vertex index stored for key
+unsigned int VertexMapFindOrInsert(struct vertex_map *map, struct obj_corner key, unsigned int value, int *inserted) {
+        uint64_t hash = ((uint64_t)(uint32_t)key.position << 32) | (uint32_t)key.texcoord;
+        hash = (hash ^ (uint32_t)key.normal) * 0x9E3779B97F4A7C15ull;
+        unsigned int slot = (unsigned int)(hash >> 32) & map->mask;
+        while (VERTEX_MAP_EMPTY != map->keys[slot].position) {
+                struct obj_corner *stored = &map->keys[slot];
+                if (key.position == stored->position && key.texcoord == stored->texcoord && key.normal == stored->normal) {
+                        *inserted = 0;
+                        return map->values[slot];
+                }
+                slot = (slot + 1) & map->mask;
+        }
+
+        map->keys[slot] = key;
+        map->values[slot] = value;
+        *inserted = 1;
+        return value;
+}
+
+//! Size of the simulated LRU post-transform cache used by the vertex cache optimizer.
+#define FORSYTH_CACHE_SIZE 32
+
+//! \brief Forsyth vertex score
+//!
+//! Vertices recently used score highly so their triangles are emitted while
+//! they're still cached, and vertices with few remaining triangles get a boost
+//! so they're finished off instead of leaving lone triangles behind.
+//!
+//! \param[in] cachePosition position in the LRU cache or -1 if not cached
+//! \param[in] valence number of triangles still to be emitted using the vertex
+//! \return the vertex score
+//!
+//! \see https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+float ForsythVertexScore(int cachePosition, int valence) {
+        if (0 == valence) {
+                return -1.0f;
+        }
+
+        float score = 0.0f;
+        if (cachePosition >= 3) {
+                float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+                score = powf(1.0f - (cachePosition - 3) * scaler, 1.5f);
+        } else if (cachePosition >= 0) {
+                // The most recent triangle's vertices are penalized slightly
+                // so the next triangle doesn't simply reuse the same edge.
+                score = 0.75f;
+        }
+
+        return score + 2.0f * powf((float)valence, -0.5f);
+}
+
+//! \brief Reorder triangles in an index buffer for post-transform cache reuse
+//!
+//! A linear-time greedy optimizer after Tom Forsyth: the next triangle emitted
+//! is always the best-scoring one touching the simulated cache.
+//!
+//! \param[in,out] indices 3 * triCount vertex indices, reordered in place
+//! \param[in] triCount number of triangles in indices
+//! \param[in] vertexCount every index is less than this
+void OptimizeVertexCache(unsigned int *indices, int triCount, int vertexCount) {
+        if (triCount < 2) {
+                return;
+        }
+
+        int *valence = (int *)calloc(vertexCount, sizeof(int));
+        int *adjOffset = (int *)calloc(vertexCount + 1, sizeof(int));
+        int *adjTris = (int *)malloc(sizeof(int) * triCount * 3);
+        int *cachePos = (int *)malloc(sizeof(int) * vertexCount);
+        float *vertexScore = (float *)malloc(sizeof(float) * vertexCount);
+        float *triScore = (float *)malloc(sizeof(float) * triCount);
+        unsigned char *emitted = (unsigned char *)calloc(triCount, 1);
+        unsigned int *out = (unsigned int *)malloc(sizeof(unsigned int) * triCount * 3);
+
+        // Vertex to triangle adjacency, as one array partitioned per vertex.
+        for (int i = 0; i < triCount * 3; i++) {
+                valence[indices[i]]++;
+        }
+        for (int v = 0; v < vertexCount; v++) {
+                adjOffset[v + 1] = adjOffset[v] + valence[v];
+        }
+        int *fill = (int *)malloc(sizeof(int) * vertexCount);
+        memcpy(fill, adjOffset, sizeof(int) * vertexCount);
+        for (int i = 0; i < triCount * 3; i++) {
+                adjTris[fill[indices[i]]++] = i / 3;
+        }
+        free(fill);
+
+        for (int v = 0; v < vertexCount; v++) {
+                cachePos[v] = -1;
+                vertexScore[v] = ForsythVertexScore(-1, valence[v]);
+        }
+        for (int t = 0; t < triCount; t++) {
+                unsigned int *tri = &indices[t * 3];
+                triScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+        }
+
+        int cache[FORSYTH_CACHE_SIZE + 3];
+        int cacheCount = 0;
+        int scanCursor = 0;
+
+        int best = 0;
+        for (int t = 1; t < triCount; t++) {
+                if (triScore[t] > triScore[best]) {
+                        best = t;
+                }
+        }
+
+        for (int outCount = 0; outCount < triCount; outCount++) {
+                if (best < 0) {
+                        // Nothing in the cache has triangles left; take the
+                        // next unemitted triangle in source order.
+                        while (emitted[scanCursor]) {
+                                scanCursor++;
+                        }
+                        best = scanCursor;
+                }
+
+                unsigned int *tri = &indices[best * 3];
+                memcpy(&out[outCount * 3], tri, sizeof(unsigned int) * 3);
+                emitted[best] = 1;
+
+                // Remove the triangle from its vertices' adjacency lists.
+                for (int c = 0; c < 3; c++) {
+                        unsigned int v = tri[c];
+                        int *list = &adjTris[adjOffset[v]];
+                        for (int a = 0; a < valence[v]; a++) {
+                                if (list[a] == best) {
+                                        list[a] = list[valence[v] - 1];
+                                        break;
+                                }
+                        }
+                        valence[v]--;
+                }
+
+                // Move the triangle's vertices to the front of the LRU cache.
+                int newCache[FORSYTH_CACHE_SIZE + 3];
+                int newCount = 0;
+                for (int c = 0; c < 3; c++) {
+                        newCache[newCount++] = tri[c];
+                }
+                for (int c = 0; c < cacheCount; c++) {
+                        int v = cache[c];
+                        if (v != (int)tri[0] && v != (int)tri[1] && v != (int)tri[2]) {
+                                newCache[newCount++] = v;
+                        }
+                }
+
+                // Rescore everything that was or is in the cache; vertices past
+                // the cache size fall out but still need their score updated.
+                for (int c = 0; c < newCount; c++) {
+                        int v = newCache[c];
+                        cachePos[v] = c < FORSYTH_CACHE_SIZE ? c : -1;
+                        vertexScore[v] = ForsythVertexScore(cachePos[v], valence[v]);
+                }
+                cacheCount = newCount < FORSYTH_CACHE_SIZE ? newCount : FORSYTH_CACHE_SIZE;
+                memcpy(cache, newCache, sizeof(int) * cacheCount);
+
+                // The next triangle is the best one touching the cache.
+                best = -1;
+                float bestScore = -1.0f;
+                for (int c = 0; c < newCount; c++) {
+                        int v = newCache[c];
+                        for (int a = 0; a < valence[v]; a++) {
+                                int t = adjTris[adjOffset[v] + a];
+                                unsigned int *adj = &indices[t * 3];
+                                triScore[t] = vertexScore[adj[0]] + vertexScore[adj[1]] + vertexScore[adj[2]];
+                                if (triScore[t] > bestScore) {
+                                        bestScore = triScore[t];
+                                        best = t;
+                                }
+                        }
+                }
+        }
+
+        memcpy(indices, out, sizeof(unsigned int) * triCount * 3);
+
+        free(out);
+        free(emitted);
+        free(triScore);
+        free(vertexScore);
+        free(cachePos);
+        free(adjTris);
+        free(adjOffset);
+        free(valence);
+}
+
+struct mesh *MeshInit(int numVertices, int numTris) {
+        struct mesh *mesh = (struct mesh *)malloc(sizeof(struct mesh));
+        memset(mesh, 0, sizeof(struct mesh));
+
+        mesh->positions = (struct vec3 *)malloc(sizeof(struct vec3) * numVertices);
+        memset(mesh->positions, 0, sizeof(struct vec3) * numVertices);
+
+        mesh->normals = (struct vec3 *)malloc(sizeof(struct vec3) * numVertices);
+        memset(mesh->normals, 0, sizeof(struct vec3) * numVertices);
+
+        mesh->uvs = (struct vec2 *)malloc(sizeof(struct vec2) * numVertices);
+        memset(mesh->uvs, 0, sizeof(struct vec2) * numVertices);
+
+        mesh->vertexCount = numVertices;
+
+        mesh->indices = (unsigned int *)malloc(sizeof(unsigned int) * 3 * numTris);
+        memset(mesh->indices, 0, sizeof(unsigned int) * 3 * numTris);
+
+        mesh->planes = (struct vec3 *)malloc(sizeof(struct vec3) * numTris);
+        memset(mesh->planes, 0, sizeof(struct vec3) * numTris);
+
+        mesh->triCount = numTris;
+
+        return mesh;
+}
+
+struct vec3 *MeshObjNormalSums(struct obj *obj) {
+        // Unnormalized cross products weight the normals by face area.
+        struct vec3 *normalSums = (struct vec3 *)malloc(sizeof(struct vec3) * (obj->positionCount > 0 ? obj->positionCount : 1));
+        memset(normalSums, 0, sizeof(struct vec3) * obj->positionCount);
+        for (int t = 0; t < obj->triCount; t++) {
+                struct obj_corner *corners = &obj->corners[t * 3];
+                struct vec3 *p = obj->positions;
+                struct vec3 line1 = Vec3Subtract(p[corners[1].position], p[corners[0].position]);
+                struct vec3 line2 = Vec3Subtract(p[corners[2].position], p[corners[0].position]);
+                struct vec3 normal = Vec3CrossProduct(line1, line2);
+                for (int c = 0; c < 3; c++) {
+                        normalSums[corners[c].position] = Vec3Add(normalSums[corners[c].position], normal);
+                }
+        }
+        return normalSums;
+}
+
+struct mesh *MeshInitFromObjGroup(struct obj *obj, int *groups, int group, struct vec3 *normalSums, int flags) {
+        int numFaces = 0;
+        for (int t = 0; t < obj->triCount; t++) {
+                numFaces += group == groups[t];
+        }
+
+        // Size the data containers for the worst case, where no vertex is
+        // shared; the vertex arrays are trimmed once the real count is known.
+        struct mesh *mesh = MeshInit(numFaces * 3, numFaces);
+
+        // Area-weighted face normal sum for each obj position, over every
+        // face in the file so normals match where groups meet.
+        struct vec3 *normalSum = NULL != normalSums ? normalSums : MeshObjNormalSums(obj);
+
+        // Which obj position each mesh vertex came from, or -1 if its normal
+        // was read from the file.
+        int *vertexSource = (int *)malloc(sizeof(int) * numFaces * 3);
+
+        struct vertex_map map = VertexMapInit(numFaces * 3);
+
+        int uniqueIdx = 0;
+        for (int t = 0, face = 0; face < numFaces; t++) {
+                if (group != groups[t]) {
+                        continue;
+                }
+                struct obj_corner *corners = &obj->corners[t * 3];
+
+                for (int c = 0; c < 3; c++) {
+                        struct obj_corner corner = corners[c];
+                        int inserted;
+                        unsigned int index = VertexMapFindOrInsert(&map, corner, uniqueIdx, &inserted);
+                        if (inserted) {
+                                mesh->positions[index] = obj->positions[corner.position];
+                                if (corner.texcoord >= 0) {
+                                        mesh->uvs[index] = obj->texcoords[corner.texcoord];
+                                }
+                                // Normals from the file are used as is;
+                                // the rest are derived from the faces below.
+                                vertexSource[index] = corner.position;
+                                if (corner.normal >= 0) {
+                                        struct vec3 normal = obj->normals[corner.normal];
+                                        if (0.0f != Vec3DotProduct(normal, normal)) {
+                                                mesh->normals[index] = Vec3Normalize(normal);
+                                                vertexSource[index] = -1;
+                                        }
+                                }
+                                uniqueIdx++;
+                        }
+                        mesh->indices[face * 3 + c] = index;
+                }
+                face++;
+        }
+        VertexMapDeinit(&map);
+
+        mesh->vertexCount = uniqueIdx;
+
+        int imported = 0;
+        for (int i = 0; i < mesh->vertexCount; i++) {
+                if (vertexSource[i] < 0) {
+                        mesh->normals[i].w = 0.0f;
+                        imported++;
+                        continue;
+                }
+                struct vec3 sum = normalSum[vertexSource[i]];
+                if (0.0f != Vec3DotProduct(sum, sum)) {
+                        mesh->normals[i] = Vec3Normalize(sum);
+                }
+                mesh->normals[i].w = 0.0f;
+        }
+
+        mesh->importedNormals = mesh->vertexCount > 0 && imported == mesh->vertexCount;
+
+        mesh->positions = (struct vec3 *)realloc(mesh->positions, sizeof(struct vec3) * mesh->vertexCount);
+        mesh->normals = (struct vec3 *)realloc(mesh->normals, sizeof(struct vec3) * mesh->vertexCount);
+        mesh->uvs = (struct vec2 *)realloc(mesh->uvs, sizeof(struct vec2) * mesh->vertexCount);
+
+        free(vertexSource);
+        if (normalSum != normalSums) {
+                free(normalSum);
+        }
+
+        MeshBuildBVH(mesh, MESH_BVH_LEAF_SIZE);
+        if (flags & MESH_LOAD_MESHLETS) {
+                MeshBuildMeshlets(mesh, MESH_MESHLET_SIZE);
+        }
+        MeshOptimizeVertexCache(mesh);
+        MeshOptimizeVertexFetch(mesh);
+        MeshComputeFacePlanes(mesh);
+        MeshComputeBounds(mesh);
+        if (flags & MESH_LOAD_LODS) {
+                MeshBuildLODs(mesh);
+        }
+
+        return mesh;
+}
+
+//! \brief Load every part of a mesh from its cache files
+//!
+//! \param[in] objFile path to the obj file the cache was built from
+//! \param[in] flags bitwise or of MESH_LOAD_* flags
+//! \param[out] count number of parts loaded
+//! \return the parts, or NULL if any of them is missing, stale or malformed
+struct mesh **MeshInitFromObjCache(char *objFile, int flags, int *count) {
+        char *cacheFile = MeshCachePath(objFile, 0);
+        int partCount;
+        struct mesh *first = MeshInitFromCache(cacheFile, objFile, flags, &partCount);
+        free(cacheFile);
+        if (NULL == first) {
+                return NULL;
+        }
+
+        struct mesh **meshes = (struct mesh **)malloc(sizeof(struct mesh *) * partCount);
+        meshes[0] = first;
+        for (int i = 1; i < partCount; i++) {
+                int parts;
+                cacheFile = MeshCachePath(objFile, i);
+                meshes[i] = MeshInitFromCache(cacheFile, objFile, flags, &parts);
+                free(cacheFile);
+                if (NULL == meshes[i] || parts != partCount) {
+                        MeshDeinit(meshes[i]);
+                        for (int j = 0; j < i; j++) {
+                                MeshDeinit(meshes[j]);
+                        }
+                        free(meshes);
+                        return NULL;
+                }
+        }
+
+        *count = partCount;
+        return meshes;
+}
+
+struct mesh **MeshInitFromObj(char *objFile, int flags, struct job_system *jobs, int *count) {
+        if (flags & MESH_LOAD_CACHE) {
+                struct mesh **meshes = MeshInitFromObjCache(objFile, flags, count);
+                if (NULL != meshes) {
+                        return meshes;
+                }
+        }
+
+        struct obj *obj = ObjInit(objFile, jobs);
+        if (NULL == obj) {
+                return NULL;
+        }
+
+        // One part per material, in order of first use. partOf[m + 1] is
+        // the part of material m, where -1 is no material.
+        int *partOf = (int *)malloc(sizeof(int) * (obj->materialCount + 1));
+        int *partMaterials = (int *)malloc(sizeof(int) * (obj->materialCount + 1));
+        for (int m = 0; m <= obj->materialCount; m++) {
+                partOf[m] = -1;
+        }
+        int partCount = 0;
+        for (int t = 0; t < obj->triCount; t++) {
+                int m = obj->triMaterials[t];
+                if (-1 == partOf[m + 1]) {
+                        partOf[m + 1] = partCount;
+                        partMaterials[partCount++] = m;
+                }
+        }
+        if (0 == partCount) {
+                partMaterials[partCount++] = -1;
+        }
+
+        struct vec3 *normalSums = MeshObjNormalSums(obj);
+        struct mesh **meshes = (struct mesh **)malloc(sizeof(struct mesh *) * partCount);
+        for (int i = 0; i < partCount; i++) {
+                meshes[i] = MeshInitFromObjGroup(obj, obj->triMaterials, partMaterials[i], normalSums, flags);
+                if (partMaterials[i] >= 0) {
+                        meshes[i]->material = strdup(obj->materials[partMaterials[i]]);
+                }
+                if (NULL != obj->library) {
+                        meshes[i]->materialLibrary = strdup(obj->library);
+                }
+                if (flags & MESH_LOAD_CACHE) {
+                        char *cacheFile = MeshCachePath(objFile, i);
+                        MeshWriteCache(meshes[i], cacheFile, objFile, flags, partCount);
+                        free(cacheFile);
+                }
+                if (flags & MESH_LOAD_QUANTIZE) {
+                        MeshQuantize(meshes[i]);
+                }
+        }
+
+        free(normalSums);
+        free(partMaterials);
+        free(partOf);
+        ObjDeinit(obj);
+
+        *count = partCount;
+        return meshes;
+}
+
+//! \brief Where a level of detail's arrays are in a mesh cache file
+struct mesh_cache_lod {
+        uint64_t indices; //!< byte offset of the index array
+        uint64_t planes; //!< byte offset of the face plane array
+        int32_t triCount;
+        float error;
+};
+
+//! \brief The start of a mesh cache file
+//!
+//! Offsets are in bytes from the start of the file, and are multiples of
+//! MESH_CACHE_ALIGNMENT.
+struct mesh_cache_header {
+        uint32_t magic; //!< MESH_CACHE_MAGIC
+        uint32_t version; //!< MESH_CACHE_VERSION
+        uint32_t headerSize; //!< sizeof(struct mesh_cache_header), to catch layout differences
+        int32_t flags; //!< MESH_LOAD_* flags the mesh was built with
+        uint64_t fileSize; //!< size of the whole cache file
+        uint64_t sourceSize; //!< size of the source file, or 0
+        int64_t sourceTime; //!< modification time of the source file in nanoseconds, or 0
+
+        int32_t vertexCount;
+        int32_t triCount;
+        int32_t nodeCount;
+        int32_t meshletCount;
+        int32_t lodCount;
+        int32_t importedNormals; //!< struct mesh importedNormals
+
+        struct aabb bounds;
+        struct sphere sphere;
+
+        int32_t partCount; //!< number of meshes the source file was split into
+        uint64_t material; //!< NUL-terminated material name, or 0 for none
+        uint64_t materialLibrary; //!< NUL-terminated material library path, or 0 for none
+
+        uint64_t positions;
+        uint64_t normals;
+        uint64_t uvs;
+        uint64_t indices;
+        uint64_t planes;
+        uint64_t nodes;
+        uint64_t meshlets; //!< 0 if meshletCount is 0
+        struct mesh_cache_lod lods[MESH_MAX_LODS];
+};
+
+//! \brief Round offset up to the next multiple of MESH_CACHE_ALIGNMENT
+uint64_t MeshCacheAlign(uint64_t offset) {
+        return (offset + MESH_CACHE_ALIGNMENT - 1) & ~(uint64_t)(MESH_CACHE_ALIGNMENT - 1);
+}
+
+//! \brief Reserve room for an array in a mesh cache file
+//!
+//! \param[in,out] offset end of the file so far; moved past the array
+//! \param[in] size bytes in the array
+//! \return offset of the array
+uint64_t MeshCacheReserve(uint64_t *offset, uint64_t size) {
+        uint64_t start = MeshCacheAlign(*offset);
+        *offset = start + size;
+        return start;
+}
+
+//! \brief Size and modification time of a file
+//!
+//! \param[in] file path to the file
+//! \param[out] size size of the file in bytes
+//! \param[out] time modification time in nanoseconds
+//! \return 1 on success, otherwise 0
+int MeshCacheStat(char *file, uint64_t *size, int64_t *time) {
+        struct stat info;
+        if (0 != stat(file, &info)) {
+                return 0;
+        }
+        *size = (uint64_t)info.st_size;
+        *time = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+        return 1;
+}
+
+//! \brief Write an array into a mesh cache file at the given offset
+//!
+//! Pads with zeros from the current position up to offset.
+//!
+//! \param[in,out] file the file being written
+//! \param[in,out] position current offset in the file
+//! \param[in] offset where the array belongs
+//! \param[in] data the array
+//! \param[in] size bytes in the array
+//! \return 1 on success, otherwise 0
+int MeshCacheWriteArray(FILE *file, uint64_t *position, uint64_t offset, void *data, uint64_t size) {
+        static const char zeros[MESH_CACHE_ALIGNMENT] = { 0 };
+        if (fwrite(zeros, 1, offset - *position, file) != offset - *position) {
+                return 0;
+        }
+        if (size > 0 && fwrite(data, 1, size, file) != size) {
+                return 0;
+        }
+        *position = offset + size;
+        return 1;
+}
+
+char *MeshCachePath(char *objFile, int part) {
+        size_t length = strlen(objFile);
+        if (length >= 4 && 0 == strcmp(objFile + length - 4, ".obj")) {
+                length -= 4;
+        }
+
+        // Room for the part number, its dot and ".mesh".
+        size_t size = length + 16 + sizeof(".mesh");
+        char *path = (char *)malloc(size);
+        if (0 == part) {
+                snprintf(path, size, "%.*s.mesh", (int)length, objFile);
+        } else {
+                snprintf(path, size, "%.*s.%d.mesh", (int)length, objFile, part);
+        }
+        return path;
+}
+
+int MeshWriteCache(struct mesh *mesh, char *file, char *sourceFile, int flags, int partCount) {
+        struct mesh_cache_header header;
+        memset(&header, 0, sizeof(struct mesh_cache_header));
+        header.magic = MESH_CACHE_MAGIC;
+        header.version = MESH_CACHE_VERSION;
+        header.headerSize = sizeof(struct mesh_cache_header);
+        header.flags = flags & ~(MESH_LOAD_CACHE | MESH_LOAD_QUANTIZE);
+        if (NULL != mesh->packed) {
+                fprintf(stderr, "Can't cache quantized mesh %s\n", file);
+                return 0;
+        }
+        if (NULL != sourceFile && !MeshCacheStat(sourceFile, &header.sourceSize, &header.sourceTime)) {
+                fprintf(stderr, "Couldn't stat %s\n", sourceFile);
+                return 0;
+        }
+
+        header.vertexCount = mesh->vertexCount;
+        header.triCount = mesh->triCount;
+        header.nodeCount = mesh->nodeCount;
+        header.meshletCount = NULL != mesh->meshlets ? mesh->meshletCount : 0;
+        header.lodCount = mesh->lodCount;
+        header.importedNormals = mesh->importedNormals;
+        header.bounds = mesh->bounds;
+        header.sphere = mesh->sphere;
+        header.partCount = partCount;
+
+        uint64_t end = sizeof(struct mesh_cache_header);
+        if (NULL != mesh->material) {
+                header.material = MeshCacheReserve(&end, strlen(mesh->material) + 1);
+        }
+        if (NULL != mesh->materialLibrary) {
+                header.materialLibrary = MeshCacheReserve(&end, strlen(mesh->materialLibrary) + 1);
+        }
+        header.positions = MeshCacheReserve(&end, sizeof(struct vec3) * mesh->vertexCount);
+        header.normals = MeshCacheReserve(&end, sizeof(struct vec3) * mesh->vertexCount);
+        header.uvs = MeshCacheReserve(&end, sizeof(struct vec2) * mesh->vertexCount);
+        header.indices = MeshCacheReserve(&end, sizeof(unsigned int) * 3 * mesh->triCount);
+        header.planes = MeshCacheReserve(&end, sizeof(struct vec3) * mesh->triCount);
+        header.nodes = MeshCacheReserve(&end, sizeof(struct bvh_node) * mesh->nodeCount);
+        if (header.meshletCount > 0) {
+                header.meshlets = MeshCacheReserve(&end, sizeof(struct meshlet) * header.meshletCount);
+        }
+        for (int i = 0; i < mesh->lodCount; i++) {
+                struct mesh_lod *lod = &mesh->lods[i];
+                header.lods[i].indices = MeshCacheReserve(&end, sizeof(unsigned int) * 3 * lod->triCount);
+                header.lods[i].planes = MeshCacheReserve(&end, sizeof(struct vec3) * lod->triCount);
+                header.lods[i].triCount = lod->triCount;
+                header.lods[i].error = lod->error;
+        }
+        header.fileSize = end;
+
+        size_t length = strlen(file);
+        char *temporary = (char *)malloc(length + sizeof(".tmp"));
+        memcpy(temporary, file, length);
+        memcpy(temporary + length, ".tmp", sizeof(".tmp"));
+
+        FILE *out = fopen(temporary, "wb");
+        if (NULL == out) {
+                fprintf(stderr, "Couldn't create %s\n", temporary);
+                free(temporary);
+                return 0;
+        }
+
+        uint64_t position = 0;
+        int ok = MeshCacheWriteArray(out, &position, 0, &header, sizeof(struct mesh_cache_header));
+        if (NULL != mesh->material) {
+                ok = ok && MeshCacheWriteArray(out, &position, header.material, mesh->material, strlen(mesh->material) + 1);
+        }
+        if (NULL != mesh->materialLibrary) {
+                ok = ok && MeshCacheWriteArray(out, &position, header.materialLibrary, mesh->materialLibrary, strlen(mesh->materialLibrary) + 1);
+        }
+        ok = ok && MeshCacheWriteArray(out, &position, header.positions, mesh->positions, sizeof(struct vec3) * mesh->vertexCount);
+        ok = ok && MeshCacheWriteArray(out, &position, header.normals, mesh->normals, sizeof(struct vec3) * mesh->vertexCount);
+        ok = ok && MeshCacheWriteArray(out, &position, header.uvs, mesh->uvs, sizeof(struct vec2) * mesh->vertexCount);
+        ok = ok && MeshCacheWriteArray(out, &position, header.indices, mesh->indices, sizeof(unsigned int) * 3 * mesh->triCount);
+        ok = ok && MeshCacheWriteArray(out, &position, header.planes, mesh->planes, sizeof(struct vec3) * mesh->triCount);
+        ok = ok && MeshCacheWriteArray(out, &position, header.nodes, mesh->nodes, sizeof(struct bvh_node) * mesh->nodeCount);
+        if (header.meshletCount > 0) {
+                ok = ok && MeshCacheWriteArray(out, &position, header.meshlets, mesh->meshlets, sizeof(struct meshlet) * header.meshletCount);
+        }
+        for (int i = 0; i < mesh->lodCount; i++) {
+                struct mesh_lod *lod = &mesh->lods[i];
+                ok = ok && MeshCacheWriteArray(out, &position, header.lods[i].indices, lod->indices, sizeof(unsigned int) * 3 * lod->triCount);
+                ok = ok && MeshCacheWriteArray(out, &position, header.lods[i].planes, lod->planes, sizeof(struct vec3) * lod->triCount);
+        }
+        ok = (0 == fclose(out)) && ok;
+
+        if (!ok || 0 != rename(temporary, file)) {
+                fprintf(stderr, "Couldn't write %s\n", file);
+                remove(temporary);
+                free(temporary);
+                return 0;
+        }
+
+        free(temporary);
+        return 1;
+}
+
+//! \brief Whether an array lies within a mesh cache file
+//!
+//! \param[in] header the file's header
+//! \param[in] offset offset of the array
+//! \param[in] size bytes in the array
+//! \return 1 if the array is aligned and fits, otherwise 0
+int MeshCacheArrayValid(struct mesh_cache_header *header, uint64_t offset, uint64_t size) {
+        return 0 == offset % MESH_CACHE_ALIGNMENT && offset >= sizeof(struct mesh_cache_header) &&
+               offset <= header->fileSize && size <= header->fileSize - offset;
+}
+
+//! \brief Whether a string lies within a mesh cache file
+//!
+//! \param[in] header the file's header, which must be followed by the rest of the file
+//! \param[in] offset offset of the string, or 0 for none
+//! \return 1 if offset is 0 or the string is aligned and terminated within the file, otherwise 0
+int MeshCacheStringValid(struct mesh_cache_header *header, uint64_t offset) {
+        if (0 == offset) {
+                return 1;
+        }
+        if (!MeshCacheArrayValid(header, offset, 1)) {
+                return 0;
+        }
+        return NULL != memchr((char *)header + offset, '\0', header->fileSize - offset);
+}
+
+//! \brief Whether a mesh cache header describes a well-formed file of the given size
+//!
+//! \param[in] header the file's header
+//! \param[in] size the file's size
+//! \return 1 if every count is sane and every array fits, otherwise 0
+int MeshCacheHeaderValid(struct mesh_cache_header *header, uint64_t size) {
+        if (header->fileSize != size || header->partCount < 1 || header->vertexCount < 0 || header->triCount < 0 || header->nodeCount < 0 ||
+            header->meshletCount < 0 || header->lodCount < 0 || header->lodCount > MESH_MAX_LODS) {
+                return 0;
+        }
+
+        int valid = MeshCacheStringValid(header, header->material) && MeshCacheStringValid(header, header->materialLibrary);
+        valid &= MeshCacheArrayValid(header, header->positions, sizeof(struct vec3) * (uint64_t)header->vertexCount);
+        valid &= MeshCacheArrayValid(header, header->normals, sizeof(struct vec3) * (uint64_t)header->vertexCount);
+        valid &= MeshCacheArrayValid(header, header->uvs, sizeof(struct vec2) * (uint64_t)header->vertexCount);
+        valid &= MeshCacheArrayValid(header, header->indices, sizeof(unsigned int) * 3 * (uint64_t)header->triCount);
+        valid &= MeshCacheArrayValid(header, header->planes, sizeof(struct vec3) * (uint64_t)header->triCount);
+        valid &= MeshCacheArrayValid(header, header->nodes, sizeof(struct bvh_node) * (uint64_t)header->nodeCount);
+        if (header->meshletCount > 0) {
+                valid &= MeshCacheArrayValid(header, header->meshlets, sizeof(struct meshlet) * (uint64_t)header->meshletCount);
+        }
+        for (int i = 0; i < header->lodCount; i++) {
+                struct mesh_cache_lod *lod = &header->lods[i];
+                valid &= lod->triCount >= 0;
+                valid &= MeshCacheArrayValid(header, lod->indices, sizeof(unsigned int) * 3 * (uint64_t)lod->triCount);
+                valid &= MeshCacheArrayValid(header, lod->planes, sizeof(struct vec3) * (uint64_t)lod->triCount);
+        }
+        return valid;
+}
+
+//! \brief Whether every index in an index buffer names a vertex
+//!
+//! \param[in] indices 3 * triCount indices
+//! \param[in] triCount number of triangles
+//! \param[in] vertexCount number of vertices
+//! \return 1 if every index is below vertexCount, otherwise 0
+int MeshCacheIndicesValid(unsigned int *indices, int triCount, int vertexCount) {
+        for (int i = 0; i < triCount * 3; i++) {
+                if (indices[i] >= (unsigned int)vertexCount) {
+                        return 0;
+                }
+        }
+        return 1;
+}
+
+//! \brief Whether a range of triangles lies within a mesh
+//!
+//! \param[in] firstTri first triangle of the range
+//! \param[in] count number of triangles in the range
+//! \param[in] triCount number of triangles in the mesh
+//! \return 1 if the range fits, otherwise 0
+int MeshCacheRangeValid(int firstTri, int count, int triCount) {
+        return firstTri >= 0 && count >= 0 && firstTri <= triCount && count <= triCount - firstTri;
+}
+
+//! \brief Whether the arrays of a mesh mapped from a cache file are consistent
+//!
+//! MeshCacheHeaderValid() only checks that the arrays fit in the file. This
+//! checks what they hold, so that nothing drawing the mesh reads or writes
+//! out of bounds: every index names a vertex, the hierarchy is a tree whose
+//! children follow their parents and split their triangles between them,
+//! and meshlets are in order and within the mesh.
+//!
+//! \param[in] mesh the mapped mesh
+//! \return 1 if the mesh is safe to use, otherwise 0
+int MeshCacheContentsValid(struct mesh *mesh) {
+        if (!MeshCacheIndicesValid(mesh->indices, mesh->triCount, mesh->vertexCount)) {
+                return 0;
+        }
+        for (int i = 0; i < mesh->lodCount; i++) {
+                if (!MeshCacheIndicesValid(mesh->lods[i].indices, mesh->lods[i].triCount, mesh->vertexCount)) {
+                        return 0;
+                }
+        }
+
+        // MeshCullBVH() emits at most one range per node only if no node is
+        // reached twice, and the ranges only stay disjoint if children
+        // split their parent's triangles.
+        if (mesh->nodeCount > 0 && (0 != mesh->nodes[0].firstTri || mesh->triCount != mesh->nodes[0].triCount)) {
+                return 0;
+        }
+        unsigned char *reached = (unsigned char *)calloc(mesh->nodeCount > 0 ? mesh->nodeCount : 1, 1);
+        int tree = 1;
+        for (int n = 0; n < mesh->nodeCount && tree; n++) {
+                struct bvh_node *node = &mesh->nodes[n];
+                tree = MeshCacheRangeValid(node->firstTri, node->triCount, mesh->triCount);
+                if (!tree || 0 == node->left) {
+                        continue;
+                }
+                if (node->left <= n || node->left >= mesh->nodeCount - 1 || reached[node->left] || reached[node->left + 1]) {
+                        tree = 0;
+                        continue;
+                }
+                reached[node->left] = reached[node->left + 1] = 1;
+
+                struct bvh_node *left = &mesh->nodes[node->left];
+                struct bvh_node *right = &mesh->nodes[node->left + 1];
+                tree = left->triCount >= 0 && right->triCount >= 0 &&
+                       (int64_t)left->triCount + right->triCount == node->triCount &&
+                       left->firstTri == node->firstTri && right->firstTri == node->firstTri + left->triCount;
+        }
+        free(reached);
+        if (!tree) {
+                return 0;
+        }
+
+        // MeshCullMeshlets() emits each meshlet at most once only if they're
+        // sorted and don't overlap.
+        int end = 0;
+        for (int m = 0; m < mesh->meshletCount; m++) {
+                struct meshlet *meshlet = &mesh->meshlets[m];
+                if (!MeshCacheRangeValid(meshlet->firstTri, meshlet->triCount, mesh->triCount) || meshlet->firstTri < end) {
+                        return 0;
+                }
+                end = meshlet->firstTri + meshlet->triCount;
+        }
+        return 1;
+}
+
+struct mesh *MeshInitFromCache(char *file, char *sourceFile, int flags, int *partCount) {
+        int fd = open(file, O_RDONLY);
+        if (fd < 0) {
+                return NULL;
+        }
+
+        struct stat info;
+        if (0 != fstat(fd, &info) || (size_t)info.st_size < sizeof(struct mesh_cache_header)) {
+                close(fd);
+                return NULL;
+        }
+
+        // Mapped writable but private, so anything modifying the mesh in
+        // place gets its own copy of the touched pages.
+        size_t size = (size_t)info.st_size;
+        char *base = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (MAP_FAILED == base) {
+                return NULL;
+        }
+
+        struct mesh_cache_header *header = (struct mesh_cache_header *)base;
+        int valid = MESH_CACHE_MAGIC == header->magic && MESH_CACHE_VERSION == header->version &&
+                    sizeof(struct mesh_cache_header) == header->headerSize &&
+                    (flags & ~(MESH_LOAD_CACHE | MESH_LOAD_QUANTIZE)) == header->flags;
+        if (valid && NULL != sourceFile) {
+                uint64_t sourceSize;
+                int64_t sourceTime;
+                valid = MeshCacheStat(sourceFile, &sourceSize, &sourceTime) &&
+                        sourceSize == header->sourceSize && sourceTime == header->sourceTime;
+        }
+        if (valid && !MeshCacheHeaderValid(header, size)) {
+                fprintf(stderr, "Ignoring malformed mesh cache %s\n", file);
+                valid = 0;
+        }
+        if (!valid) {
+                munmap(base, size);
+                return NULL;
+        }
+
+        struct mesh *mesh = (struct mesh *)malloc(sizeof(struct mesh));
+        memset(mesh, 0, sizeof(struct mesh));
+
+        mesh->positions = (struct vec3 *)(base + header->positions);
+        mesh->normals = (struct vec3 *)(base + header->normals);
+        mesh->uvs = (struct vec2 *)(base + header->uvs);
+        mesh->vertexCount = header->vertexCount;
+
+        mesh->indices = (unsigned int *)(base + header->indices);
+        mesh->planes = (struct vec3 *)(base + header->planes);
+        mesh->triCount = header->triCount;
+
+        mesh->bounds = header->bounds;
+        mesh->sphere = header->sphere;
+
+        if (header->nodeCount > 0) {
+                mesh->nodes = (struct bvh_node *)(base + header->nodes);
+                mesh->nodeCount = header->nodeCount;
+        }
+
+        if (header->meshletCount > 0) {
+                mesh->meshlets = (struct meshlet *)(base + header->meshlets);
+                mesh->meshletCount = header->meshletCount;
+        }
+
+        for (int i = 0; i < header->lodCount; i++) {
+                mesh->lods[i].indices = (unsigned int *)(base + header->lods[i].indices);
+                mesh->lods[i].planes = (struct vec3 *)(base + header->lods[i].planes);
+                mesh->lods[i].triCount = header->lods[i].triCount;
+                mesh->lods[i].error = header->lods[i].error;
+        }
+        mesh->lodCount = header->lodCount;
+        mesh->importedNormals = 0 != header->importedNormals;
+
+        if (0 != header->material) {
+                mesh->material = base + header->material;
+        }
+        if (0 != header->materialLibrary) {
+                mesh->materialLibrary = base + header->materialLibrary;
+        }
+
+        mesh->mapping = base;
+        mesh->mappingSize = size;
+        if (!MeshCacheContentsValid(mesh)) {
+                fprintf(stderr, "Ignoring corrupt mesh cache %s\n", file);
+                MeshDeinit(mesh);
+                return NULL;
+        }
+        if (NULL != partCount) {
+                *partCount = header->partCount;
+        }
+        if (flags & MESH_LOAD_QUANTIZE) {
+                MeshQuantize(mesh);
+        }
+        return mesh;
+}
+
+void MeshDeinit(struct mesh *mesh) {
+        if (NULL == mesh) {
+                return;
+        }
+
+        free(mesh->packed);
+
+        if (NULL != mesh->mapping) {
+                munmap(mesh->mapping, mesh->mappingSize);
+                free(mesh);
+                return;
+        }
+
+        if (NULL != mesh->positions) {
+                free(mesh->positions);
+        }
+
+        if (NULL != mesh->normals) {
+                free(mesh->normals);
+        }
+
+        if (NULL != mesh->uvs) {
+                free(mesh->uvs);
+        }
+
+        if (NULL != mesh->indices) {
+                free(mesh->indices);
+        }
+
+        if (NULL != mesh->planes) {
+                free(mesh->planes);
+        }
+
+        if (NULL != mesh->nodes) {
+                free(mesh->nodes);
+        }
+
+        if (NULL != mesh->meshlets) {
+                free(mesh->meshlets);
+        }
+
+        for (int i = 0; i < mesh->lodCount; i++) {
+                free(mesh->lods[i].indices);
+                free(mesh->lods[i].planes);
+        }
+
+        free(mesh->material);
+        free(mesh->materialLibrary);
+        free(mesh);
+}
+
+void MeshOptimizeVertexCache(struct mesh *mesh) {
+        if (NULL == mesh->nodes && NULL == mesh->meshlets) {
+                OptimizeVertexCache(mesh->indices, mesh->triCount, mesh->vertexCount);
+                return;
+        }
+
+        // Optimize each meshlet or leaf on its own, renumbering its vertices
+        // densely so the work is proportional to the range rather than the
+        // whole mesh.
+        int rangeCount = mesh->meshlets ? mesh->meshletCount : mesh->nodeCount;
+        int maxTris = 0;
+        for (int r = 0; r < rangeCount; r++) {
+                int triCount = mesh->meshlets ? mesh->meshlets[r].triCount : mesh->nodes[r].triCount;
+                if ((mesh->meshlets || 0 == mesh->nodes[r].left) && triCount > maxTris) {
+                        maxTris = triCount;
+                }
+        }
+
+        unsigned int *localId = (unsigned int *)malloc(sizeof(unsigned int) * mesh->vertexCount);
+        memset(localId, 0xFF, sizeof(unsigned int) * mesh->vertexCount);
+        unsigned int *globalId = (unsigned int *)malloc(sizeof(unsigned int) * maxTris * 3);
+
+        for (int r = 0; r < rangeCount; r++) {
+                int firstTri, triCount;
+                if (mesh->meshlets) {
+                        firstTri = mesh->meshlets[r].firstTri;
+                        triCount = mesh->meshlets[r].triCount;
+                } else if (0 == mesh->nodes[r].left) {
+                        firstTri = mesh->nodes[r].firstTri;
+                        triCount = mesh->nodes[r].triCount;
+                } else {
+                        continue;
+                }
+
+                unsigned int *indices = &mesh->indices[firstTri * 3];
+                unsigned int numLocal = 0;
+                for (int i = 0; i < triCount * 3; i++) {
+                        unsigned int v = indices[i];
+                        if (UINT32_MAX == localId[v]) {
+                                localId[v] = numLocal;
+                                globalId[numLocal++] = v;
+                        }
+                        indices[i] = localId[v];
+                }
+
+                OptimizeVertexCache(indices, triCount, numLocal);
+
+                for (int i = 0; i < triCount * 3; i++) {
+                        indices[i] = globalId[indices[i]];
+                }
+                for (unsigned int i = 0; i < numLocal; i++) {
+                        localId[globalId[i]] = UINT32_MAX;
+                }
+        }
+
+        free(globalId);
+        free(localId);
+}
+
+//! \brief Grow box to contain point
+void AABBExtend(struct aabb *box, struct vec3 point) {
+        for (int a = 0; a < 3; a++) {
+                if (point.p[a] < box->min.p[a]) box->min.p[a] = point.p[a];
+                if (point.p[a] > box->max.p[a]) box->max.p[a] = point.p[a];
+        }
+}
+
+//! \brief An empty box that any AABBExtend() call will replace
+struct aabb AABBEmpty() {
+        struct aabb box;
+        box.min = Vec3Init(INFINITY, INFINITY, INFINITY);
+        box.max = Vec3Init(-INFINITY, -INFINITY, -INFINITY);
+        return box;
+}
+
+//! \brief Per-triangle data used while building a hierarchy
+//!
+//! Kept together and partitioned in place so each node's triangles are
+//! scanned sequentially.
+struct bvh_build_tri {
+        struct aabb bounds;
+        struct vec3 centroid;
+        int tri; //!< index of the triangle in the original index buffer
+};
+
+void MeshBuildBVH(struct mesh *mesh, int maxLeafTris) {
+        if (NULL != mesh->nodes) {
+                free(mesh->nodes);
+                mesh->nodes = NULL;
+                mesh->nodeCount = 0;
+        }
+        if (mesh->triCount <= 0) {
+                return;
+        }
+        if (maxLeafTris < 1) {
+                maxLeafTris = 1;
+        }
+
+        int triCount = mesh->triCount;
+        struct bvh_build_tri *tris = (struct bvh_build_tri *)malloc(sizeof(struct bvh_build_tri) * triCount);
+        for (int t = 0; t < triCount; t++) {
+                unsigned int *index = &mesh->indices[t * 3];
+                tris[t].bounds = AABBEmpty();
+                AABBExtend(&tris[t].bounds, mesh->positions[index[0]]);
+                AABBExtend(&tris[t].bounds, mesh->positions[index[1]]);
+                AABBExtend(&tris[t].bounds, mesh->positions[index[2]]);
+                struct vec3 sum = Vec3Add(mesh->positions[index[0]], mesh->positions[index[1]]);
+                tris[t].centroid = Vec3Divide(Vec3Add(sum, mesh->positions[index[2]]), 3.0f);
+                tris[t].tri = t;
+        }
+
+        // A binary tree with at most one triangle per leaf has 2n - 1 nodes.
+        int nodeCap = triCount * 2 - 1;
+        struct bvh_node *nodes = (struct bvh_node *)malloc(sizeof(struct bvh_node) * nodeCap);
+        int nodeCount = 1;
+        nodes[0].firstTri = 0;
+        nodes[0].triCount = triCount;
+        nodes[0].left = 0;
+
+        // Depth is bounded by the triangle count in the degenerate case, so
+        // the stack is sized the same way.
+        int *stack = (int *)malloc(sizeof(int) * nodeCap);
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+                struct bvh_node *node = &nodes[stack[--stackSize]];
+                int first = node->firstTri;
+                int count = node->triCount;
+
+                struct aabb bounds = AABBEmpty();
+                struct aabb centroidBounds = AABBEmpty();
+                for (int i = first; i < first + count; i++) {
+                        AABBExtend(&bounds, tris[i].bounds.min);
+                        AABBExtend(&bounds, tris[i].bounds.max);
+                        AABBExtend(&centroidBounds, tris[i].centroid);
+                }
+                node->bounds = bounds;
+
+                if (count <= maxLeafTris) {
+                        continue;
+                }
+
+                // Split at the midpoint of the widest centroid axis.
+                int axis = 0;
+                struct vec3 extent = Vec3Subtract(centroidBounds.max, centroidBounds.min);
+                if (extent.y > extent.p[axis]) axis = 1;
+                if (extent.z > extent.p[axis]) axis = 2;
+                float split = (centroidBounds.min.p[axis] + centroidBounds.max.p[axis]) * 0.5f;
+
+                int lo = first;
+                int hi = first + count - 1;
+                while (lo <= hi) {
+                        if (tris[lo].centroid.p[axis] < split) {
+                                lo++;
+                        } else {
+                                struct bvh_build_tri tmp = tris[lo];
+                                tris[lo] = tris[hi];
+                                tris[hi] = tmp;
+                                hi--;
+                        }
+                }
+
+                // Every centroid landed on one side, e.g. coincident
+                // centroids. Any split is as good as another, so halve it.
+                int leftCount = lo - first;
+                if (0 == leftCount || count == leftCount) {
+                        leftCount = count / 2;
+                }
+
+                int left = nodeCount;
+                nodeCount += 2;
+                node->left = left;
+
+                nodes[left].firstTri = first;
+                nodes[left].triCount = leftCount;
+                nodes[left].left = 0;
+                nodes[left + 1].firstTri = first + leftCount;
+                nodes[left + 1].triCount = count - leftCount;
+                nodes[left + 1].left = 0;
+
+                stack[stackSize++] = left + 1;
+                stack[stackSize++] = left;
+        }
+
+        // Lay the triangles out in hierarchy order.
+        unsigned int *indices = (unsigned int *)malloc(sizeof(unsigned int) * 3 * triCount);
+        for (int i = 0; i < triCount; i++) {
+                memcpy(&indices[i * 3], &mesh->indices[tris[i].tri * 3], sizeof(unsigned int) * 3);
+        }
+        free(mesh->indices);
+        mesh->indices = indices;
+
+        if (NULL != mesh->planes) {
+                struct vec3 *planes = (struct vec3 *)malloc(sizeof(struct vec3) * triCount);
+                for (int i = 0; i < triCount; i++) {
+                        planes[i] = mesh->planes[tris[i].tri];
+                }
+                free(mesh->planes);
+                mesh->planes = planes;
+        }
+
+        mesh->nodes = (struct bvh_node *)realloc(nodes, sizeof(struct bvh_node) * nodeCount);
+        mesh->nodeCount = nodeCount;
+
+        free(stack);
+        free(tris);
+}
+
+int MeshCullBVH(struct mesh *mesh, struct frustum *frustum, struct mesh_range *ranges) {
+        if (NULL == mesh->nodes) {
+                ranges[0].firstTri = 0;
+                ranges[0].triCount = mesh->triCount;
+                ranges[0].inside = 0;
+                return 1;
+        }
+
+        int rangeCount = 0;
+        int stack[64];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+                struct bvh_node *node = &mesh->nodes[stack[--stackSize]];
+
+                int visibility = FrustumTestAABB(frustum, node->bounds);
+                if (FRUSTUM_OUTSIDE == visibility) {
+                        continue;
+                }
+
+                int inside = FRUSTUM_INSIDE == visibility;
+                if (inside || 0 == node->left) {
+                        // Merge with the previous range when they're adjacent.
+                        struct mesh_range *last = rangeCount > 0 ? &ranges[rangeCount - 1] : NULL;
+                        if (NULL != last && last->inside == inside &&
+                            last->firstTri + last->triCount == node->firstTri) {
+                                last->triCount += node->triCount;
+                        } else {
+                                ranges[rangeCount].firstTri = node->firstTri;
+                                ranges[rangeCount].triCount = node->triCount;
+                                ranges[rangeCount].inside = inside;
+                                rangeCount++;
+                        }
+                        continue;
+                }
+
+                // Midpoint splits of n triangles are at most n levels deep,
+                // but each level halves the centroid extent, so float
+                // precision runs out long before the stack does.
+                if (stackSize + 2 > (int)(sizeof(stack) / sizeof(stack[0]))) {
+                        ranges[rangeCount].firstTri = node->firstTri;
+                        ranges[rangeCount].triCount = node->triCount;
+                        ranges[rangeCount].inside = 0;
+                        rangeCount++;
+                        continue;
+                }
+                stack[stackSize++] = node->left + 1;
+                stack[stackSize++] = node->left;
+        }
+
+        return rangeCount;
+}
+
+//! \brief Unit normal of the triangle made by three indices, or zero if it's degenerate
+struct vec3 FaceNormal(struct mesh *mesh, unsigned int *index) {
+        struct vec3 line1 = Vec3Subtract(mesh->positions[index[1]], mesh->positions[index[0]]);
+        struct vec3 line2 = Vec3Subtract(mesh->positions[index[2]], mesh->positions[index[0]]);
+        struct vec3 normal = Vec3CrossProduct(line1, line2);
+        if (0.0f == Vec3DotProduct(normal, normal)) {
+                return (struct vec3){ 0 };
+        }
+        normal = Vec3Normalize(normal);
+        normal.w = 0.0f;
+        return normal;
+}
+
+//! \brief Compute the bounding sphere and normal cone of a meshlet
+void MeshletComputeBounds(struct mesh *mesh, struct meshlet *meshlet) {
+        unsigned int *indices = &mesh->indices[meshlet->firstTri * 3];
+
+        struct aabb box = AABBEmpty();
+        for (int i = 0; i < meshlet->triCount * 3; i++) {
+                AABBExtend(&box, mesh->positions[indices[i]]);
+        }
+        struct vec3 center = Vec3Multiply(Vec3Add(box.min, box.max), 0.5f);
+        float radius = 0.0f;
+        for (int i = 0; i < meshlet->triCount * 3; i++) {
+                struct vec3 offset = Vec3Subtract(mesh->positions[indices[i]], center);
+                float dist = sqrtf(Vec3DotProduct(offset, offset));
+                if (dist > radius) {
+                        radius = dist;
+                }
+        }
+        meshlet->sphere.center = center;
+        meshlet->sphere.center.w = 1.0f;
+        meshlet->sphere.radius = radius;
+
+        // The cone axis is the average face normal, and the cutoff is the sine
+        // of the widest angle between it and any face normal. Cones wider than
+        // about 84 degrees get a cutoff of 1, which never culls.
+        struct vec3 axis = { 0 };
+        for (int t = 0; t < meshlet->triCount; t++) {
+                axis = Vec3Add(axis, FaceNormal(mesh, &indices[t * 3]));
+        }
+        axis.w = 0.0f;
+
+        float cutoff = 1.0f;
+        if (0.0f != Vec3DotProduct(axis, axis)) {
+                axis = Vec3Normalize(axis);
+                axis.w = 0.0f;
+                float minDot = 1.0f;
+                for (int t = 0; t < meshlet->triCount; t++) {
+                        struct vec3 normal = FaceNormal(mesh, &indices[t * 3]);
+                        if (0.0f == Vec3DotProduct(normal, normal)) {
+                                continue;
+                        }
+                        float dp = Vec3DotProduct(normal, axis);
+                        if (dp < minDot) {
+                                minDot = dp;
+                        }
+                }
+                if (minDot > 0.1f) {
+                        cutoff = sqrtf(1.0f - minDot * minDot);
+                }
+        }
+        meshlet->cone = axis;
+        meshlet->cone.w = cutoff;
+}
+
+//! \brief qsort comparison putting meshlets in index buffer order
+int MeshletCompareFn(const void *a, const void *b) {
+        const struct meshlet *left = (const struct meshlet *)a;
+        const struct meshlet *right = (const struct meshlet *)b;
+        return left->firstTri - right->firstTri;
+}
+
+void MeshBuildMeshlets(struct mesh *mesh, int maxTris) {
+        if (NULL != mesh->meshlets) {
+                free(mesh->meshlets);
+                mesh->meshlets = NULL;
+                mesh->meshletCount = 0;
+        }
+        if (NULL == mesh->nodes) {
+                MeshBuildBVH(mesh, MESH_BVH_LEAF_SIZE);
+        }
+        if (NULL == mesh->nodes) {
+                return;
+        }
+        if (maxTris < 1) {
+                maxTris = 1;
+        }
+
+        int maxLeafTris = 0;
+        int meshletCap = 0;
+        for (int n = 0; n < mesh->nodeCount; n++) {
+                struct bvh_node *node = &mesh->nodes[n];
+                if (0 == node->left) {
+                        meshletCap += node->triCount;
+                        if (node->triCount > maxLeafTris) {
+                                maxLeafTris = node->triCount;
+                        }
+                }
+        }
+
+        // Worst case every triangle is its own meshlet.
+        struct meshlet *meshlets = (struct meshlet *)malloc(sizeof(struct meshlet) * meshletCap);
+        int meshletCount = 0;
+
+        // inMeshlet[v] is the meshlet the vertex was last added to, plus one.
+        int *inMeshlet = (int *)calloc(mesh->vertexCount, sizeof(int));
+        struct vec3 *normals = (struct vec3 *)malloc(sizeof(struct vec3) * maxLeafTris);
+        unsigned int *sorted = (unsigned int *)malloc(sizeof(unsigned int) * maxLeafTris * 3);
+        unsigned char *assigned = (unsigned char *)malloc(maxLeafTris);
+
+        for (int n = 0; n < mesh->nodeCount; n++) {
+                struct bvh_node *node = &mesh->nodes[n];
+                if (0 != node->left) {
+                        continue;
+                }
+
+                unsigned int *indices = &mesh->indices[node->firstTri * 3];
+                int count = node->triCount;
+                for (int t = 0; t < count; t++) {
+                        normals[t] = FaceNormal(mesh, &indices[t * 3]);
+                        assigned[t] = 0;
+                }
+
+                int numSorted = 0;
+                int seed = 0;
+                while (numSorted < count) {
+                        while (assigned[seed]) {
+                                seed++;
+                        }
+
+                        struct meshlet *meshlet = &meshlets[meshletCount++];
+                        meshlet->firstTri = node->firstTri + numSorted;
+                        meshlet->triCount = 0;
+                        struct vec3 axis = { 0 };
+
+                        int next = seed;
+                        while (next >= 0) {
+                                unsigned int *tri = &indices[next * 3];
+                                memcpy(&sorted[numSorted * 3], tri, sizeof(unsigned int) * 3);
+                                numSorted++;
+                                assigned[next] = 1;
+                                meshlet->triCount++;
+                                for (int c = 0; c < 3; c++) {
+                                        inMeshlet[tri[c]] = meshletCount;
+                                }
+                                axis = Vec3Add(axis, normals[next]);
+
+                                if (meshlet->triCount >= maxTris) {
+                                        break;
+                                }
+
+                                // Pick the unassigned triangle sharing the most
+                                // vertices with the meshlet, breaking ties by
+                                // how closely it faces the meshlet's average.
+                                next = -1;
+                                float bestScore = -INFINITY;
+                                for (int t = seed; t < count; t++) {
+                                        if (assigned[t]) {
+                                                continue;
+                                        }
+                                        unsigned int *cand = &indices[t * 3];
+                                        int shared = (inMeshlet[cand[0]] == meshletCount) +
+                                                (inMeshlet[cand[1]] == meshletCount) +
+                                                (inMeshlet[cand[2]] == meshletCount);
+                                        float score = (float)shared * 2.0f + Vec3DotProduct(normals[t], axis) / (float)meshlet->triCount;
+                                        if (score > bestScore) {
+                                                bestScore = score;
+                                                next = t;
+                                        }
+                                }
+                        }
+                }
+
+                memcpy(indices, sorted, sizeof(unsigned int) * 3 * count);
+        }
+
+        // Leaves aren't stored in triangle order, so neither are the meshlets
+        // built from them.
+        qsort(meshlets, meshletCount, sizeof(struct meshlet), MeshletCompareFn);
+
+        for (int m = 0; m < meshletCount; m++) {
+                MeshletComputeBounds(mesh, &meshlets[m]);
+        }
+
+        // Triangles only moved within their leaf, so face planes computed
+        // before this call are stale.
+        if (NULL != mesh->planes) {
+                MeshComputeFacePlanes(mesh);
+        }
+
+        mesh->meshlets = (struct meshlet *)realloc(meshlets, sizeof(struct meshlet) * meshletCount);
+        mesh->meshletCount = meshletCount;
+
+        free(assigned);
+        free(sorted);
+        free(normals);
+        free(inMeshlet);
+}
+
+int MeshCullMeshlets(struct mesh *mesh, struct frustum *frustum, struct vec3 camera, struct mesh_range *ranges, int rangeCount, struct mesh_range *out) {
+        if (NULL == mesh->meshlets) {
+                memcpy(out, ranges, sizeof(struct mesh_range) * rangeCount);
+                return rangeCount;
+        }
+
+        int outCount = 0;
+        for (int r = 0; r < rangeCount; r++) {
+                // Meshlets never straddle a leaf, so ranges start on a meshlet.
+                int lo = 0;
+                int hi = mesh->meshletCount - 1;
+                while (lo < hi) {
+                        int mid = (lo + hi) / 2;
+                        if (mesh->meshlets[mid].firstTri < ranges[r].firstTri) {
+                                lo = mid + 1;
+                        } else {
+                                hi = mid;
+                        }
+                }
+
+                int end = ranges[r].firstTri + ranges[r].triCount;
+                for (int m = lo; m < mesh->meshletCount && mesh->meshlets[m].firstTri < end; m++) {
+                        struct meshlet *meshlet = &mesh->meshlets[m];
+
+                        struct vec3 toCenter = Vec3Subtract(meshlet->sphere.center, camera);
+                        float distance = sqrtf(Vec3DotProduct(toCenter, toCenter));
+                        if (Vec3DotProduct(toCenter, meshlet->cone) >= meshlet->cone.w * distance + meshlet->sphere.radius) {
+                                continue;
+                        }
+
+                        int inside = ranges[r].inside;
+                        if (!inside) {
+                                int visibility = FrustumTestSphere(frustum, meshlet->sphere);
+                                if (FRUSTUM_OUTSIDE == visibility) {
+                                        continue;
+                                }
+                                inside = FRUSTUM_INSIDE == visibility;
+                        }
+
+                        struct mesh_range *last = outCount > 0 ? &out[outCount - 1] : NULL;
+                        if (NULL != last && last->inside == inside &&
+                            last->firstTri + last->triCount == meshlet->firstTri) {
+                                last->triCount += meshlet->triCount;
+                        } else {
+                                out[outCount].firstTri = meshlet->firstTri;
+                                out[outCount].triCount = meshlet->triCount;
+                                out[outCount].inside = inside;
+                                outCount++;
+                        }
+                }
+        }
+
+        return outCount;
+}
+
+void MeshOptimizeVertexFetch(struct mesh *mesh) {
+        unsigned int *remap = (unsigned int *)malloc(sizeof(unsigned int) * mesh->vertexCount);
+        memset(remap, 0xFF, sizeof(unsigned int) * mesh->vertexCount);
+
+        // Number vertices in the order the index buffer first touches them.
+        unsigned int next = 0;
+        for (int i = 0; i < mesh->triCount * 3; i++) {
+                unsigned int v = mesh->indices[i];
+                if (UINT32_MAX == remap[v]) {
+                        remap[v] = next++;
+                }
+                mesh->indices[i] = remap[v];
+        }
+
+        // Unreferenced vertices keep their relative order at the end.
+        for (int v = 0; v < mesh->vertexCount; v++) {
+                if (UINT32_MAX == remap[v]) {
+                        remap[v] = next++;
+                }
+        }
+
+        struct vec3 *positions = (struct vec3 *)malloc(sizeof(struct vec3) * mesh->vertexCount);
+        struct vec3 *normals = (struct vec3 *)malloc(sizeof(struct vec3) * mesh->vertexCount);
+        struct vec2 *uvs = (struct vec2 *)malloc(sizeof(struct vec2) * mesh->vertexCount);
+        for (int v = 0; v < mesh->vertexCount; v++) {
+                positions[remap[v]] = mesh->positions[v];
+                normals[remap[v]] = mesh->normals[v];
+                uvs[remap[v]] = mesh->uvs[v];
+        }
+
+        free(mesh->positions);
+        free(mesh->normals);
+        free(mesh->uvs);
+        mesh->positions = positions;
+        mesh->normals = normals;
+        mesh->uvs = uvs;
+
+        free(remap);
+}
+
+float MeshACMR(struct mesh *mesh, int cacheSize) {
+        if (0 == mesh->triCount) {
+                return 0.0f;
+        }
+
+        // FIFO cache simulation: a vertex is cached if fewer than cacheSize
+        // misses have happened since it was last loaded.
+        unsigned int *loadedAt = (unsigned int *)calloc(mesh->vertexCount, sizeof(unsigned int));
+        unsigned int misses = 0;
+        for (int i = 0; i < mesh->triCount * 3; i++) {
+                unsigned int v = mesh->indices[i];
+                if (0 == loadedAt[v] || misses - loadedAt[v] >= (unsigned int)cacheSize) {
+                        misses++;
+                        loadedAt[v] = misses;
+                }
+        }
+        free(loadedAt);
+
+        return (float)misses / (float)mesh->triCount;
+}
+
+//! \brief Compute the plane of every triangle in an index buffer
+//!
+//! \see MeshComputeFacePlanes()
+void ComputeFacePlanes(struct vec3 *positions, unsigned int *indices, int triCount, struct vec3 *planes) {
+        for (int i = 0; i < triCount; i++) {
+                unsigned int *index = &indices[i * 3];
+                struct vec3 v0 = positions[index[0]];
+                struct vec3 line1 = Vec3Subtract(positions[index[1]], v0);
+                struct vec3 line2 = Vec3Subtract(positions[index[2]], v0);
+                struct vec3 normal = Vec3CrossProduct(line1, line2);
+
+                // Degenerate faces get a zero plane, which is never front facing.
+                struct vec3 plane = { 0 };
+                if (0.0f != Vec3DotProduct(normal, normal)) {
+                        plane = Vec3Normalize(normal);
+                        plane.w = -Vec3DotProduct(plane, v0);
+                }
+                planes[i] = plane;
+        }
+}
+
+//! \brief Give back the whole pages of a mapped array that's no longer read
+//!
+//! The mapping is private, so the pages are dropped rather than written
+//! back, and would be read from the file again if touched.
+//!
+//! \param[in] start first byte of the array
+//! \param[in] size bytes in the array
+void MeshReleaseMapped(void *start, size_t size) {
+        uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+        uintptr_t first = ((uintptr_t)start + page - 1) & ~(page - 1);
+        uintptr_t last = ((uintptr_t)start + size) & ~(page - 1);
+        if (last > first) {
+                madvise((void *)first, last - first, MADV_DONTNEED);
+        }
+}
+
+//! \brief Pack a value into 16 bits
+//!
+//! \param[in] value the value to pack
+//! \param[in] min the value packed as 0
+//! \param[in] scale value units per step
+//! \return the nearest step, clamped to [0, 65535]
+unsigned short MeshPackUnit16(float value, float min, float scale) {
+        float steps = 0.0f < scale ? (value - min) / scale + 0.5f : 0.0f;
+        steps = steps < 0.0f ? 0.0f : (steps > 65535.0f ? 65535.0f : steps);
+        return (unsigned short)steps;
+}
+
+//! \brief Pack a component of an octahedral encoded normal into 8 bits
+//!
+//! \param[in] value the component, in [-1, 1]
+//! \return the nearest of 255 evenly spaced steps
+signed char MeshPackSnorm8(float value) {
+        value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+        return (signed char)lroundf(value * 127.0f);
+}
+
+void MeshQuantize(struct mesh *mesh) {
+        if (NULL != mesh->packed || NULL == mesh->positions) {
+                return;
+        }
+
+        struct vec3 min = mesh->bounds.min;
+        struct vec3 extent = Vec3Subtract(mesh->bounds.max, min);
+        mesh->packScale = Vec3Init(extent.x / 65535.0f, extent.y / 65535.0f, extent.z / 65535.0f);
+        mesh->packScale.w = 0.0f;
+
+        struct vec2 uvMax;
+        memset(&uvMax, 0, sizeof(struct vec2));
+        memset(&mesh->uvMin, 0, sizeof(struct vec2));
+        for (int i = 0; i < mesh->vertexCount; i++) {
+                struct vec2 uv = mesh->uvs[i];
+                if (0 == i || uv.u < mesh->uvMin.u) mesh->uvMin.u = uv.u;
+                if (0 == i || uv.v < mesh->uvMin.v) mesh->uvMin.v = uv.v;
+                if (0 == i || uv.u > uvMax.u) uvMax.u = uv.u;
+                if (0 == i || uv.v > uvMax.v) uvMax.v = uv.v;
+        }
+        mesh->uvMin.w = 1.0f;
+        mesh->uvScale.u = (uvMax.u - mesh->uvMin.u) / 65535.0f;
+        mesh->uvScale.v = (uvMax.v - mesh->uvMin.v) / 65535.0f;
+        mesh->uvScale.w = 0.0f;
+
+        mesh->packed = (struct mesh_vertex *)malloc(sizeof(struct mesh_vertex) * (mesh->vertexCount > 0 ? mesh->vertexCount : 1));
+        for (int i = 0; i < mesh->vertexCount; i++) {
+                struct mesh_vertex *vertex = &mesh->packed[i];
+                struct vec3 p = mesh->positions[i];
+                vertex->position[0] = MeshPackUnit16(p.x, min.x, mesh->packScale.x);
+                vertex->position[1] = MeshPackUnit16(p.y, min.y, mesh->packScale.y);
+                vertex->position[2] = MeshPackUnit16(p.z, min.z, mesh->packScale.z);
+                vertex->uv[0] = MeshPackUnit16(mesh->uvs[i].u, mesh->uvMin.u, mesh->uvScale.u);
+                vertex->uv[1] = MeshPackUnit16(mesh->uvs[i].v, mesh->uvMin.v, mesh->uvScale.v);
+
+                // Project onto the octahedron |x| + |y| + |z| = 1 and fold
+                // the lower half over the upper one.
+                struct vec3 n = mesh->normals[i];
+                float sum = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+                float x = 0.0f < sum ? n.x / sum : 0.0f;
+                float y = 0.0f < sum ? n.y / sum : 0.0f;
+                if (n.z < 0.0f) {
+                        float folded = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+                        y = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+                        x = folded;
+                }
+                vertex->normal[0] = MeshPackSnorm8(x);
+                vertex->normal[1] = MeshPackSnorm8(y);
+        }
+
+        if (NULL != mesh->mapping) {
+                MeshReleaseMapped(mesh->positions, sizeof(struct vec3) * mesh->vertexCount);
+                MeshReleaseMapped(mesh->normals, sizeof(struct vec3) * mesh->vertexCount);
+                MeshReleaseMapped(mesh->uvs, sizeof(struct vec2) * mesh->vertexCount);
+        } else {
+                free(mesh->positions);
+                free(mesh->normals);
+                free(mesh->uvs);
+        }
+        mesh->positions = NULL;
+        mesh->normals = NULL;
+        mesh->uvs = NULL;
+}
+
+struct mat4x4 MeshUnpackMatrix(struct mesh *mesh) {
+        struct mat4x4 mat = Mat4x4Translate(mesh->bounds.min.x, mesh->bounds.min.y, mesh->bounds.min.z);
+        mat.m[0][0] = mesh->packScale.x;
+        mat.m[1][1] = mesh->packScale.y;
+        mat.m[2][2] = mesh->packScale.z;
+        return mat;
+}
+
+struct vec3 MeshUnpackNormal(struct mesh_vertex *vertex) {
+        float x = (float)vertex->normal[0] / 127.0f;
+        float y = (float)vertex->normal[1] / 127.0f;
+        float z = 1.0f - fabsf(x) - fabsf(y);
+        if (z < 0.0f) {
+                float unfolded = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+                y = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+                x = unfolded;
+        }
+        struct vec3 normal = Vec3Normalize(Vec3Init(x, y, z));
+        normal.w = 0.0f;
+        return normal;
+}
+
+struct vec2 MeshUnpackUV(struct mesh *mesh, struct mesh_vertex *vertex) {
+        struct vec2 uv;
+        uv.u = mesh->uvMin.u + (float)vertex->uv[0] * mesh->uvScale.u;
+        uv.v = mesh->uvMin.v + (float)vertex->uv[1] * mesh->uvScale.v;
+        uv.w = 1.0f;
+        return uv;
+}
+
+void MeshComputeFacePlanes(struct mesh *mesh) {
+        ComputeFacePlanes(mesh->positions, mesh->indices, mesh->triCount, mesh->planes);
+}
+
+//! \brief Symmetric 4x4 error quadric; the upper triangle stored row by row
+struct quadric {
+        double a[10];
+};
+
+//! \brief Accumulate the squared distance to a plane into a quadric
+void QuadricAddPlane(struct quadric *q, struct vec3 plane) {
+        double a = plane.x, b = plane.y, c = plane.z, d = plane.w;
+        q->a[0] += a * a; q->a[1] += a * b; q->a[2] += a * c; q->a[3] += a * d;
+        q->a[4] += b * b; q->a[5] += b * c; q->a[6] += b * d;
+        q->a[7] += c * c; q->a[8] += c * d;
+        q->a[9] += d * d;
+}
+
+//! \brief Accumulate one quadric into another
+void QuadricAdd(struct quadric *q, struct quadric *other) {
+        for (int i = 0; i < 10; i++) {
+                q->a[i] += other->a[i];
+        }
+}
+
+//! \brief Sum of squared distances from point to every plane in the quadric
+double QuadricError(struct quadric *q, struct vec3 point) {
+        double x = point.x, y = point.y, z = point.z;
+        double err =
+                q->a[0] * x * x + 2 * q->a[1] * x * y + 2 * q->a[2] * x * z + 2 * q->a[3] * x +
+                q->a[4] * y * y + 2 * q->a[5] * y * z + 2 * q->a[6] * y +
+                q->a[7] * z * z + 2 * q->a[8] * z +
+                q->a[9];
+        return err > 0 ? err : 0;
+}
+
+//! \brief A candidate edge collapse moving vertex from onto vertex to
+struct edge_collapse {
+        float cost;
+        unsigned int from;
+        unsigned int to;
+};
+
+//! \brief qsort comparison putting the cheapest collapse first
+int EdgeCollapseCompareFn(const void *a, const void *b) {
+        float left = ((const struct edge_collapse *)a)->cost;
+        float right = ((const struct edge_collapse *)b)->cost;
+        return (left > right) - (left < right);
+}
+
+//! \brief qsort comparison for 64-bit keys
+int Uint64CompareFn(const void *a, const void *b) {
+        uint64_t left = *(const uint64_t *)a;
+        uint64_t right = *(const uint64_t *)b;
+        return (left > right) - (left < right);
+}
+
+//! \brief Mark every vertex on an edge not shared by exactly two triangles
+//!
+//! Vertices are split along UV seams, so seams show up here as open edges
+//! just like mesh borders do.
+void LockBorderVertices(unsigned int *indices, int triCount, unsigned char *locked) {
+        uint64_t *edges = (uint64_t *)malloc(sizeof(uint64_t) * triCount * 3);
+        for (int t = 0; t < triCount; t++) {
+                for (int e = 0; e < 3; e++) {
+                        uint64_t a = indices[t * 3 + e];
+                        uint64_t b = indices[t * 3 + (e + 1) % 3];
+                        edges[t * 3 + e] = a < b ? (a << 32) | b : (b << 32) | a;
+                }
+        }
+        qsort(edges, triCount * 3, sizeof(uint64_t), Uint64CompareFn);
+
+        for (int i = 0; i < triCount * 3;) {
+                int run = 1;
+                while (i + run < triCount * 3 && edges[i + run] == edges[i]) {
+                        run++;
+                }
+                if (2 != run) {
+                        locked[edges[i] >> 32] = 1;
+                        locked[edges[i] & 0xFFFFFFFF] = 1;
+                }
+                i += run;
+        }
+
+        free(edges);
+}
+
+//! \brief Whether moving vertex from onto vertex to keeps every remaining face's orientation
+//!
+//! \param[in] adjacent the triangles using vertex from
+//! \param[in] adjacentCount number of entries in adjacent
+int CollapseKeepsOrientation(struct mesh *mesh, unsigned int *indices, int *adjacent, int adjacentCount, unsigned int from, unsigned int to) {
+        for (int i = 0; i < adjacentCount; i++) {
+                unsigned int *tri = &indices[adjacent[i] * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to) {
+                        continue; // This triangle collapses away.
+                }
+
+                struct vec3 before[3], after[3];
+                for (int c = 0; c < 3; c++) {
+                        before[c] = mesh->positions[tri[c]];
+                        after[c] = tri[c] == from ? mesh->positions[to] : before[c];
+                }
+                struct vec3 normalBefore = Vec3CrossProduct(Vec3Subtract(before[1], before[0]), Vec3Subtract(before[2], before[0]));
+                struct vec3 normalAfter = Vec3CrossProduct(Vec3Subtract(after[1], after[0]), Vec3Subtract(after[2], after[0]));
+                if (Vec3DotProduct(normalBefore, normalAfter) <= 0.0f) {
+                        return 0;
+                }
+        }
+        return 1;
+}
+
+//! \brief Collapse edges of an index buffer until it has no more than targetTris triangles
+//!
+//! Works in passes. Each pass sorts every candidate collapse by quadric error
+//! and applies the cheapest ones that don't touch a vertex already affected
+//! in the same pass.
+//!
+//! \param[in] mesh supplies vertex positions
+//! \param[in,out] indices index buffer to simplify in place
+//! \param[in] triCount triangles in indices
+//! \param[in] targetTris triangle count to stop at
+//! \param[in,out] quadrics per-vertex error quadrics, merged as vertices collapse
+//! \param[in] locked per-vertex flags for vertices that mustn't move
+//! \param[in,out] maxCost largest collapse cost so far
+//! \return the number of triangles left in indices
+int SimplifyIndices(struct mesh *mesh, unsigned int *indices, int triCount, int targetTris, struct quadric *quadrics, unsigned char *locked, double *maxCost) {
+        int vertexCount = mesh->vertexCount;
+        int *adjOffset = (int *)malloc(sizeof(int) * (vertexCount + 1));
+        int *adjCursor = (int *)malloc(sizeof(int) * vertexCount);
+        int *adjTris = (int *)malloc(sizeof(int) * triCount * 3);
+        unsigned int *remap = (unsigned int *)malloc(sizeof(unsigned int) * vertexCount);
+        unsigned char *touched = (unsigned char *)malloc(vertexCount);
+        struct edge_collapse *collapses = (struct edge_collapse *)malloc(sizeof(struct edge_collapse) * triCount * 6);
+
+        while (triCount > targetTris) {
+                // Which triangles use each vertex.
+                memset(adjOffset, 0, sizeof(int) * (vertexCount + 1));
+                for (int i = 0; i < triCount * 3; i++) {
+                        adjOffset[indices[i] + 1]++;
+                }
+                for (int v = 0; v < vertexCount; v++) {
+                        adjOffset[v + 1] += adjOffset[v];
+                        adjCursor[v] = adjOffset[v];
+                }
+                for (int i = 0; i < triCount * 3; i++) {
+                        adjTris[adjCursor[indices[i]]++] = i / 3;
+                }
+
+                // Every edge can collapse either way unless that would move a
+                // locked vertex.
+                int collapseCount = 0;
+                for (int i = 0; i < triCount * 3; i++) {
+                        unsigned int a = indices[i];
+                        unsigned int b = indices[i - i % 3 + (i + 1) % 3];
+                        struct quadric q = quadrics[a];
+                        QuadricAdd(&q, &quadrics[b]);
+                        if (!locked[a]) {
+                                collapses[collapseCount++] = (struct edge_collapse){ (float)QuadricError(&q, mesh->positions[b]), a, b };
+                        }
+                        if (!locked[b]) {
+                                collapses[collapseCount++] = (struct edge_collapse){ (float)QuadricError(&q, mesh->positions[a]), b, a };
+                        }
+                }
+                qsort(collapses, collapseCount, sizeof(struct edge_collapse), EdgeCollapseCompareFn);
+
+                for (int v = 0; v < vertexCount; v++) {
+                        remap[v] = v;
+                        touched[v] = 0;
+                }
+
+                int removed = 0;
+                int applied = 0;
+                for (int i = 0; i < collapseCount && triCount - removed > targetTris; i++) {
+                        unsigned int from = collapses[i].from;
+                        unsigned int to = collapses[i].to;
+                        if (touched[from] || touched[to]) {
+                                continue;
+                        }
+
+                        int *adjacent = &adjTris[adjOffset[from]];
+                        int adjacentCount = adjOffset[from + 1] - adjOffset[from];
+                        if (!CollapseKeepsOrientation(mesh, indices, adjacent, adjacentCount, from, to)) {
+                                continue;
+                        }
+
+                        // Neighbouring collapses wait for the next pass so
+                        // the orientation test above stays valid.
+                        for (int t = 0; t < adjacentCount; t++) {
+                                unsigned int *tri = &indices[adjacent[t] * 3];
+                                if (tri[0] == to || tri[1] == to || tri[2] == to) {
+                                        removed++;
+                                }
+                                touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+                        }
+
+                        remap[from] = to;
+                        QuadricAdd(&quadrics[to], &quadrics[from]);
+                        if (collapses[i].cost > *maxCost) {
+                                *maxCost = collapses[i].cost;
+                        }
+                        applied++;
+                }
+
+                if (0 == applied) {
+                        break;
+                }
+
+                // Apply the pass, dropping triangles that lost an edge.
+                int kept = 0;
+                for (int t = 0; t < triCount; t++) {
+                        unsigned int a = remap[indices[t * 3 + 0]];
+                        unsigned int b = remap[indices[t * 3 + 1]];
+                        unsigned int c = remap[indices[t * 3 + 2]];
+                        if (a == b || b == c || a == c) {
+                                continue;
+                        }
+                        indices[kept * 3 + 0] = a;
+                        indices[kept * 3 + 1] = b;
+                        indices[kept * 3 + 2] = c;
+                        kept++;
+                }
+                triCount = kept;
+        }
+
+        free(collapses);
+        free(touched);
+        free(remap);
+        free(adjTris);
+        free(adjCursor);
+        free(adjOffset);
+
+        return triCount;
+}
+
+void MeshBuildLODs(struct mesh *mesh) {
+        for (int i = 0; i < mesh->lodCount; i++) {
+                free(mesh->lods[i].indices);
+                free(mesh->lods[i].planes);
+        }
+        mesh->lodCount = 0;
+
+        if (mesh->triCount <= 0) {
+                return;
+        }
+
+        // Every vertex starts with the planes of the faces around it.
+        struct quadric *quadrics = (struct quadric *)calloc(mesh->vertexCount, sizeof(struct quadric));
+        for (int t = 0; t < mesh->triCount; t++) {
+                unsigned int *index = &mesh->indices[t * 3];
+                struct vec3 plane = FaceNormal(mesh, index);
+                plane.w = -Vec3DotProduct(plane, mesh->positions[index[0]]);
+                for (int c = 0; c < 3; c++) {
+                        QuadricAddPlane(&quadrics[index[c]], plane);
+                }
+        }
+
+        unsigned char *locked = (unsigned char *)calloc(mesh->vertexCount, 1);
+        LockBorderVertices(mesh->indices, mesh->triCount, locked);
+
+        unsigned int *indices = (unsigned int *)malloc(sizeof(unsigned int) * mesh->triCount * 3);
+        memcpy(indices, mesh->indices, sizeof(unsigned int) * mesh->triCount * 3);
+        int triCount = mesh->triCount;
+        double maxCost = 0;
+
+        while (mesh->lodCount < MESH_MAX_LODS) {
+                int simplified = SimplifyIndices(mesh, indices, triCount, triCount / 2, quadrics, locked, &maxCost);
+                if (simplified > triCount - triCount / 10 || 0 == simplified) {
+                        break;
+                }
+                triCount = simplified;
+
+                struct mesh_lod *lod = &mesh->lods[mesh->lodCount++];
+                lod->triCount = triCount;
+                lod->error = (float)sqrt(maxCost);
+                lod->indices = (unsigned int *)malloc(sizeof(unsigned int) * triCount * 3);
+                memcpy(lod->indices, indices, sizeof(unsigned int) * triCount * 3);
+                OptimizeVertexCache(lod->indices, triCount, mesh->vertexCount);
+                lod->planes = (struct vec3 *)malloc(sizeof(struct vec3) * triCount);
+                ComputeFacePlanes(mesh->positions, lod->indices, triCount, lod->planes);
+        }
+
+        free(indices);
+        free(locked);
+        free(quadrics);
+}
+
+int MeshSelectLOD(struct mesh *mesh, float screenRadius, int current) {
+        if (mesh->sphere.radius <= 0.0f) {
+                return mesh->lodCount;
+        }
+
+        int level = 0;
+        for (int l = 1; l <= mesh->lodCount; l++) {
+                float error = mesh->lods[l - 1].error / mesh->sphere.radius * screenRadius;
+                float limit = l > current ? MESH_LOD_TOLERANCE * MESH_LOD_HYSTERESIS : MESH_LOD_TOLERANCE;
+                if (error > limit) {
+                        break;
+                }
+                level = l;
+        }
+        return level;
+}
+
+void MeshComputeBounds(struct mesh *mesh) {
+        struct aabb bounds = { 0 };
+        if (mesh->vertexCount > 0) {
+                bounds.min = mesh->positions[0];
+                bounds.max = mesh->positions[0];
+        }
+
+        for (int i = 1; i < mesh->vertexCount; i++) {
+                for (int a = 0; a < 3; a++) {
+                        float p = mesh->positions[i].p[a];
+                        if (p < bounds.min.p[a]) bounds.min.p[a] = p;
+                        if (p > bounds.max.p[a]) bounds.max.p[a] = p;
+                }
+        }
+        bounds.min.w = 1.0f;
+        bounds.max.w = 1.0f;
+
+        struct sphere sphere;
+        sphere.center = Vec3Multiply(Vec3Add(bounds.min, bounds.max), 0.5f);
+        float radiusSq = 0.0f;
+        for (int i = 0; i < mesh->vertexCount; i++) {
+                struct vec3 d = Vec3Subtract(mesh->positions[i], sphere.center);
+                float distSq = Vec3DotProduct(d, d);
+                if (distSq > radiusSq) radiusSq = distSq;
+        }
+        sphere.radius = sqrtf(radiusSq);
+
+        mesh->bounds = bounds;
+        mesh->sphere = sphere;
+}
+
+void MeshDebug(struct mesh *mesh, char *name) {
+        size_t vertexBytes = (sizeof(struct vec3) * 2 + sizeof(struct vec2)) * mesh->vertexCount;
+        if (NULL != mesh->packed) {
+                vertexBytes = sizeof(struct mesh_vertex) * mesh->vertexCount;
+        }
+        size_t indexBytes = (sizeof(unsigned int) * 3 + sizeof(struct vec3)) * mesh->triCount;
+        size_t flatBytes = sizeof(struct triangle) * mesh->triCount;
+
+        int leafCount = 0;
+        for (int n = 0; n < mesh->nodeCount; n++) {
+                if (0 == mesh->nodes[n].left) {
+                        leafCount++;
+                }
+        }
+
+        if (NULL != name)
+                printf("struct mesh %s = ", name);
+        else
+                printf("(struct mesh)");
+
+        printf(
+"{\n"
+"  .vertexCount = %d, .triCount = %d,\n"
+"  vertex bytes = %zu, face bytes = %zu, total = %zu (%.1f per triangle),\n"
+"  unindexed bytes = %zu (%.1f per triangle),\n"
+"  world transforms per frame = %d, unindexed = %d,\n"
+"  ACMR = %.3f (FIFO 16), %.3f (FIFO 32),\n"
+"  .nodeCount = %d, leaves = %d, node bytes = %zu,\n"
+"  .meshletCount = %d,\n"
+"  .lodCount = %d",
+               mesh->vertexCount, mesh->triCount,
+               vertexBytes, indexBytes, vertexBytes + indexBytes,
+               mesh->triCount ? (double)(vertexBytes + indexBytes) / mesh->triCount : 0.0,
+               flatBytes,
+               mesh->triCount ? (double)flatBytes / mesh->triCount : 0.0,
+               mesh->vertexCount, mesh->triCount * 3,
+               MeshACMR(mesh, 16), MeshACMR(mesh, 32),
+               mesh->nodeCount, leafCount, sizeof(struct bvh_node) * mesh->nodeCount,
+               mesh->meshletCount,
+               mesh->lodCount);
+        for (int i = 0; i < mesh->lodCount; i++) {
+                printf("%s%d tris (error %.3f)", 0 == i ? ": " : ", ", mesh->lods[i].triCount, mesh->lods[i].error);
+        }
+        printf("\n}\n");
+}
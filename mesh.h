@@ -0,0 +1,501 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: mesh.h
+  Created: 2026-10-18
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file mesh.h
+//! Indexed triangle meshes and obj file loading.
+
+#ifndef MESH_VERSION
+#define MESH_VERSION "0.1.0" //!< include guard
+
+#include <stddef.h> // size_t
+
+#include "math.h"
+
+struct job_system;
+struct obj;
+
+//! Default maximum number of triangles in a BVH leaf.
+#define MESH_BVH_LEAF_SIZE 256
+
+//! \brief A node in a mesh's bounding volume hierarchy
+//!
+//! Every node, leaf or not, covers a contiguous run of triangles in the mesh's
+//! index buffer, so a subtree can be drawn as a single range.
+struct bvh_node {
+        struct aabb bounds; //!< object space bounds of every triangle in the subtree
+        int firstTri; //!< first triangle of the subtree
+        int triCount; //!< number of triangles in the subtree
+        int left; //!< index of the left child; the right child follows it. 0 for leaves.
+};
+
+//! Maximum number of triangles in a meshlet.
+#define MESH_MESHLET_SIZE 64
+
+//! Maximum number of simplified levels of detail, not counting the full mesh.
+#define MESH_MAX_LODS 4
+
+//! Screen space error in pixels below which a coarser level of detail is used.
+#define MESH_LOD_TOLERANCE 1.0f
+
+//! Fraction of MESH_LOD_TOLERANCE a coarser level must reach before switching
+//! to it, so meshes near a threshold don't flicker between levels.
+#define MESH_LOD_HYSTERESIS 0.75f
+
+//! Flags for MeshInitFromObj()
+#define MESH_LOAD_MESHLETS 0x1 //!< cluster triangles into meshlets, see MeshBuildMeshlets()
+#define MESH_LOAD_LODS 0x2 //!< build simplified levels of detail, see MeshBuildLODs()
+#define MESH_LOAD_CACHE 0x4 //!< load from and save to a binary cache beside the obj file, see MeshInitFromCache()
+#define MESH_LOAD_QUANTIZE 0x8 //!< pack the vertices once the mesh is built, see MeshQuantize()
+
+//! Identifies a mesh cache file: "3DSM" read as a little endian integer.
+#define MESH_CACHE_MAGIC 0x4D534433
+
+//! Incremented whenever the layout of a mesh cache file changes.
+#define MESH_CACHE_VERSION 3
+
+//! Alignment in bytes of the header and every array in a mesh cache file.
+#define MESH_CACHE_ALIGNMENT 64
+
+//! \brief A small cluster of neighbouring triangles that can be culled as a unit
+//!
+//! Meshlets partition the triangles of every hierarchy leaf. Each one covers a
+//! contiguous run of triangles in the index buffer.
+struct meshlet {
+        struct sphere sphere; //!< object space sphere containing every vertex of the meshlet
+        struct vec3 cone; //!< normal cone: unit axis in xyz, cutoff in w; see MeshCullMeshlets()
+        int firstTri;
+        int triCount;
+};
+
+//! \brief A simplified version of a mesh sharing its vertices
+struct mesh_lod {
+        unsigned int *indices; //!< 3 * triCount indices into the mesh's vertex arrays
+        struct vec3 *planes; //!< triCount face planes, as in struct mesh
+        int triCount;
+        float error; //!< object space distance the surface may have moved by
+};
+
+//! \brief A contiguous run of triangles selected for drawing
+struct mesh_range {
+        int firstTri;
+        int triCount;
+        int inside; //!< 1 if the range is entirely inside the frustum and needs no clipping
+};
+
+//! \brief A vertex packed into 12 bytes
+//!
+//! Positions are stored relative to the mesh's bounding box and texture
+//! coordinates relative to their own range, each spread over 16 bits. The
+//! unit normal is folded onto an octahedron and stored in 8 bits per axis.
+//! See MeshQuantize().
+struct mesh_vertex {
+        unsigned short position[3]; //!< 0 at the bounding box's minimum, 65535 at its maximum
+        unsigned short uv[2]; //!< 0 at the smallest texture coordinate, 65535 at the largest
+        signed char normal[2]; //!< octahedral encoded unit normal, see MeshUnpackNormal()
+};
+
+//! \brief An indexed collection of triangles representing some kind of 3D model.
+//!
+//! Every unique combination of position and texture coordinate in the source
+//! model is stored exactly once, and triangles refer to them by index.
+//!
+//! Vertex attributes are stored as parallel arrays rather than interleaved so
+//! that positions can be streamed straight through SimdVec3TransformBatch().
+//! Vertex i is made up of positions[i], normals[i] and uvs[i]. Once the mesh
+//! is quantized those arrays are released and vertex i is packed[i] instead.
+struct mesh {
+        struct vec3 *positions; //!< vertexCount object-space positions, w = 1, or NULL once quantized
+        struct vec3 *normals; //!< vertexCount unit vertex normals, w = 0, or NULL once quantized
+        struct vec2 *uvs; //!< vertexCount texture coordinates, w = 1, or NULL once quantized
+        int vertexCount;
+        int importedNormals; //!< 1 if every vertex normal was read from a file; the mesh is then lit by them rather than its face planes
+
+        struct mesh_vertex *packed; //!< vertexCount packed vertices, or NULL; see MeshQuantize()
+        struct vec3 packScale; //!< object space units per step of a packed position; w = 0
+        struct vec2 uvMin; //!< texture coordinates of packed uv 0
+        struct vec2 uvScale; //!< texture coordinate units per step of a packed uv
+
+        unsigned int *indices; //!< 3 * triCount indices into the vertex arrays
+        struct vec3 *planes; //!< triCount face planes: unit normal in xyz, plane distance in w
+        int triCount;
+
+        struct aabb bounds; //!< object space bounds of every vertex
+        struct sphere sphere; //!< object space sphere containing every vertex
+
+        struct bvh_node *nodes; //!< bounding volume hierarchy; nodes[0] is the root
+        int nodeCount;
+
+        struct meshlet *meshlets; //!< meshletCount clusters in index buffer order, or NULL
+        int meshletCount;
+
+        struct mesh_lod lods[MESH_MAX_LODS]; //!< level i + 1 of detail, from finest to coarsest
+        int lodCount;
+
+        char *material; //!< name of the obj material every triangle uses, or NULL
+        char *materialLibrary; //!< path of the mtl file the obj file named, or NULL
+
+        void *mapping; //!< cache file every array points into, or NULL if they were allocated; see MeshInitFromCache()
+        size_t mappingSize;
+};
+
+//! \brief Initialize a new mesh object
+//!
+//! This function is useful if a mesh needs to be explicitly, manually defined.
+//! Initialization here only refers to setting a valid "zero" state.
+//!
+//! \param[in] numVertices the number of unique vertices the mesh will hold.
+//! \param[in] numTris the number of triangular faces the mesh will hold.
+//! \return a properly "zeroed" mesh object that can support numTris faces.
+struct mesh *
+MeshInit(int numVertices, int numTris);
+
+//! \brief Initialize new mesh objects from an obj file
+//!
+//! Loads the specified obj file and constructs mesh object representations of
+//! it, one per material used by its faces, in order of first use. A file
+//! without usemtl statements makes a single mesh. Each mesh records its
+//! material's name and the file's material library, to be resolved with
+//! ObjMaterialsInit().
+//!
+//! The file is parsed with ObjInit(); large files are parsed in parallel if a
+//! job system is given.
+//!
+//! Vertices referenced by more than one face are shared; a vertex is only
+//! duplicated where the same position is used with different texture
+//! coordinates or normals. Normals given in the file are used as they are;
+//! any other vertex normal is the area-weighted average of the normals of
+//! every face sharing that position.
+//!
+//! A mesh whose every normal came from the file has importedNormals set, and
+//! each triangle is lit by the average of its corners' normals. Any other mesh
+//! is lit by its face planes, so faceted models stay faceted.
+//!
+//! A hierarchy is built with MeshBuildBVH(), then triangles and vertices are
+//! reordered with MeshOptimizeVertexCache() and MeshOptimizeVertexFetch() before
+//! the mesh is returned, and face planes and
+//! bounds are precomputed with MeshComputeFacePlanes() and MeshComputeBounds().
+//!
+//! With MESH_LOAD_MESHLETS the triangles of every hierarchy leaf are also
+//! clustered into meshlets with MeshBuildMeshlets(). With MESH_LOAD_LODS
+//! simplified levels of detail are built last with MeshBuildLODs().
+//!
+//! With MESH_LOAD_CACHE, MeshInitFromCache() is tried first for every mesh
+//! with the paths given by MeshCachePath(). If any of them fails, the meshes
+//! are built from the obj file as above and then written there with
+//! MeshWriteCache().
+//!
+//! With MESH_LOAD_QUANTIZE every mesh is quantized with MeshQuantize() last,
+//! whether it was built or read from the cache. The cache always holds the
+//! full precision vertices.
+//!
+//! \param[in] objFile path to the obj file to read
+//! \param[in] flags bitwise or of MESH_LOAD_* flags, or 0
+//! \param[in,out] jobs job system to parse the file on, or NULL
+//! \param[out] count number of meshes returned
+//! \return count meshes, each to be de-initialized with MeshDeinit() before the array is freed, or NULL if the file couldn't be read
+//!
+//! \see \ref features
+struct mesh **
+MeshInitFromObj(char *objFile, int flags, struct job_system *jobs, int *count);
+
+//! \brief Initialize a new mesh object from some of the triangles of a parsed obj file
+//!
+//! Builds the mesh as MeshInitFromObj() does, from the triangles whose group
+//! matches. Derived normals still average every face in the file sharing a
+//! position, so meshes made from neighbouring groups shade seamlessly. The
+//! mesh's material isn't set.
+//!
+//! \param[in] obj the parsed obj file
+//! \param[in] groups obj->triCount group numbers, one per triangle
+//! \param[in] group the group of the triangles to use
+//! \param[in] normalSums the obj's MeshObjNormalSums(), shared by every group; or NULL to compute them
+//! \param[in] flags bitwise or of MESH_LOAD_* flags, or 0; MESH_LOAD_CACHE and MESH_LOAD_QUANTIZE are ignored
+//! \return the mesh, which may have no triangles
+struct mesh *
+MeshInitFromObjGroup(struct obj *obj, int *groups, int group, struct vec3 *normalSums, int flags);
+
+//! \brief Sum the normals of every face sharing each position of a parsed obj file
+//!
+//! Each face contributes its unnormalized normal, weighting it by area.
+//!
+//! \param[in] obj the parsed obj file
+//! \return obj->positionCount sums, to be freed by the caller
+struct vec3 *
+MeshObjNormalSums(struct obj *obj);
+
+//! \brief Path of the cache file MeshInitFromObj() uses for an obj file
+//!
+//! The obj file's path with its .obj extension, if any, replaced by .mesh for
+//! the first mesh, and by .1.mesh, .2.mesh and so on for the rest.
+//!
+//! \param[in] objFile path to the obj file
+//! \param[in] part index of the mesh among those made from the obj file
+//! \return a newly allocated path to be freed by the caller
+char *
+MeshCachePath(char *objFile, int part);
+
+//! \brief Write a mesh to a cache file that MeshInitFromCache() can map
+//!
+//! The file starts with a header recording the mesh's counts, bounds, material
+//! and where each array is, along with the size and modification time of the
+//! source file so stale caches can be detected. It's followed by the vertex
+//! arrays, the index and face plane arrays, the hierarchy nodes, the meshlets
+//! and the levels of detail, each aligned to MESH_CACHE_ALIGNMENT bytes.
+//! Arrays are stored exactly as they are in memory, so the file can only be
+//! read on machines with the same byte order and structure layout.
+//!
+//! The file is written under a temporary name and renamed into place, so a
+//! reader never sees it half written.
+//!
+//! \param[in] mesh the mesh to save
+//! \param[in] file path to the cache file to write
+//! \param[in] sourceFile path to the file the mesh was built from, or NULL
+//! \param[in] flags the MESH_LOAD_* flags the mesh was built with
+//! \param[in] partCount number of meshes the source file was split into
+//! \return 1 on success, otherwise 0
+int
+MeshWriteCache(struct mesh *mesh, char *file, char *sourceFile, int flags, int partCount);
+
+//! \brief Initialize a mesh by memory-mapping a cache file
+//!
+//! Nothing is parsed or copied: every array of the returned mesh points
+//! straight into the private mapping, which is released by MeshDeinit().
+//! The arrays are checked in one pass before the mesh is returned, so a
+//! truncated or corrupted file is rejected rather than read out of bounds.
+//!
+//! \param[in] file path to a file written by MeshWriteCache()
+//! \param[in] sourceFile if not NULL, the cache is rejected unless this file's size and modification time match those it was written with
+//! \param[in] flags the cache is rejected unless it was written with these MESH_LOAD_* flags, ignoring MESH_LOAD_CACHE; with MESH_LOAD_QUANTIZE the mesh is quantized once read
+//! \param[out] partCount if not NULL, set to the number of meshes the source file was split into
+//! \return the mesh, or NULL if the file is missing, stale or malformed
+struct mesh *
+MeshInitFromCache(char *file, char *sourceFile, int flags, int *partCount);
+
+//! \brief De-initializes the mesh object
+//!
+//! Frees any memory allocated by the object and frees the pointer to the object itself.
+//! A mesh loaded by MeshInitFromCache() has its cache file unmapped instead.
+//!
+//! \param[in,out] mesh The mesh to be de-initialized
+void
+MeshDeinit(struct mesh *mesh);
+
+//! \brief Build a bounding volume hierarchy over the mesh's triangles
+//!
+//! Triangles are split recursively at the midpoint of the longest axis of
+//! their centroids' bounds until no more than maxLeafTris remain. The index
+//! buffer and face planes are then reordered so every node's triangles are
+//! contiguous. Building is O(n log n) and allocation-light, so it's suitable
+//! for meshes with millions of triangles at load time.
+//!
+//! Any existing hierarchy is replaced.
+//!
+//! \param[in,out] mesh the mesh to build the hierarchy for
+//! \param[in] maxLeafTris leaf size limit, e.g. MESH_BVH_LEAF_SIZE
+void
+MeshBuildBVH(struct mesh *mesh, int maxLeafTris);
+
+//! \brief Select the triangle ranges of the mesh that may be visible
+//!
+//! Walks the hierarchy testing node bounds against the frustum. Subtrees
+//! outside the frustum are skipped, subtrees entirely inside are emitted whole
+//! without testing their children, and adjacent ranges are merged.
+//!
+//! A mesh without a hierarchy is returned as a single range.
+//!
+//! \param[in] mesh the mesh to cull
+//! \param[in] frustum object space view frustum
+//! \param[out] ranges receives the visible ranges; must hold nodeCount entries, or 1 if there are no nodes
+//! \return number of ranges written
+int
+MeshCullBVH(struct mesh *mesh, struct frustum *frustum, struct mesh_range *ranges);
+
+//! \brief Cluster the triangles of every hierarchy leaf into meshlets
+//!
+//! Each meshlet is grown greedily from a seed triangle, preferring triangles
+//! that share vertices with the meshlet and face the same way, until it holds
+//! maxTris triangles or the leaf runs out. Triangles are reordered within
+//! their leaf so each meshlet is contiguous, leaving the hierarchy valid.
+//!
+//! Builds the hierarchy first if the mesh doesn't have one. Any existing
+//! meshlets are replaced.
+//!
+//! \param[in,out] mesh the mesh to cluster
+//! \param[in] maxTris meshlet size limit, e.g. MESH_MESHLET_SIZE
+void
+MeshBuildMeshlets(struct mesh *mesh, int maxTris);
+
+//! \brief Narrow visible ranges down to the meshlets that may be visible
+//!
+//! Every meshlet in the input ranges is tested against the view frustum with
+//! its bounding sphere, and against the camera position with its normal cone.
+//! A meshlet is backfacing when
+//! dot(center - camera, axis) >= cutoff * length(center - camera) + radius,
+//! in which case every one of its triangles is too. Surviving meshlets are
+//! merged back into ranges.
+//!
+//! A mesh without meshlets has its ranges copied through unchanged.
+//!
+//! \param[in] mesh the mesh to cull
+//! \param[in] frustum object space view frustum
+//! \param[in] camera object space camera position
+//! \param[in] ranges ranges to refine, e.g. from MeshCullBVH()
+//! \param[in] rangeCount number of input ranges
+//! \param[out] out receives the visible ranges; must hold meshletCount entries, or rangeCount if there are no meshlets
+//! \return number of ranges written
+int
+MeshCullMeshlets(struct mesh *mesh, struct frustum *frustum, struct vec3 camera, struct mesh_range *ranges, int rangeCount, struct mesh_range *out);
+
+//! \brief Build a chain of simplified levels of detail
+//!
+//! Each level halves the triangle count of the one before by collapsing
+//! edges in order of their quadric error, moving one vertex onto the other
+//! so every level reuses the mesh's vertices. Collapses that would flip a
+//! face are rejected. Vertices on open edges of the index buffer are never
+//! moved; since vertices are split where texture coordinates differ, that
+//! keeps UV seams as well as mesh borders intact.
+//!
+//! Stops early once a level can't be reduced by at least a tenth. Any
+//! existing levels are replaced.
+//!
+//! \param[in,out] mesh the mesh to simplify
+void
+MeshBuildLODs(struct mesh *mesh);
+
+//! \brief Choose the level of detail to draw a mesh at
+//!
+//! A level's screen space error is its error relative to the mesh's
+//! bounding sphere, scaled by the sphere's projected radius. The coarsest
+//! level whose error is within MESH_LOD_TOLERANCE is chosen, except that
+//! moving to a coarser level than current requires the error to be within
+//! MESH_LOD_TOLERANCE * MESH_LOD_HYSTERESIS.
+//!
+//! \param[in] mesh the mesh being drawn
+//! \param[in] screenRadius projected radius of the mesh's bounding sphere in pixels
+//! \param[in] current level the mesh was drawn at last frame
+//! \return 0 for the full mesh, otherwise level i is mesh->lods[i - 1]
+int
+MeshSelectLOD(struct mesh *mesh, float screenRadius, int current);
+
+//! \brief Reorder triangles for post-transform vertex cache reuse
+//!
+//! Uses Tom Forsyth's linear-speed vertex cache optimization so triangles
+//! sharing vertices are drawn close together. Only the index buffer changes.
+//! If the mesh has meshlets, or failing that a hierarchy, each meshlet or leaf
+//! is optimized separately so they stay contiguous.
+//!
+//! \param[in,out] mesh the mesh to optimize
+//!
+//! \see MeshACMR()
+void
+MeshOptimizeVertexCache(struct mesh *mesh);
+
+//! \brief Reorder vertices into the order the index buffer first uses them
+//!
+//! Run after MeshOptimizeVertexCache() so vertex reads walk forward through
+//! memory. Indices are rewritten to match.
+//!
+//! \param[in,out] mesh the mesh to optimize
+void
+MeshOptimizeVertexFetch(struct mesh *mesh);
+
+//! \brief Average cache miss ratio of the mesh's index buffer
+//!
+//! The average number of vertex transforms per triangle with a FIFO
+//! post-transform cache of the given size. 0.5 is the ideal for large regular
+//! meshes, 3.0 is the worst case.
+//!
+//! \param[in] mesh the mesh to measure
+//! \param[in] cacheSize number of entries in the simulated cache
+//! \return vertex transforms per triangle
+float
+MeshACMR(struct mesh *mesh, int cacheSize);
+
+//! \brief Replace a mesh's vertex arrays with packed vertices
+//!
+//! Cuts vertex storage from 44 bytes to 12. Positions land within half a
+//! step of 1/65535 of the bounding box and texture coordinates within half a
+//! step of 1/65535 of their range; normals are off by about a degree.
+//!
+//! The geometry stage unpacks positions with the same matrix multiply that
+//! brings them into view space; see MeshUnpackMatrix(). Everything derived
+//! from the vertices, such as bounds, face planes, meshlets and levels of
+//! detail, must be built first, as the float arrays are gone afterwards:
+//! positions, normals and uvs are NULL, so MeshComputeBounds(),
+//! MeshBuildBVH(), MeshBuildMeshlets(), MeshBuildLODs(),
+//! MeshOptimizeVertexFetch() and TerrainPlaceholderInit() must not be given a
+//! quantized mesh, and MeshWriteCache() refuses one. Anything else reading
+//! vertices decodes packed ones with MeshUnpackMatrix(), MeshUnpackNormal()
+//! and MeshUnpackUV().
+//!
+//! \param[in,out] mesh the mesh to quantize; does nothing if it already is
+void
+MeshQuantize(struct mesh *mesh);
+
+//! \brief Matrix mapping a mesh's packed positions to object space
+//!
+//! \param[in] mesh a quantized mesh
+//! \return a scale by packScale followed by a translation to the bounding box's minimum
+struct mat4x4
+MeshUnpackMatrix(struct mesh *mesh);
+
+//! \brief Unpack a packed vertex's normal
+//!
+//! \param[in] vertex the packed vertex
+//! \return the unit normal, w = 0
+struct vec3
+MeshUnpackNormal(struct mesh_vertex *vertex);
+
+//! \brief Unpack a packed vertex's texture coordinates
+//!
+//! \param[in] mesh the quantized mesh the vertex belongs to
+//! \param[in] vertex the packed vertex
+//! \return the texture coordinates, w = 1
+struct vec2
+MeshUnpackUV(struct mesh *mesh, struct mesh_vertex *vertex);
+
+//! \brief Compute the object-space plane of every face
+//!
+//! Each plane is stored as its unit normal in xyz and its distance from the
+//! origin in w, so that dot(plane.xyz, p) + plane.w is the signed distance of p
+//! from the face. The normal follows the winding order of the triangle.
+//!
+//! Must be re-run whenever positions or the index buffer change.
+//!
+//! \param[in,out] mesh the mesh to update
+void
+MeshComputeFacePlanes(struct mesh *mesh);
+
+//! \brief Compute the mesh's bounding box and bounding sphere
+//!
+//! The sphere is centered on the bounding box, with the smallest radius that
+//! still contains every vertex.
+//!
+//! Must be re-run whenever positions change.
+//!
+//! \param[in,out] mesh the mesh to update
+void
+MeshComputeBounds(struct mesh *mesh);
+
+//! \brief Prints debug information about the mesh.
+//!
+//! Reports vertex and triangle counts, memory use and per-frame vertex
+//! transforms, along with what the same model would cost stored as one
+//! struct triangle per face.
+void
+MeshDebug(struct mesh *mesh, char *name);
+
+#endif // MESH_VERSION
@@ -0,0 +1,951 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: obj.c
+  Created: 2026-10-18
+  Updated: 2026-10-18
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file obj.c
+
+#include <stdlib.h> // malloc, realloc, free, strtod
+#include <string.h> // memset, memcpy, memchr, strcmp, strrchr
+#include <stdio.h> // fprintf
+#include <stdint.h> // uint64_t
+#include <fcntl.h> // open
+#include <unistd.h> // close
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // fstat
+
+#include "obj.h"
+#include "job.h"
+
+//! \brief Grow an array so it holds at least needed elements
+//!
+//! Capacity doubles, starting from 64, so appending one element at a time is
+//! amortized O(1).
+//!
+//! \param[in,out] array the array to grow, or NULL
+//! \param[in,out] capacity number of elements array has room for
+//! \param[in] needed number of elements that must fit
+//! \param[in] size bytes per element
+//! \return the possibly moved array
+void *ObjReserve(void *array, int *capacity, int needed, size_t size) {
+        if (needed <= *capacity) {
+                return array;
+        }
+
+        int grown = *capacity < 64 ? 64 : *capacity;
+        while (grown < needed) {
+                grown *= 2;
+        }
+        *capacity = grown;
+        return realloc(array, size * grown);
+}
+
+//! \brief Whether c separates tokens within a line
+int ObjIsSpace(char c) {
+        return ' ' == c || '\t' == c || '\r' == c;
+}
+
+//! \brief Whether c is a decimal digit
+int ObjIsDigit(char c) {
+        return c >= '0' && c <= '9';
+}
+
+//! \brief Advance past spaces, stopping at end
+const char *ObjSkipSpace(const char *p, const char *end) {
+        while (p < end && ObjIsSpace(*p)) {
+                p++;
+        }
+        return p;
+}
+
+//! Powers of ten exactly representable as doubles.
+static const double objPowersOf10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+//! \brief Parse a decimal number, advancing *cursor past it
+//!
+//! Numbers with at most 15 significant digits and a small enough exponent,
+//! which covers everything exporters write, are converted with one exact
+//! multiplication or division in double precision. Anything else falls back
+//! to strtod().
+//!
+//! \param[in,out] cursor start of the number; moved to the first character after it
+//! \param[in] end end of the text, which needn't be NUL-terminated
+//! \param[out] out the number
+//! \return 1 if a number was read, otherwise 0 and cursor is left alone
+int ObjParseFloat(const char **cursor, const char *end, float *out) {
+        const char *p = *cursor;
+        const char *start = p;
+
+        int negative = 0;
+        if (p < end && ('-' == *p || '+' == *p)) {
+                negative = '-' == *p;
+                p++;
+        }
+
+        uint64_t mantissa = 0;
+        int digits = 0; // significant digits in mantissa
+        int exponent = 0;
+        int any = 0;
+        for (; p < end && ObjIsDigit(*p); p++, any = 1) {
+                if (digits < 19) {
+                        mantissa = mantissa * 10 + (*p - '0');
+                        digits += 0 != mantissa;
+                } else {
+                        exponent++;
+                }
+        }
+        if (p < end && '.' == *p) {
+                for (p++; p < end && ObjIsDigit(*p); p++, any = 1) {
+                        if (digits < 19) {
+                                mantissa = mantissa * 10 + (*p - '0');
+                                digits += 0 != mantissa;
+                                exponent--;
+                        }
+                }
+        }
+        if (!any) {
+                return 0;
+        }
+
+        if (p < end && ('e' == *p || 'E' == *p)) {
+                const char *e = p + 1;
+                int exponentNegative = 0;
+                if (e < end && ('-' == *e || '+' == *e)) {
+                        exponentNegative = '-' == *e;
+                        e++;
+                }
+                if (e < end && ObjIsDigit(*e)) {
+                        int value = 0;
+                        for (; e < end && ObjIsDigit(*e); e++) {
+                                if (value < 100000) {
+                                        value = value * 10 + (*e - '0');
+                                }
+                        }
+                        exponent += exponentNegative ? -value : value;
+                        p = e;
+                }
+        }
+        *cursor = p;
+
+        double value;
+        if (digits <= 15 && exponent >= -22 && exponent <= 22) {
+                value = (double)mantissa;
+                value = exponent < 0 ? value / objPowersOf10[-exponent] : value * objPowersOf10[exponent];
+                if (negative) {
+                        value = -value;
+                }
+        } else {
+                char buffer[128];
+                int length = p - start < (int)sizeof(buffer) - 1 ? (int)(p - start) : (int)sizeof(buffer) - 1;
+                memcpy(buffer, start, length);
+                buffer[length] = '\0';
+                value = strtod(buffer, NULL);
+        }
+
+        *out = (float)value;
+        return 1;
+}
+
+//! \brief Parse a decimal integer, advancing *cursor past it
+//!
+//! \param[in,out] cursor start of the integer; moved to the first character after it
+//! \param[in] end end of the text, which needn't be NUL-terminated
+//! \param[out] out the integer
+//! \return 1 if an integer was read, otherwise 0 and cursor is left alone
+int ObjParseInt(const char **cursor, const char *end, int *out) {
+        const char *p = *cursor;
+
+        int negative = 0;
+        if (p < end && ('-' == *p || '+' == *p)) {
+                negative = '-' == *p;
+                p++;
+        }
+        if (p >= end || !ObjIsDigit(*p)) {
+                return 0;
+        }
+
+        long value = 0;
+        for (; p < end && ObjIsDigit(*p); p++) {
+                if (value <= INT32_MAX) {
+                        value = value * 10 + (*p - '0');
+                }
+        }
+
+        if (value > INT32_MAX) {
+                value = INT32_MAX;
+        }
+
+        *cursor = p;
+        *out = (int)(negative ? -value : value);
+        return 1;
+}
+
+//! Stored while parsing for an attribute a face vertex doesn't have.
+#define OBJ_MISSING INT32_MIN
+
+//! Material of faces at the start of a chunk, before its first usemtl: the
+//! one the chunk before it ended with.
+#define OBJ_INHERIT -2
+
+//! \brief A line-aligned run of the file, parsed into arrays of its own
+//!
+//! While parsing, obj.corners holds the vertices of every face back to back
+//! and faceSizes the number of vertices in each; faces are only triangulated
+//! by ObjResolve(). Indices stay 1-based. A negative index is resolved against
+//! the chunk's own counts as soon as it's read, and recorded in relative so
+//! the counts of the chunks before it can be added once they're known.
+struct obj_chunk {
+        const char *begin;
+        const char *end;
+        struct obj obj;
+        int cornerCount;
+
+        int *faceSizes;
+        int faceCount;
+        int faceCapacity;
+        int *faceMaterials; //!< faceCount indices into obj.materials, -1 or OBJ_INHERIT
+        int faceMaterialCapacity;
+        int material; //!< material of faces read from here on
+
+        int *relative; //!< relativeCount entries of 3 * corner + attribute, see ObjCornerIndex()
+        int relativeCount;
+        int relativeCapacity;
+};
+
+//! \brief One of a face vertex's indices
+//!
+//! \param[in] corner the face vertex
+//! \param[in] attribute 0 for position, 1 for texcoord, 2 for normal
+//! \return pointer to the index
+int *ObjCornerIndex(struct obj_corner *corner, int attribute) {
+        switch (attribute) {
+                case 0:
+                        return &corner->position;
+                case 1:
+                        return &corner->texcoord;
+                default:
+                        return &corner->normal;
+        }
+}
+
+//! \brief Parse one index of a face vertex
+//!
+//! Negative indices count back from the last element the chunk has read so
+//! far and are recorded for fix up by ObjAppend().
+//!
+//! \param[in,out] chunk the chunk being parsed; the vertex is at obj.corners[cornerCount]
+//! \param[in,out] cursor start of the index; moved past it
+//! \param[in] end end of the line
+//! \param[in] attribute 0 for position, 1 for texcoord, 2 for normal
+//! \param[out] index the index read, which belongs to the vertex at obj.corners[cornerCount]
+//! \return 1 if a non-zero index was read, otherwise 0
+int ObjParseIndex(struct obj_chunk *chunk, const char **cursor, const char *end, int attribute, int *index) {
+        if (!ObjParseInt(cursor, end, index) || 0 == *index) {
+                return 0;
+        }
+
+        if (*index < 0) {
+                int counts[3] = { chunk->obj.positionCount, chunk->obj.texcoordCount, chunk->obj.normalCount };
+                *index += counts[attribute] + 1;
+                chunk->relative = (int *)ObjReserve(chunk->relative, &chunk->relativeCapacity, chunk->relativeCount + 1, sizeof(int));
+                chunk->relative[chunk->relativeCount++] = chunk->cornerCount * 3 + attribute;
+        }
+        return 1;
+}
+
+//! \brief Parse one face vertex in any of the forms v, v/vt, v//vn and v/vt/vn
+//!
+//! \param[in,out] chunk the chunk to append the vertex to
+//! \param[in,out] cursor start of the vertex; moved past it
+//! \param[in] end end of the line
+//! \return 1 if a well-formed vertex was read, otherwise 0
+int ObjParseCorner(struct obj_chunk *chunk, const char **cursor, const char *end) {
+        const char *p = *cursor;
+
+        struct obj *obj = &chunk->obj;
+        obj->corners = (struct obj_corner *)ObjReserve(obj->corners, &obj->cornerCapacity, chunk->cornerCount + 1, sizeof(struct obj_corner));
+        struct obj_corner *corner = &obj->corners[chunk->cornerCount];
+        corner->texcoord = OBJ_MISSING;
+        corner->normal = OBJ_MISSING;
+
+        if (!ObjParseIndex(chunk, &p, end, 0, &corner->position)) {
+                return 0;
+        }
+        if (p < end && '/' == *p) {
+                p++;
+                if (p < end && '/' != *p && !ObjParseIndex(chunk, &p, end, 1, &corner->texcoord)) {
+                        return 0;
+                }
+                if (p < end && '/' == *p) {
+                        p++;
+                        if (!ObjParseIndex(chunk, &p, end, 2, &corner->normal)) {
+                                return 0;
+                        }
+                }
+        }
+        if (p < end && !ObjIsSpace(*p)) {
+                return 0;
+        }
+
+        chunk->cornerCount++;
+        *cursor = p;
+        return 1;
+}
+
+//! \brief Match a statement keyword at the start of a line
+//!
+//! \param[in] p start of the statement
+//! \param[in] end end of the line
+//! \param[in] keyword the keyword to match
+//! \return the start of the statement's arguments, or NULL if the line doesn't start with keyword and a space
+const char *ObjKeyword(const char *p, const char *end, const char *keyword) {
+        size_t length = strlen(keyword);
+        if ((size_t)(end - p) <= length || 0 != memcmp(p, keyword, length) || !ObjIsSpace(p[length])) {
+                return NULL;
+        }
+        return ObjSkipSpace(p + length, end);
+}
+
+//! \brief Copy the rest of a line, without trailing spaces or comment
+//!
+//! \param[in] p start of the text to copy
+//! \param[in] end end of the line
+//! \return a newly allocated string, or NULL if there is nothing but space
+char *ObjCopyRest(const char *p, const char *end) {
+        const char *comment = (const char *)memchr(p, '#', end - p);
+        if (NULL != comment) {
+                end = comment;
+        }
+        while (end > p && ObjIsSpace(end[-1])) {
+                end--;
+        }
+        if (end == p) {
+                return NULL;
+        }
+
+        char *copy = (char *)malloc(end - p + 1);
+        memcpy(copy, p, end - p);
+        copy[end - p] = '\0';
+        return copy;
+}
+
+//! \brief Find a material by name, adding it if it's new
+//!
+//! \param[in,out] obj the obj whose materials to search
+//! \param[in] name the material's name; owned by obj if added, otherwise freed
+//! \return index of the material
+int ObjFindMaterial(struct obj *obj, char *name) {
+        for (int i = 0; i < obj->materialCount; i++) {
+                if (0 == strcmp(obj->materials[i], name)) {
+                        free(name);
+                        return i;
+                }
+        }
+
+        obj->materials = (char **)ObjReserve(obj->materials, &obj->materialCapacity, obj->materialCount + 1, sizeof(char *));
+        obj->materials[obj->materialCount] = name;
+        return obj->materialCount++;
+}
+
+//! \brief Parse a single line into a chunk
+//!
+//! \param[in,out] chunk the chunk to append to
+//! \param[in] line start of the line
+//! \param[in] end end of the line, not including the newline
+void ObjParseLine(struct obj_chunk *chunk, const char *line, const char *end) {
+        struct obj *obj = &chunk->obj;
+        const char *arguments;
+        const char *p = ObjSkipSpace(line, end);
+        if (end - p < 2) {
+                return;
+        }
+
+        if ('v' == p[0] && ObjIsSpace(p[1])) {
+                obj->positions = (struct vec3 *)ObjReserve(obj->positions, &obj->positionCapacity, obj->positionCount + 1, sizeof(struct vec3));
+                struct vec3 *position = &obj->positions[obj->positionCount++];
+                *position = Vec3Init(0, 0, 0);
+                p += 2;
+                for (int i = 0; i < 3; i++) {
+                        p = ObjSkipSpace(p, end);
+                        ObjParseFloat(&p, end, &position->p[i]);
+                }
+        } else if ('v' == p[0] && 't' == p[1] && end - p > 2 && ObjIsSpace(p[2])) {
+                obj->texcoords = (struct vec2 *)ObjReserve(obj->texcoords, &obj->texcoordCapacity, obj->texcoordCount + 1, sizeof(struct vec2));
+                struct vec2 *texcoord = &obj->texcoords[obj->texcoordCount++];
+                texcoord->u = texcoord->v = 0;
+                texcoord->w = 1;
+                p += 3;
+                p = ObjSkipSpace(p, end);
+                ObjParseFloat(&p, end, &texcoord->u);
+                p = ObjSkipSpace(p, end);
+                ObjParseFloat(&p, end, &texcoord->v);
+        } else if ('v' == p[0] && 'n' == p[1] && end - p > 2 && ObjIsSpace(p[2])) {
+                obj->normals = (struct vec3 *)ObjReserve(obj->normals, &obj->normalCapacity, obj->normalCount + 1, sizeof(struct vec3));
+                struct vec3 *normal = &obj->normals[obj->normalCount++];
+                *normal = Vec3Init(0, 0, 0);
+                normal->w = 0;
+                p += 3;
+                for (int i = 0; i < 3; i++) {
+                        p = ObjSkipSpace(p, end);
+                        ObjParseFloat(&p, end, &normal->p[i]);
+                }
+        } else if ('f' == p[0] && ObjIsSpace(p[1])) {
+                int firstCorner = chunk->cornerCount;
+                int firstRelative = chunk->relativeCount;
+                int valid = 1;
+                for (p += 2; ; ) {
+                        p = ObjSkipSpace(p, end);
+                        if (p == end || '#' == *p) {
+                                break;
+                        }
+                        if (!ObjParseCorner(chunk, &p, end)) {
+                                valid = 0;
+                                break;
+                        }
+                }
+
+                int size = chunk->cornerCount - firstCorner;
+                if (!valid || size < 3) {
+                        fprintf(stderr, "Couldn't read face line: %.*s\n", (int)(end - line), line);
+                        chunk->cornerCount = firstCorner;
+                        chunk->relativeCount = firstRelative;
+                        return;
+                }
+
+                chunk->faceSizes = (int *)ObjReserve(chunk->faceSizes, &chunk->faceCapacity, chunk->faceCount + 1, sizeof(int));
+                chunk->faceMaterials = (int *)ObjReserve(chunk->faceMaterials, &chunk->faceMaterialCapacity, chunk->faceCount + 1, sizeof(int));
+                chunk->faceMaterials[chunk->faceCount] = chunk->material;
+                chunk->faceSizes[chunk->faceCount++] = size;
+        } else if (NULL != (arguments = ObjKeyword(p, end, "usemtl"))) {
+                char *name = ObjCopyRest(arguments, end);
+                if (NULL == name) {
+                        fprintf(stderr, "Couldn't read usemtl line: %.*s\n", (int)(end - line), line);
+                        return;
+                }
+                chunk->material = ObjFindMaterial(obj, name);
+        } else if (NULL == obj->library && NULL != (arguments = ObjKeyword(p, end, "mtllib"))) {
+                obj->library = ObjCopyRest(arguments, end);
+        }
+}
+
+//! \brief Parse every line in the chunk
+//!
+//! \param[in,out] chunk the chunk to parse, which must begin at the start of a line
+void ObjParse(struct obj_chunk *chunk) {
+        const char *p = chunk->begin;
+        while (p < chunk->end) {
+                const char *eol = (const char *)memchr(p, '\n', chunk->end - p);
+                if (NULL == eol) {
+                        eol = chunk->end;
+                }
+                ObjParseLine(chunk, p, eol);
+                p = eol + 1;
+        }
+}
+
+//! \brief Whether point lies inside or on the edge of triangle abc
+//!
+//! \param[in] point the point to test
+//! \param[in] a,b,c the triangle, wound counter-clockwise about normal
+//! \param[in] normal the polygon's normal
+//! \return 1 if the point is inside, otherwise 0
+int ObjInsideTriangle(struct vec3 point, struct vec3 a, struct vec3 b, struct vec3 c, struct vec3 normal) {
+        return Vec3DotProduct(Vec3CrossProduct(Vec3Subtract(b, a), Vec3Subtract(point, a)), normal) >= 0.0f &&
+               Vec3DotProduct(Vec3CrossProduct(Vec3Subtract(c, b), Vec3Subtract(point, b)), normal) >= 0.0f &&
+               Vec3DotProduct(Vec3CrossProduct(Vec3Subtract(a, c), Vec3Subtract(point, c)), normal) >= 0.0f;
+}
+
+//! \brief Whether the remaining polygon vertex at i can be clipped off as an ear
+//!
+//! It can if the turn it makes is convex and no other remaining vertex lies
+//! inside the triangle it forms with its neighbours.
+//!
+//! \param[in] positions the obj's positions
+//! \param[in] face the polygon's vertices
+//! \param[in] remaining indices into face of the vertices not yet clipped
+//! \param[in] count number of remaining vertices
+//! \param[in] i position in remaining of the candidate
+//! \param[in] normal the polygon's normal
+//! \return 1 if the vertex is an ear, otherwise 0
+int ObjIsEar(struct vec3 *positions, struct obj_corner *face, int *remaining, int count, int i, struct vec3 normal) {
+        int prev = remaining[(i + count - 1) % count];
+        int next = remaining[(i + 1) % count];
+        struct vec3 a = positions[face[prev].position];
+        struct vec3 b = positions[face[remaining[i]].position];
+        struct vec3 c = positions[face[next].position];
+
+        if (Vec3DotProduct(Vec3CrossProduct(Vec3Subtract(b, a), Vec3Subtract(c, b)), normal) <= 0.0f) {
+                return 0;
+        }
+
+        for (int j = 0; j < count; j++) {
+                int position = face[remaining[j]].position;
+                if (position == face[prev].position || position == face[remaining[i]].position || position == face[next].position) {
+                        continue;
+                }
+                if (ObjInsideTriangle(positions[position], a, b, c, normal)) {
+                        return 0;
+                }
+        }
+        return 1;
+}
+
+//! \brief Split a polygon into triangles by ear clipping
+//!
+//! Triangles keep the polygon's winding. A convex polygon comes out as a fan
+//! around its first vertex. If no ear can be found, as with a degenerate or
+//! self-intersecting polygon, what remains is fanned.
+//!
+//! \param[in] positions the obj's positions
+//! \param[in] face size 0-based polygon vertices
+//! \param[in] size number of vertices, at least 3
+//! \param[out] out room for 3 * (size - 2) triangle corners; may be face itself if size is 3
+//! \param[in,out] scratch growable array of size ints or more
+//! \param[in,out] scratchCapacity number of ints scratch has room for
+void ObjTriangulate(struct vec3 *positions, struct obj_corner *face, int size, struct obj_corner *out, int **scratch, int *scratchCapacity) {
+        if (3 == size) {
+                memmove(out, face, sizeof(struct obj_corner) * 3);
+                return;
+        }
+
+        // Newell's method gives a normal that is robust to concave and
+        // slightly non-planar polygons.
+        struct vec3 normal = { 0 };
+        for (int i = 0; i < size; i++) {
+                struct vec3 a = positions[face[i].position];
+                struct vec3 b = positions[face[(i + 1) % size].position];
+                normal.x += (a.y - b.y) * (a.z + b.z);
+                normal.y += (a.z - b.z) * (a.x + b.x);
+                normal.z += (a.x - b.x) * (a.y + b.y);
+        }
+
+        *scratch = (int *)ObjReserve(*scratch, scratchCapacity, size, sizeof(int));
+        int *remaining = *scratch;
+        for (int i = 0; i < size; i++) {
+                remaining[i] = i;
+        }
+
+        int count = size;
+        int i = 1;
+        int misses = 0;
+        while (count > 3 && misses < count) {
+                if (!ObjIsEar(positions, face, remaining, count, i, normal)) {
+                        i = (i + 1) % count;
+                        misses++;
+                        continue;
+                }
+
+                out[0] = face[remaining[(i + count - 1) % count]];
+                out[1] = face[remaining[i]];
+                out[2] = face[remaining[(i + 1) % count]];
+                out += 3;
+
+                memmove(&remaining[i], &remaining[i + 1], sizeof(int) * (count - i - 1));
+                count--;
+                i %= count;
+                misses = 0;
+        }
+
+        for (int k = 1; k + 1 < count; k++) {
+                out[0] = face[remaining[0]];
+                out[1] = face[remaining[k]];
+                out[2] = face[remaining[k + 1]];
+                out += 3;
+        }
+}
+
+//! \brief Check a 1-based face vertex index
+//!
+//! \param[in] index the index, or OBJ_MISSING
+//! \param[in] count number of elements it may refer to
+//! \param[in] required whether OBJ_MISSING is an error
+//! \return 1 if index is valid, otherwise 0
+int ObjIndexValid(int index, int count, int required) {
+        if (OBJ_MISSING == index) {
+                return !required;
+        }
+        return index >= 1 && index <= count;
+}
+
+//! \brief Triangulate every face, making indices 0-based and dropping faces referring to missing data
+//!
+//! \param[in,out] chunk the fully parsed file; its obj is left holding triangles
+void ObjResolve(struct obj_chunk *chunk) {
+        struct obj *obj = &chunk->obj;
+
+        int triCapacity = 0;
+        for (int f = 0; f < chunk->faceCount; f++) {
+                triCapacity += chunk->faceSizes[f] - 2;
+        }
+        // Files made only of triangles, the common case, are resolved in place.
+        struct obj_corner *triangles = obj->corners;
+        if (triCapacity * 3 != chunk->cornerCount) {
+                triangles = (struct obj_corner *)malloc(sizeof(struct obj_corner) * 3 * triCapacity);
+        }
+
+        obj->triMaterials = (int *)malloc(sizeof(int) * (triCapacity > 0 ? triCapacity : 1));
+
+        int *scratch = NULL;
+        int scratchCapacity = 0;
+        int triCount = 0;
+        struct obj_corner *face = obj->corners;
+        for (int f = 0; f < chunk->faceCount; face += chunk->faceSizes[f], f++) {
+                int size = chunk->faceSizes[f];
+
+                int valid = 1;
+                for (int c = 0; c < size; c++) {
+                        valid &= ObjIndexValid(face[c].position, obj->positionCount, 1);
+                        valid &= ObjIndexValid(face[c].texcoord, obj->texcoordCount, 0);
+                        valid &= ObjIndexValid(face[c].normal, obj->normalCount, 0);
+                }
+                if (!valid) {
+                        fprintf(stderr, "Skipping face %d: it refers to vertex data that doesn't exist\n", f + 1);
+                        continue;
+                }
+
+                for (int c = 0; c < size; c++) {
+                        face[c].position--;
+                        face[c].texcoord = OBJ_MISSING == face[c].texcoord ? -1 : face[c].texcoord - 1;
+                        face[c].normal = OBJ_MISSING == face[c].normal ? -1 : face[c].normal - 1;
+                }
+
+                ObjTriangulate(obj->positions, face, size, &triangles[triCount * 3], &scratch, &scratchCapacity);
+                for (int t = 0; t < size - 2; t++) {
+                        obj->triMaterials[triCount++] = chunk->faceMaterials[f];
+                }
+        }
+
+        free(scratch);
+        if (triangles != obj->corners) {
+                free(obj->corners);
+        }
+        free(chunk->faceSizes);
+        free(chunk->faceMaterials);
+        free(chunk->relative);
+
+        if (triangles != obj->corners) {
+                obj->corners = triangles;
+                obj->cornerCapacity = triCapacity * 3;
+        }
+        obj->triCount = triCount;
+}
+
+//! \brief Parse a range of chunks
+//!
+//! Job function for JobParallelFor().
+//!
+//! \param[in,out] data array of struct obj_chunk
+//! \param[in] first first chunk to parse
+//! \param[in] count number of chunks to parse
+void ObjParseChunks(void *data, int first, int count) {
+        struct obj_chunk *chunks = (struct obj_chunk *)data;
+        for (int i = first; i < first + count; i++) {
+                ObjParse(&chunks[i]);
+        }
+}
+
+//! \brief Append everything in one chunk onto another and free the appended chunk's arrays
+//!
+//! Positive indices are file-wide and need no adjustment; relative ones get
+//! the element counts of every chunk before them added.
+//!
+//! \param[in,out] into the chunk to append to, made up of every chunk before the other
+//! \param[in,out] chunk the chunk to append
+void ObjAppend(struct obj_chunk *into, struct obj_chunk *chunk) {
+        struct obj *obj = &into->obj;
+        struct obj *from = &chunk->obj;
+
+        int bases[3] = { obj->positionCount, obj->texcoordCount, obj->normalCount };
+        for (int r = 0; r < chunk->relativeCount; r++) {
+                int entry = chunk->relative[r];
+                *ObjCornerIndex(&from->corners[entry / 3], entry % 3) += bases[entry % 3];
+        }
+
+        obj->positions = (struct vec3 *)ObjReserve(obj->positions, &obj->positionCapacity, obj->positionCount + from->positionCount, sizeof(struct vec3));
+        memcpy(&obj->positions[obj->positionCount], from->positions, sizeof(struct vec3) * from->positionCount);
+        obj->positionCount += from->positionCount;
+
+        obj->texcoords = (struct vec2 *)ObjReserve(obj->texcoords, &obj->texcoordCapacity, obj->texcoordCount + from->texcoordCount, sizeof(struct vec2));
+        memcpy(&obj->texcoords[obj->texcoordCount], from->texcoords, sizeof(struct vec2) * from->texcoordCount);
+        obj->texcoordCount += from->texcoordCount;
+
+        obj->normals = (struct vec3 *)ObjReserve(obj->normals, &obj->normalCapacity, obj->normalCount + from->normalCount, sizeof(struct vec3));
+        memcpy(&obj->normals[obj->normalCount], from->normals, sizeof(struct vec3) * from->normalCount);
+        obj->normalCount += from->normalCount;
+
+        obj->corners = (struct obj_corner *)ObjReserve(obj->corners, &obj->cornerCapacity, into->cornerCount + chunk->cornerCount, sizeof(struct obj_corner));
+        memcpy(&obj->corners[into->cornerCount], from->corners, sizeof(struct obj_corner) * chunk->cornerCount);
+        into->cornerCount += chunk->cornerCount;
+
+        // Materials are renumbered into the combined list. Faces before the
+        // chunk's first usemtl continue whatever material came before.
+        int *remap = (int *)malloc(sizeof(int) * (from->materialCount > 0 ? from->materialCount : 1));
+        for (int m = 0; m < from->materialCount; m++) {
+                remap[m] = ObjFindMaterial(obj, from->materials[m]);
+        }
+        into->faceMaterials = (int *)ObjReserve(into->faceMaterials, &into->faceMaterialCapacity, into->faceCount + chunk->faceCount, sizeof(int));
+        for (int f = 0; f < chunk->faceCount; f++) {
+                int material = chunk->faceMaterials[f];
+                into->faceMaterials[into->faceCount + f] = OBJ_INHERIT == material ? into->material : material < 0 ? material : remap[material];
+        }
+        if (OBJ_INHERIT != chunk->material) {
+                into->material = remap[chunk->material];
+        }
+        free(remap);
+
+        into->faceSizes = (int *)ObjReserve(into->faceSizes, &into->faceCapacity, into->faceCount + chunk->faceCount, sizeof(int));
+        memcpy(&into->faceSizes[into->faceCount], chunk->faceSizes, sizeof(int) * chunk->faceCount);
+        into->faceCount += chunk->faceCount;
+
+        if (NULL == obj->library) {
+                obj->library = from->library;
+        } else {
+                free(from->library);
+        }
+
+        free(from->positions);
+        free(from->texcoords);
+        free(from->normals);
+        free(from->corners);
+        free(from->materials);
+        free(chunk->faceSizes);
+        free(chunk->faceMaterials);
+        free(chunk->relative);
+}
+
+//! \brief Parse a file's text, splitting it into chunks across a job system if it's large
+//!
+//! \param[out] whole the empty chunk to parse the whole file into
+//! \param[in] text contents of the file
+//! \param[in] size bytes of text
+//! \param[in,out] jobs job system to parse on, or NULL
+void ObjParseText(struct obj_chunk *whole, const char *text, size_t size, struct job_system *jobs) {
+        int chunkCount = 1;
+        if (NULL != jobs) {
+                size_t maxChunks = size / OBJ_CHUNK_BYTES;
+                chunkCount = JobSystemThreadCount(jobs) * 4;
+                if ((size_t)chunkCount > maxChunks) {
+                        chunkCount = (int)maxChunks;
+                }
+        }
+        if (chunkCount <= 1) {
+                whole->begin = text;
+                whole->end = text + size;
+                ObjParse(whole);
+                return;
+        }
+
+        // Each chunk starts just after the first newline at or past its
+        // share of the file, so no line is split.
+        struct obj_chunk *chunks = (struct obj_chunk *)calloc(chunkCount, sizeof(struct obj_chunk));
+        const char *end = text + size;
+        const char *begin = text;
+        for (int i = 0; i < chunkCount; i++) {
+                const char *split = end;
+                if (i < chunkCount - 1) {
+                        split = text + size / chunkCount * (i + 1);
+                        if (split < begin) {
+                                split = begin;
+                        }
+                        const char *eol = (const char *)memchr(split, '\n', end - split);
+                        split = NULL != eol ? eol + 1 : end;
+                }
+                chunks[i].begin = begin;
+                chunks[i].end = split;
+                chunks[i].material = 0 == i ? -1 : OBJ_INHERIT;
+                begin = split;
+        }
+
+        JobParallelFor(jobs, ObjParseChunks, chunks, chunkCount, 1);
+
+        *whole = chunks[0];
+        for (int i = 1; i < chunkCount; i++) {
+                ObjAppend(whole, &chunks[i]);
+        }
+        free(chunks);
+}
+
+//! \brief Map a whole file into memory for reading
+//!
+//! \param[in] file path to the file
+//! \param[out] size size of the file in bytes
+//! \return the file's contents, which needn't be NUL-terminated, or NULL on failure; an empty file maps to ""
+const char *ObjMapFile(char *file, size_t *size) {
+        int fd = open(file, O_RDONLY);
+        if (fd < 0) {
+                fprintf(stderr, "Couldn't open %s\n", file);
+                return NULL;
+        }
+
+        struct stat info;
+        if (0 != fstat(fd, &info)) {
+                fprintf(stderr, "Couldn't stat %s\n", file);
+                close(fd);
+                return NULL;
+        }
+
+        *size = (size_t)info.st_size;
+        if (0 == *size) {
+                close(fd);
+                return "";
+        }
+
+        const char *text = (const char *)mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (MAP_FAILED == text) {
+                fprintf(stderr, "Couldn't map %s\n", file);
+                return NULL;
+        }
+        madvise((void *)text, *size, MADV_SEQUENTIAL);
+        return text;
+}
+
+//! \brief Unmap a file mapped by ObjMapFile()
+//!
+//! \param[in] text the file's contents
+//! \param[in] size size of the file in bytes
+void ObjUnmapFile(const char *text, size_t size) {
+        if (size > 0) {
+                munmap((void *)text, size);
+        }
+}
+
+//! \brief Resolve a path found inside a file relative to that file's directory
+//!
+//! \param[in] file path to the file the name was found in
+//! \param[in] name the path found; absolute paths are left alone
+//! \return a newly allocated path
+char *ObjRelativePath(char *file, char *name) {
+        const char *slash = strrchr(file, '/');
+        size_t directory = '/' == name[0] || NULL == slash ? 0 : (size_t)(slash - file + 1);
+        size_t length = strlen(name);
+
+        char *path = (char *)malloc(directory + length + 1);
+        memcpy(path, file, directory);
+        memcpy(path + directory, name, length + 1);
+        return path;
+}
+
+struct obj *ObjInit(char *file, struct job_system *jobs) {
+        size_t size;
+        const char *text = ObjMapFile(file, &size);
+        if (NULL == text) {
+                return NULL;
+        }
+
+        struct obj_chunk whole;
+        memset(&whole, 0, sizeof(struct obj_chunk));
+        whole.material = -1;
+
+        ObjParseText(&whole, text, size, jobs);
+        ObjUnmapFile(text, size);
+
+        ObjResolve(&whole);
+
+        struct obj *obj = (struct obj *)malloc(sizeof(struct obj));
+        *obj = whole.obj;
+        if (NULL != obj->library) {
+                char *library = ObjRelativePath(file, obj->library);
+                free(obj->library);
+                obj->library = library;
+        }
+        return obj;
+}
+
+void ObjDeinit(struct obj *obj) {
+        if (NULL == obj) {
+                return;
+        }
+
+        free(obj->positions);
+        free(obj->texcoords);
+        free(obj->normals);
+        free(obj->corners);
+        for (int i = 0; i < obj->materialCount; i++) {
+                free(obj->materials[i]);
+        }
+        free(obj->materials);
+        free(obj->triMaterials);
+        free(obj->library);
+        free(obj);
+}
+
+struct obj_material *ObjMaterialsInit(char *file, int *count) {
+        size_t size;
+        const char *text = ObjMapFile(file, &size);
+        if (NULL == text) {
+                return NULL;
+        }
+
+        struct obj_material *materials = NULL;
+        int capacity = 0;
+        *count = 0;
+
+        const char *end = text + size;
+        for (const char *line = text; line < end; ) {
+                const char *eol = (const char *)memchr(line, '\n', end - line);
+                if (NULL == eol) {
+                        eol = end;
+                }
+
+                const char *p = ObjSkipSpace(line, eol);
+                const char *arguments;
+                struct obj_material *material = *count > 0 ? &materials[*count - 1] : NULL;
+                if (NULL != (arguments = ObjKeyword(p, eol, "newmtl"))) {
+                        char *name = ObjCopyRest(arguments, eol);
+                        if (NULL != name) {
+                                materials = (struct obj_material *)ObjReserve(materials, &capacity, *count + 1, sizeof(struct obj_material));
+                                material = &materials[(*count)++];
+                                material->name = name;
+                                material->texture = NULL;
+                                material->diffuse = Vec3Init(1, 1, 1);
+                        }
+                } else if (NULL != material && NULL != (arguments = ObjKeyword(p, eol, "Kd"))) {
+                        for (int i = 0; i < 3; i++) {
+                                ObjParseFloat(&arguments, eol, &material->diffuse.p[i]);
+                                arguments = ObjSkipSpace(arguments, eol);
+                        }
+                } else if (NULL != material && NULL != (arguments = ObjKeyword(p, eol, "map_Kd"))) {
+                        char *rest = ObjCopyRest(arguments, eol);
+                        if (NULL != rest) {
+                                char *name = rest + strlen(rest);
+                                while (name > rest && !ObjIsSpace(name[-1])) {
+                                        name--;
+                                }
+                                free(material->texture);
+                                material->texture = ObjRelativePath(file, name);
+                                free(rest);
+                        }
+                }
+
+                line = eol + 1;
+        }
+
+        ObjUnmapFile(text, size);
+        if (NULL == materials) {
+                materials = (struct obj_material *)malloc(sizeof(struct obj_material));
+        }
+        return materials;
+}
+
+void ObjMaterialsDeinit(struct obj_material *materials, int count) {
+        for (int i = 0; i < count; i++) {
+                free(materials[i].name);
+                free(materials[i].texture);
+        }
+        free(materials);
+}
@@ -0,0 +1,128 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: obj.h
+  Created: 2026-10-18
+  Updated: 2026-10-18
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file obj.h
+//! Wavefront obj file parsing.
+//!
+//! The file is memory-mapped and tokenized in a single pass with hand-written
+//! number parsing; there is no limit on line length. Every array grows
+//! geometrically as it's filled. Files larger than OBJ_CHUNK_BYTES can be
+//! split on line boundaries and parsed in parallel, each chunk into arrays of
+//! its own, which are then concatenated in file order.
+//!
+//! Faces may have any number of vertices and are triangulated by ear clipping
+//! once the whole file has been read, so a polygon can use positions defined
+//! anywhere in the file.
+//!
+//! Parsing only gathers the file's data. Turning it into an indexed mesh is up
+//! to MeshInitFromObj().
+
+#ifndef OBJ_VERSION
+#define OBJ_VERSION "0.1.0" //!< include guard
+
+#include "math.h"
+
+struct job_system;
+
+//! Minimum number of bytes of a file parsed by one job.
+#define OBJ_CHUNK_BYTES (1 << 20)
+
+//! \brief One corner of a face: indices into the obj's attribute arrays
+struct obj_corner {
+        int position; //!< index into positions
+        int texcoord; //!< index into texcoords, or -1 if there is none
+        int normal; //!< index into normals, or -1 if there is none
+};
+
+//! \brief The contents of an obj file
+//!
+//! Indices have been made 0-based and checked against the arrays they index.
+//! Triangle i is made up of corners 3 * i to 3 * i + 2.
+struct obj {
+        struct vec3 *positions; //!< positionCount vertex positions, w = 1
+        int positionCount;
+        int positionCapacity;
+
+        struct vec2 *texcoords; //!< texcoordCount texture coordinates, w = 1
+        int texcoordCount;
+        int texcoordCapacity;
+
+        struct vec3 *normals; //!< normalCount vertex normals as written in the file, w = 0
+        int normalCount;
+        int normalCapacity;
+
+        struct obj_corner *corners; //!< 3 * triCount face corners
+        int triCount;
+        int cornerCapacity;
+
+        char **materials; //!< materialCount names given to usemtl, in order of first use
+        int materialCount;
+        int materialCapacity;
+        int *triMaterials; //!< triCount indices into materials, or -1 for triangles before any usemtl
+
+        char *library; //!< path of the file named by the first mtllib statement, or NULL
+};
+
+//! \brief A material read from an mtl file
+struct obj_material {
+        char *name; //!< name used by usemtl
+        char *texture; //!< path of the diffuse texture map, or NULL
+        struct vec3 diffuse; //!< diffuse color, each component in [0, 1]; white if not given
+};
+
+//! \brief Parse an obj file
+//!
+//! Reads v, vt, vn, f, usemtl and mtllib statements; everything else is
+//! ignored. Material libraries aren't read; see ObjMaterialsInit(). Face
+//! vertices may be given in any of the forms v, v/vt, v//vn and v/vt/vn, and
+//! indices may be negative to count back from the most recently defined
+//! element. Faces with more than three vertices are split into triangles
+//! keeping their winding. Faces that can't be read or refer to missing data
+//! are reported and skipped.
+//!
+//! \param[in] file path to the obj file to read
+//! \param[in,out] jobs job system to parse large files in parallel on, or NULL
+//! \return the file's contents, or NULL if it couldn't be read
+struct obj *
+ObjInit(char *file, struct job_system *jobs);
+
+//! \brief De-initialize an obj
+//!
+//! \param[in,out] obj the obj to be de-initialized
+void
+ObjDeinit(struct obj *obj);
+
+//! \brief Read the materials defined in an mtl file
+//!
+//! Reads newmtl, Kd and map_Kd statements; everything else is ignored. The
+//! last word of a map_Kd statement is taken as the texture's file name, so
+//! options before it are skipped. Paths are resolved relative to the mtl
+//! file's directory.
+//!
+//! \param[in] file path to the mtl file to read
+//! \param[out] count number of materials read
+//! \return count materials, or NULL if the file couldn't be read
+struct obj_material *
+ObjMaterialsInit(char *file, int *count);
+
+//! \brief De-initialize materials read by ObjMaterialsInit()
+//!
+//! \param[in,out] materials the materials to be de-initialized
+//! \param[in] count number of materials
+void
+ObjMaterialsDeinit(struct obj_material *materials, int count);
+
+#endif // OBJ_VERSION
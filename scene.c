@@ -0,0 +1,119 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: scene.c
+  Created: 2026-10-18
+  Updated: 2026-10-18
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file scene.c
+
+#include <stdlib.h> // malloc, realloc, free
+#include <string.h> // memset
+
+#include "scene.h"
+#include "simd.h"
+
+struct scene *SceneInit(int capacity) {
+        struct scene *scene = (struct scene *)malloc(sizeof(struct scene));
+        memset(scene, 0, sizeof(struct scene));
+
+        if (capacity < 1) {
+                capacity = 1;
+        }
+
+        scene->local = (struct mat4x4 *)malloc(sizeof(struct mat4x4) * capacity);
+        scene->world = (struct mat4x4 *)malloc(sizeof(struct mat4x4) * capacity);
+        scene->parent = (int *)malloc(sizeof(int) * capacity);
+        scene->dirty = (unsigned char *)malloc(sizeof(unsigned char) * capacity);
+        scene->updated = (unsigned int *)malloc(sizeof(unsigned int) * capacity);
+        scene->capacity = capacity;
+
+        return scene;
+}
+
+void SceneDeinit(struct scene *scene) {
+        if (NULL == scene) {
+                return;
+        }
+
+        free(scene->local);
+        free(scene->world);
+        free(scene->parent);
+        free(scene->dirty);
+        free(scene->updated);
+        free(scene);
+}
+
+int SceneAddNode(struct scene *scene, int parent, struct mat4x4 local) {
+        if (parent < SCENE_ROOT || parent >= scene->count) {
+                return -1;
+        }
+
+        if (scene->count == scene->capacity) {
+                scene->capacity *= 2;
+                scene->local = (struct mat4x4 *)realloc(scene->local, sizeof(struct mat4x4) * scene->capacity);
+                scene->world = (struct mat4x4 *)realloc(scene->world, sizeof(struct mat4x4) * scene->capacity);
+                scene->parent = (int *)realloc(scene->parent, sizeof(int) * scene->capacity);
+                scene->dirty = (unsigned char *)realloc(scene->dirty, sizeof(unsigned char) * scene->capacity);
+                scene->updated = (unsigned int *)realloc(scene->updated, sizeof(unsigned int) * scene->capacity);
+        }
+
+        int node = scene->count++;
+        scene->local[node] = local;
+        scene->world[node] = local;
+        scene->parent[node] = parent;
+        scene->dirty[node] = 1;
+        scene->updated[node] = 0;
+
+        return node;
+}
+
+void SceneSetLocal(struct scene *scene, int node, struct mat4x4 local) {
+        scene->local[node] = local;
+        scene->dirty[node] = 1;
+}
+
+int SceneUpdate(struct scene *scene) {
+        scene->generation++;
+        if (0 == scene->generation) {
+                memset(scene->updated, 0, sizeof(unsigned int) * scene->count);
+                scene->generation = 1;
+        }
+
+        // Parents precede their children, so by the time a node is visited
+        // its parent's world matrix is final and updated[parent] says whether
+        // it changed in this pass.
+        int recomputed = 0;
+        for (int i = 0; i < scene->count; i++) {
+                int parent = scene->parent[i];
+                int parentChanged = SCENE_ROOT != parent && scene->generation == scene->updated[parent];
+                if (!scene->dirty[i] && !parentChanged) {
+                        continue;
+                }
+
+                if (SCENE_ROOT == parent) {
+                        scene->world[i] = scene->local[i];
+                } else {
+                        SimdMat4x4Multiply(&scene->world[i], &scene->local[i], &scene->world[parent]);
+                }
+
+                scene->dirty[i] = 0;
+                scene->updated[i] = scene->generation;
+                recomputed++;
+        }
+
+        return recomputed;
+}
+
+int SceneNodeChanged(struct scene *scene, int node) {
+        return 0 != scene->generation && scene->generation == scene->updated[node];
+}
@@ -0,0 +1,110 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: scene.h
+  Created: 2026-10-18
+  Updated: 2026-10-18
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file scene.h
+//! A transform hierarchy with cached world matrices.
+//!
+//! Nodes are stored in flat parallel arrays in topological order: a node's
+//! parent always has a smaller index than the node itself. SceneUpdate() is
+//! then a single linear pass in which every parent's world matrix is final
+//! before any of its children are visited.
+//!
+//! World matrices are only recomputed for nodes whose local transform changed
+//! since the last update, or which have such an ancestor. Static nodes cost a
+//! flag test per update.
+//!
+//! Because world matrices are contiguous, a run of sibling nodes added one
+//! after another can be passed straight to GraphicsDrawMeshInstanced() as its
+//! transform array.
+
+#ifndef SCENE_VERSION
+#define SCENE_VERSION "0.1.0" //!< include guard
+
+#include "math.h"
+
+//! Parent of nodes at the top of the hierarchy.
+#define SCENE_ROOT -1
+
+//! \brief A hierarchy of transforms
+//!
+//! Node i is made up of local[i], world[i], parent[i] and dirty[i].
+struct scene {
+        struct mat4x4 *local; //!< count transforms relative to the parent node
+        struct mat4x4 *world; //!< count cached transforms to world space: local * parent's world
+        int *parent; //!< count parent indices, each less than the node's own, or SCENE_ROOT
+        unsigned char *dirty; //!< count flags set when local changed since the last update
+        unsigned int *updated; //!< count generations in which world was last recomputed
+        unsigned int generation; //!< number of calls to SceneUpdate()
+        int count;
+        int capacity;
+};
+
+//! \brief Initialize a new, empty scene
+//!
+//! \param[in] capacity number of nodes to reserve space for; the scene grows past it as needed
+//! \return an empty scene
+struct scene *
+SceneInit(int capacity);
+
+//! \brief De-initialize a scene
+//!
+//! \param[in,out] scene the scene to be de-initialized
+void
+SceneDeinit(struct scene *scene);
+
+//! \brief Add a node to the scene
+//!
+//! Parents must be added before their children, which keeps the node arrays
+//! in topological order. The new node is dirty, so its world matrix is valid
+//! after the next SceneUpdate().
+//!
+//! \param[in,out] scene the scene to add to
+//! \param[in] parent index of an existing node, or SCENE_ROOT
+//! \param[in] local transform relative to the parent
+//! \return index of the new node, or -1 if parent isn't a node of the scene
+int
+SceneAddNode(struct scene *scene, int parent, struct mat4x4 local);
+
+//! \brief Replace a node's local transform
+//!
+//! Marks the node dirty so it and all of its descendants are recomputed by
+//! the next SceneUpdate().
+//!
+//! \param[in,out] scene the scene containing the node
+//! \param[in] node index of the node to modify
+//! \param[in] local the new transform relative to the parent
+void
+SceneSetLocal(struct scene *scene, int node, struct mat4x4 local);
+
+//! \brief Recompute the world matrix of every dirty node and its descendants
+//!
+//! \param[in,out] scene the scene to update
+//! \return the number of world matrices recomputed
+int
+SceneUpdate(struct scene *scene);
+
+//! \brief Whether a node's world matrix changed in the last SceneUpdate()
+//!
+//! Useful for caching anything derived from a world matrix, like a view
+//! matrix.
+//!
+//! \param[in] scene the scene containing the node
+//! \param[in] node index of the node to query
+//! \return 1 if the node's world matrix was recomputed, otherwise 0
+int
+SceneNodeChanged(struct scene *scene, int node);
+
+#endif // SCENE_VERSION
@@ -0,0 +1,231 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: simd.c
+  Created: 2026-10-18
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file simd.c
+
+#if defined(__SSE__) && !defined(SIMD_NO_SSE)
+#include <xmmintrin.h> // __m128, _mm_*
+#endif
+
+#include "math.h"
+#include "simd.h"
+
+#if defined(__SSE__) && !defined(SIMD_NO_SSE)
+
+//! \brief row-vector multiply: x * r0 + y * r1 + z * r2 + w * r3
+//!
+//! The additions are performed left to right to match Mat4x4MultiplyVec3().
+static inline __m128 MultiplyRows(__m128 v, __m128 r0, __m128 r1, __m128 r2, __m128 r3) {
+        __m128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+        __m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+        __m128 z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+        __m128 w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+
+        __m128 res = _mm_add_ps(_mm_mul_ps(x, r0), _mm_mul_ps(y, r1));
+        res = _mm_add_ps(res, _mm_mul_ps(z, r2));
+        return _mm_add_ps(res, _mm_mul_ps(w, r3));
+}
+
+struct vec3 SimdMat4x4MultiplyVec3(const struct mat4x4 *mat, const struct vec3 *vec) {
+        struct vec3 res;
+        __m128 v = _mm_load_ps(vec->p);
+        _mm_store_ps(res.p, MultiplyRows(v,
+                _mm_load_ps(mat->m[0]),
+                _mm_load_ps(mat->m[1]),
+                _mm_load_ps(mat->m[2]),
+                _mm_load_ps(mat->m[3])));
+        return res;
+}
+
+void SimdMat4x4Multiply(struct mat4x4 *out, const struct mat4x4 *left, const struct mat4x4 *right) {
+        __m128 r0 = _mm_load_ps(right->m[0]);
+        __m128 r1 = _mm_load_ps(right->m[1]);
+        __m128 r2 = _mm_load_ps(right->m[2]);
+        __m128 r3 = _mm_load_ps(right->m[3]);
+
+        // Compute every row before storing so out may alias left.
+        __m128 row0 = MultiplyRows(_mm_load_ps(left->m[0]), r0, r1, r2, r3);
+        __m128 row1 = MultiplyRows(_mm_load_ps(left->m[1]), r0, r1, r2, r3);
+        __m128 row2 = MultiplyRows(_mm_load_ps(left->m[2]), r0, r1, r2, r3);
+        __m128 row3 = MultiplyRows(_mm_load_ps(left->m[3]), r0, r1, r2, r3);
+
+        _mm_store_ps(out->m[0], row0);
+        _mm_store_ps(out->m[1], row1);
+        _mm_store_ps(out->m[2], row2);
+        _mm_store_ps(out->m[3], row3);
+}
+
+void SimdVec3TransformBatch(const struct mat4x4 *mat, const struct vec3 *in, struct vec3 *out, int count) {
+        __m128 r0 = _mm_load_ps(mat->m[0]);
+        __m128 r1 = _mm_load_ps(mat->m[1]);
+        __m128 r2 = _mm_load_ps(mat->m[2]);
+        __m128 r3 = _mm_load_ps(mat->m[3]);
+
+        for (int i = 0; i < count; i++) {
+                _mm_store_ps(out[i].p, MultiplyRows(_mm_load_ps(in[i].p), r0, r1, r2, r3));
+        }
+}
+
+void SimdVec3NormalizeBatch(const struct vec3 *in, struct vec3 *out, int count) {
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        // Four vectors at a time in SoA form so each lane does one whole
+        // vector.
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+                __m128 x = _mm_load_ps(in[i + 0].p);
+                __m128 y = _mm_load_ps(in[i + 1].p);
+                __m128 z = _mm_load_ps(in[i + 2].p);
+                __m128 w = _mm_load_ps(in[i + 3].p);
+                _MM_TRANSPOSE4_PS(x, y, z, w);
+
+                __m128 len = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+                len = _mm_sqrt_ps(_mm_add_ps(len, _mm_mul_ps(z, z)));
+
+                x = _mm_div_ps(x, len);
+                y = _mm_div_ps(y, len);
+                z = _mm_div_ps(z, len);
+                w = one;
+                _MM_TRANSPOSE4_PS(x, y, z, w);
+
+                _mm_store_ps(out[i + 0].p, x);
+                _mm_store_ps(out[i + 1].p, y);
+                _mm_store_ps(out[i + 2].p, z);
+                _mm_store_ps(out[i + 3].p, w);
+        }
+
+        for (; i < count; i++) {
+                out[i] = Vec3Normalize(in[i]);
+        }
+}
+
+void SimdVec3CrossProductBatch(const struct vec3 *left, const struct vec3 *right, struct vec3 *out, int count) {
+        for (int i = 0; i < count; i++) {
+                __m128 l = _mm_load_ps(left[i].p);
+                __m128 r = _mm_load_ps(right[i].p);
+
+                __m128 lyzx = _mm_shuffle_ps(l, l, _MM_SHUFFLE(3, 0, 2, 1));
+                __m128 lzxy = _mm_shuffle_ps(l, l, _MM_SHUFFLE(3, 1, 0, 2));
+                __m128 ryzx = _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 0, 2, 1));
+                __m128 rzxy = _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 1, 0, 2));
+
+                _mm_store_ps(out[i].p, _mm_sub_ps(_mm_mul_ps(lyzx, rzxy), _mm_mul_ps(lzxy, ryzx)));
+                out[i].w = 1.0f;
+        }
+}
+
+void SimdMat4x4MultiplyBatch(const struct mat4x4 *left, const struct mat4x4 *right, struct mat4x4 *out, int count) {
+        __m128 r0 = _mm_load_ps(right->m[0]);
+        __m128 r1 = _mm_load_ps(right->m[1]);
+        __m128 r2 = _mm_load_ps(right->m[2]);
+        __m128 r3 = _mm_load_ps(right->m[3]);
+
+        for (int i = 0; i < count; i++) {
+                __m128 row0 = MultiplyRows(_mm_load_ps(left[i].m[0]), r0, r1, r2, r3);
+                __m128 row1 = MultiplyRows(_mm_load_ps(left[i].m[1]), r0, r1, r2, r3);
+                __m128 row2 = MultiplyRows(_mm_load_ps(left[i].m[2]), r0, r1, r2, r3);
+                __m128 row3 = MultiplyRows(_mm_load_ps(left[i].m[3]), r0, r1, r2, r3);
+
+                _mm_store_ps(out[i].m[0], row0);
+                _mm_store_ps(out[i].m[1], row1);
+                _mm_store_ps(out[i].m[2], row2);
+                _mm_store_ps(out[i].m[3], row3);
+        }
+}
+
+void SimdFrustumTestSpheres(const struct frustum *frustum, const struct sphere *spheres, int *results, int count) {
+        // Four spheres at a time in SoA form, so each lane tests one sphere.
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+                __m128 x = _mm_load_ps(spheres[i + 0].center.p);
+                __m128 y = _mm_load_ps(spheres[i + 1].center.p);
+                __m128 z = _mm_load_ps(spheres[i + 2].center.p);
+                __m128 w = _mm_load_ps(spheres[i + 3].center.p);
+                _MM_TRANSPOSE4_PS(x, y, z, w);
+
+                __m128 radius = _mm_setr_ps(spheres[i + 0].radius, spheres[i + 1].radius, spheres[i + 2].radius, spheres[i + 3].radius);
+                __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), radius);
+
+                __m128 outside = _mm_setzero_ps();
+                __m128 intersect = _mm_setzero_ps();
+                for (int p = 0; p < 6; p++) {
+                        const struct vec3 *plane = &frustum->planes[p];
+                        __m128 dist = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane->x)), _mm_mul_ps(y, _mm_set1_ps(plane->y)));
+                        dist = _mm_add_ps(dist, _mm_mul_ps(z, _mm_set1_ps(plane->z)));
+                        dist = _mm_add_ps(dist, _mm_set1_ps(plane->w));
+                        outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, negRadius));
+                        intersect = _mm_or_ps(intersect, _mm_cmplt_ps(dist, radius));
+                }
+
+                int outsideMask = _mm_movemask_ps(outside);
+                int intersectMask = _mm_movemask_ps(intersect);
+                for (int j = 0; j < 4; j++) {
+                        if (outsideMask & (1 << j)) {
+                                results[i + j] = FRUSTUM_OUTSIDE;
+                        } else if (intersectMask & (1 << j)) {
+                                results[i + j] = FRUSTUM_INTERSECT;
+                        } else {
+                                results[i + j] = FRUSTUM_INSIDE;
+                        }
+                }
+        }
+
+        for (; i < count; i++) {
+                results[i] = FrustumTestSphere(frustum, spheres[i]);
+        }
+}
+
+#else // !defined(__SSE__) || defined(SIMD_NO_SSE)
+
+struct vec3 SimdMat4x4MultiplyVec3(const struct mat4x4 *mat, const struct vec3 *vec) {
+        return Mat4x4MultiplyVec3(*mat, *vec);
+}
+
+void SimdMat4x4Multiply(struct mat4x4 *out, const struct mat4x4 *left, const struct mat4x4 *right) {
+        *out = Mat4x4Multiply(*left, *right);
+}
+
+void SimdVec3TransformBatch(const struct mat4x4 *mat, const struct vec3 *in, struct vec3 *out, int count) {
+        for (int i = 0; i < count; i++) {
+                out[i] = Mat4x4MultiplyVec3(*mat, in[i]);
+        }
+}
+
+void SimdVec3NormalizeBatch(const struct vec3 *in, struct vec3 *out, int count) {
+        for (int i = 0; i < count; i++) {
+                out[i] = Vec3Normalize(in[i]);
+        }
+}
+
+void SimdVec3CrossProductBatch(const struct vec3 *left, const struct vec3 *right, struct vec3 *out, int count) {
+        for (int i = 0; i < count; i++) {
+                out[i] = Vec3CrossProduct(left[i], right[i]);
+        }
+}
+
+void SimdMat4x4MultiplyBatch(const struct mat4x4 *left, const struct mat4x4 *right, struct mat4x4 *out, int count) {
+        for (int i = 0; i < count; i++) {
+                out[i] = Mat4x4Multiply(left[i], *right);
+        }
+}
+
+void SimdFrustumTestSpheres(const struct frustum *frustum, const struct sphere *spheres, int *results, int count) {
+        for (int i = 0; i < count; i++) {
+                results[i] = FrustumTestSphere(frustum, spheres[i]);
+        }
+}
+
+#endif // defined(__SSE__) && !defined(SIMD_NO_SSE)
@@ -0,0 +1,116 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: simd.h
+  Created: 2026-10-18
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file simd.h
+//! SSE implementations of the hot vector and matrix operations in math.h.
+//!
+//! Every function here has a scalar counterpart in math.h which remains the
+//! reference implementation. The SIMD versions evaluate the same expressions
+//! in the same order, so results are bit-identical to the scalar API.
+//!
+//! Unlike math.h these functions take pointers rather than values, and the
+//! batch entry points operate on whole arrays. struct vec3 and struct mat4x4
+//! are 16-byte aligned so they can be loaded directly into SSE registers.
+//!
+//! When the compiler doesn't target SSE, or SIMD_NO_SSE is defined, every
+//! function falls back to the scalar implementation.
+
+#ifndef SIMD_VERSION
+#define SIMD_VERSION "0.1.0" //!< include guard
+
+struct vec3;
+struct mat4x4;
+struct sphere;
+struct frustum;
+
+//! \brief Multiply a homogenous 3D vector by a matrix
+//!
+//! Equivalent to Mat4x4MultiplyVec3().
+//!
+//! \param[in] mat the matrix to multiply by
+//! \param[in] vec the vector to transform
+//! \return the transformed vector
+struct vec3
+SimdMat4x4MultiplyVec3(const struct mat4x4 *mat, const struct vec3 *vec);
+
+//! \brief Multiply two matrices
+//!
+//! Equivalent to Mat4x4Multiply(). out may alias left or right.
+//!
+//! \param[out] out the resulting matrix
+//! \param[in] left
+//! \param[in] right
+void
+SimdMat4x4Multiply(struct mat4x4 *out, const struct mat4x4 *left, const struct mat4x4 *right);
+
+//! \brief Transform count points by a single matrix
+//!
+//! in and out may be the same array.
+//!
+//! \param[in] mat the matrix to multiply every point by
+//! \param[in] in array of count points to transform
+//! \param[out] out array of count points receiving the results
+//! \param[in] count number of points to transform
+void
+SimdVec3TransformBatch(const struct mat4x4 *mat, const struct vec3 *in, struct vec3 *out, int count);
+
+//! \brief Normalize count vectors
+//!
+//! Equivalent to calling Vec3Normalize() on each element. in and out may be
+//! the same array.
+//!
+//! \param[in] in array of count vectors to normalize
+//! \param[out] out array of count vectors receiving the results
+//! \param[in] count number of vectors to normalize
+void
+SimdVec3NormalizeBatch(const struct vec3 *in, struct vec3 *out, int count);
+
+//! \brief Compute count cross products
+//!
+//! Equivalent to out[i] = Vec3CrossProduct(left[i], right[i]). out may alias
+//! either input.
+//!
+//! \param[in] left array of count left-hand operands
+//! \param[in] right array of count right-hand operands
+//! \param[out] out array of count vectors receiving the results
+//! \param[in] count number of cross products to compute
+void
+SimdVec3CrossProductBatch(const struct vec3 *left, const struct vec3 *right, struct vec3 *out, int count);
+
+//! \brief Multiply count matrices by a single matrix
+//!
+//! Equivalent to out[i] = Mat4x4Multiply(left[i], *right). out may alias left.
+//!
+//! \param[in] left array of count left-hand matrices
+//! \param[in] right the right-hand matrix shared by every product
+//! \param[out] out array of count matrices receiving the results
+//! \param[in] count number of products to compute
+void
+SimdMat4x4MultiplyBatch(const struct mat4x4 *left, const struct mat4x4 *right, struct mat4x4 *out, int count);
+
+//! \brief Classify count spheres against a frustum
+//!
+//! Equivalent to results[i] = FrustumTestSphere(frustum, spheres[i]). Four
+//! spheres are tested against each plane at once.
+//!
+//! \param[in] frustum the frustum to test against
+//! \param[in] spheres array of count spheres to test
+//! \param[out] results array receiving FRUSTUM_OUTSIDE, FRUSTUM_INTERSECT or FRUSTUM_INSIDE for each sphere
+//! \param[in] count number of spheres to test
+void
+SimdFrustumTestSpheres(const struct frustum *frustum, const struct sphere *spheres, int *results, int count);
+
+#endif // SIMD_VERSION
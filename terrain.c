@@ -0,0 +1,601 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: terrain.c
+  Created: 2026-10-18
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+#include <stdlib.h> // malloc, calloc, free
+#include <string.h> // memset, strlen, strrchr
+#include <stdio.h> // printf, fopen, snprintf, rename
+#include <float.h> // FLT_MAX
+#include <math.h> // sqrtf
+#include <unistd.h> // sysconf
+#include <sys/stat.h> // stat
+
+#include "terrain.h"
+#include "mesh.h"
+#include "obj.h"
+#include "graphics.h"
+
+//! Identifies a terrain index file.
+#define TERRAIN_MAGIC 0x4E525433
+
+//! Bumped whenever the index layout changes.
+#define TERRAIN_FORMAT 1
+
+//! \brief The start of a terrain index file
+//!
+//! Followed by chunksX * chunksZ struct terrain_index_chunk records.
+struct terrain_index_header {
+        uint32_t magic; //!< TERRAIN_MAGIC
+        uint32_t version; //!< TERRAIN_FORMAT
+        uint32_t headerSize; //!< sizeof(struct terrain_index_header)
+        int32_t flags; //!< MESH_LOAD_* flags the chunks were built with
+        int32_t chunksX;
+        int32_t chunksZ;
+        uint64_t sourceSize; //!< size of the obj file
+        int64_t sourceTime; //!< modification time of the obj file in nanoseconds
+        struct aabb bounds;
+};
+
+//! \brief A chunk's record in a terrain index file
+struct terrain_index_chunk {
+        struct aabb bounds;
+        uint64_t size; //!< bytes in the chunk's mesh cache file, or 0 if the chunk is empty
+};
+
+//! \brief Size and modification time of a file
+//!
+//! \param[in] file path to the file
+//! \param[out] size size of the file in bytes
+//! \param[out] time modification time in nanoseconds
+//! \return 1 on success, otherwise 0
+int TerrainStat(char *file, uint64_t *size, int64_t *time) {
+        struct stat info;
+        if (0 != stat(file, &info)) {
+                return 0;
+        }
+        *size = (uint64_t)info.st_size;
+        *time = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+        return 1;
+}
+
+//! \brief Path of the obj file a terrain is built from
+//!
+//! \param[in] file path of the terrain's index file
+//! \return a newly allocated path to be freed by the caller
+char *TerrainSourcePath(char *file) {
+        size_t length = strlen(file);
+        char *dot = strrchr(file, '.');
+        char *slash = strrchr(file, '/');
+        if (NULL != dot && (NULL == slash || dot > slash)) {
+                length = (size_t)(dot - file);
+        }
+
+        char *path = (char *)malloc(length + sizeof(".obj"));
+        memcpy(path, file, length);
+        memcpy(path + length, ".obj", sizeof(".obj"));
+        return path;
+}
+
+char *TerrainChunkPath(char *file, int chunk, int placeholder) {
+        // Room for the chunk number, its dots and the longest suffix.
+        size_t size = strlen(file) + 16 + sizeof(".placeholder.mesh");
+        char *path = (char *)malloc(size);
+        snprintf(path, size, "%s.%d%s", file, chunk, placeholder ? ".placeholder.mesh" : ".mesh");
+        return path;
+}
+
+//! \brief Make a standalone copy of a mesh's simplest level of detail
+//!
+//! Only the vertices the level uses are kept.
+//!
+//! \param[in] mesh the mesh to simplify
+//! \return the new mesh
+struct mesh *TerrainPlaceholderInit(struct mesh *mesh) {
+        unsigned int *indices = mesh->indices;
+        int triCount = mesh->triCount;
+        if (mesh->lodCount > 0) {
+                indices = mesh->lods[mesh->lodCount - 1].indices;
+                triCount = mesh->lods[mesh->lodCount - 1].triCount;
+        }
+
+        int *remap = (int *)malloc(sizeof(int) * mesh->vertexCount);
+        for (int i = 0; i < mesh->vertexCount; i++) {
+                remap[i] = -1;
+        }
+
+        struct mesh *placeholder = MeshInit(triCount * 3, triCount);
+        int vertexCount = 0;
+        for (int i = 0; i < triCount * 3; i++) {
+                unsigned int index = indices[i];
+                if (remap[index] < 0) {
+                        remap[index] = vertexCount;
+                        placeholder->positions[vertexCount] = mesh->positions[index];
+                        placeholder->normals[vertexCount] = mesh->normals[index];
+                        placeholder->uvs[vertexCount] = mesh->uvs[index];
+                        vertexCount++;
+                }
+                placeholder->indices[i] = (unsigned int)remap[index];
+        }
+        free(remap);
+
+        placeholder->vertexCount = vertexCount;
+        placeholder->importedNormals = mesh->importedNormals;
+        MeshBuildBVH(placeholder, MESH_BVH_LEAF_SIZE);
+        MeshComputeFacePlanes(placeholder);
+        MeshComputeBounds(placeholder);
+        return placeholder;
+}
+
+//! \brief Write a terrain index file
+//!
+//! \param[in] file path of the index file
+//! \param[in] header the index's header
+//! \param[in] chunks header->chunksX * header->chunksZ chunk records
+//! \return 1 on success, otherwise 0
+int TerrainWriteIndex(char *file, struct terrain_index_header *header, struct terrain_index_chunk *chunks) {
+        size_t length = strlen(file);
+        char *temporary = (char *)malloc(length + sizeof(".tmp"));
+        memcpy(temporary, file, length);
+        memcpy(temporary + length, ".tmp", sizeof(".tmp"));
+
+        FILE *out = fopen(temporary, "wb");
+        if (NULL == out) {
+                fprintf(stderr, "Couldn't create %s\n", temporary);
+                free(temporary);
+                return 0;
+        }
+
+        size_t count = (size_t)header->chunksX * header->chunksZ;
+        int ok = 1 == fwrite(header, sizeof(struct terrain_index_header), 1, out);
+        ok = ok && count == fwrite(chunks, sizeof(struct terrain_index_chunk), count, out);
+        ok = (0 == fclose(out)) && ok;
+
+        if (!ok || 0 != rename(temporary, file)) {
+                fprintf(stderr, "Couldn't write %s\n", file);
+                remove(temporary);
+                free(temporary);
+                return 0;
+        }
+
+        free(temporary);
+        return 1;
+}
+
+//! \brief Grow the box from min to max to contain point
+void TerrainExtend(struct vec3 *min, struct vec3 *max, struct vec3 point) {
+        for (int a = 0; a < 3; a++) {
+                if (point.p[a] < min->p[a]) min->p[a] = point.p[a];
+                if (point.p[a] > max->p[a]) max->p[a] = point.p[a];
+        }
+}
+
+int TerrainBuild(char *objFile, char *file, int chunks, int flags, struct job_system *jobs) {
+        struct obj *obj = ObjInit(objFile, jobs);
+        if (NULL == obj) {
+                return 0;
+        }
+
+        struct terrain_index_header header;
+        memset(&header, 0, sizeof(struct terrain_index_header));
+        header.magic = TERRAIN_MAGIC;
+        header.version = TERRAIN_FORMAT;
+        header.headerSize = sizeof(struct terrain_index_header);
+        header.flags = flags & ~MESH_LOAD_CACHE;
+        header.chunksX = chunks;
+        header.chunksZ = chunks;
+        if (!TerrainStat(objFile, &header.sourceSize, &header.sourceTime)) {
+                fprintf(stderr, "Couldn't stat %s\n", objFile);
+                ObjDeinit(obj);
+                return 0;
+        }
+
+        struct vec3 min = Vec3Init(FLT_MAX, FLT_MAX, FLT_MAX);
+        struct vec3 max = Vec3Init(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (int i = 0; i < obj->positionCount; i++) {
+                TerrainExtend(&min, &max, obj->positions[i]);
+        }
+        float width = max.x - min.x > 0.0f ? max.x - min.x : 1.0f;
+        float depth = max.z - min.z > 0.0f ? max.z - min.z : 1.0f;
+
+        // Each triangle belongs to the cell its centroid lies over.
+        int *groups = (int *)malloc(sizeof(int) * (obj->triCount > 0 ? obj->triCount : 1));
+        for (int t = 0; t < obj->triCount; t++) {
+                struct vec3 centroid = Vec3Init(0.0f, 0.0f, 0.0f);
+                for (int c = 0; c < 3; c++) {
+                        centroid = Vec3Add(centroid, obj->positions[obj->corners[t * 3 + c].position]);
+                }
+                int x = (int)((centroid.x / 3.0f - min.x) / width * (float)chunks);
+                int z = (int)((centroid.z / 3.0f - min.z) / depth * (float)chunks);
+                x = x < 0 ? 0 : (x >= chunks ? chunks - 1 : x);
+                z = z < 0 ? 0 : (z >= chunks ? chunks - 1 : z);
+                groups[t] = z * chunks + x;
+        }
+
+        struct terrain_index_chunk *records = (struct terrain_index_chunk *)calloc(chunks * chunks, sizeof(struct terrain_index_chunk));
+        header.bounds.min = max;
+        header.bounds.max = min;
+
+        struct vec3 *normalSums = MeshObjNormalSums(obj);
+        int ok = 1;
+        for (int i = 0; ok && i < chunks * chunks; i++) {
+                struct mesh *mesh = MeshInitFromObjGroup(obj, groups, i, normalSums, header.flags);
+                if (0 == mesh->triCount) {
+                        MeshDeinit(mesh);
+                        continue;
+                }
+
+                struct mesh *placeholder = TerrainPlaceholderInit(mesh);
+                char *path = TerrainChunkPath(file, i, 0);
+                char *placeholderPath = TerrainChunkPath(file, i, 1);
+                ok = MeshWriteCache(mesh, path, NULL, header.flags, 1) &&
+                     MeshWriteCache(placeholder, placeholderPath, NULL, 0, 1);
+
+                int64_t time;
+                ok = ok && TerrainStat(path, &records[i].size, &time);
+                records[i].bounds = mesh->bounds;
+                TerrainExtend(&header.bounds.min, &header.bounds.max, mesh->bounds.min);
+                TerrainExtend(&header.bounds.min, &header.bounds.max, mesh->bounds.max);
+
+                free(placeholderPath);
+                free(path);
+                MeshDeinit(placeholder);
+                MeshDeinit(mesh);
+        }
+
+        ok = ok && TerrainWriteIndex(file, &header, records);
+
+        free(normalSums);
+        free(records);
+        free(groups);
+        ObjDeinit(obj);
+        return ok;
+}
+
+//! \brief Read a terrain's index and placeholders
+//!
+//! \param[in,out] terrain the terrain being initialized, with file and flags set
+//! \param[in] sourceFile path of the obj file the index must be up to date with
+//! \return 1 on success, otherwise 0, with anything read released
+int TerrainOpen(struct terrain *terrain, char *sourceFile) {
+        FILE *in = fopen(terrain->file, "rb");
+        if (NULL == in) {
+                return 0;
+        }
+
+        struct terrain_index_header header;
+        int valid = 1 == fread(&header, sizeof(struct terrain_index_header), 1, in) &&
+                    TERRAIN_MAGIC == header.magic && TERRAIN_FORMAT == header.version &&
+                    sizeof(struct terrain_index_header) == header.headerSize &&
+                    (terrain->flags & ~MESH_LOAD_CACHE) == header.flags &&
+                    header.chunksX > 0 && header.chunksZ > 0 && header.chunksX <= 4096 && header.chunksZ <= 4096;
+
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        valid = valid && TerrainStat(sourceFile, &sourceSize, &sourceTime) &&
+                sourceSize == header.sourceSize && sourceTime == header.sourceTime;
+
+        int count = valid ? header.chunksX * header.chunksZ : 0;
+        struct terrain_index_chunk *records = (struct terrain_index_chunk *)malloc(sizeof(struct terrain_index_chunk) * (count > 0 ? count : 1));
+        valid = valid && (size_t)count == fread(records, sizeof(struct terrain_index_chunk), count, in);
+        fclose(in);
+        if (!valid) {
+                free(records);
+                return 0;
+        }
+
+        terrain->chunksX = header.chunksX;
+        terrain->chunksZ = header.chunksZ;
+        terrain->bounds = header.bounds;
+        terrain->chunks = (struct terrain_chunk *)calloc(count, sizeof(struct terrain_chunk));
+        for (int i = 0; valid && i < count; i++) {
+                struct terrain_chunk *chunk = &terrain->chunks[i];
+                chunk->bounds = records[i].bounds;
+                chunk->size = records[i].size;
+                if (0 == chunk->size) {
+                        continue;
+                }
+
+                char *path = TerrainChunkPath(terrain->file, i, 1);
+                chunk->placeholder = MeshInitFromCache(path, NULL, 0, NULL);
+                free(path);
+                if (NULL == chunk->placeholder) {
+                        valid = 0;
+                        break;
+                }
+                terrain->stats.placeholderBytes += chunk->placeholder->mappingSize;
+        }
+        free(records);
+
+        if (!valid) {
+                for (int i = 0; i < count; i++) {
+                        MeshDeinit(terrain->chunks[i].placeholder);
+                }
+                free(terrain->chunks);
+                terrain->chunks = NULL;
+                terrain->stats.placeholderBytes = 0;
+                return 0;
+        }
+
+        return 1;
+}
+
+//! \brief Read every page of a mesh mapped from a cache file
+//!
+//! Run by the paging thread so the frame drawing the mesh never faults on
+//! a page that is still on disk.
+//!
+//! \param[in] mesh the mapped mesh
+void TerrainTouch(struct mesh *mesh) {
+        long page = sysconf(_SC_PAGESIZE);
+        if (page <= 0) {
+                page = 4096;
+        }
+
+        volatile unsigned char *bytes = (volatile unsigned char *)mesh->mapping;
+        unsigned char sum = 0;
+        for (size_t offset = 0; offset < mesh->mappingSize; offset += (size_t)page) {
+                sum ^= bytes[offset];
+        }
+        (void)sum;
+}
+
+//! \brief Body of the paging thread
+//!
+//! Reads requested chunks one at a time, nearest first, and hands them to
+//! TerrainUpdate(). The lock is never held while reading.
+//!
+//! \param[in,out] data the struct terrain to page
+//! \return NULL
+void *TerrainPagingThread(void *data) {
+        struct terrain *terrain = (struct terrain *)data;
+        int count = terrain->chunksX * terrain->chunksZ;
+
+        pthread_mutex_lock(&terrain->mutex);
+        while (!terrain->quit) {
+                int next = -1;
+                for (int i = 0; i < count; i++) {
+                        if (TERRAIN_CHUNK_REQUESTED == terrain->chunks[terrain->order[i]].state) {
+                                next = terrain->order[i];
+                                break;
+                        }
+                }
+                if (next < 0) {
+                        pthread_cond_wait(&terrain->wake, &terrain->mutex);
+                        continue;
+                }
+
+                struct terrain_chunk *chunk = &terrain->chunks[next];
+                chunk->state = TERRAIN_CHUNK_LOADING;
+                pthread_mutex_unlock(&terrain->mutex);
+
+                char *path = TerrainChunkPath(terrain->file, next, 0);
+                struct mesh *mesh = MeshInitFromCache(path, NULL, terrain->flags, NULL);
+                if (NULL != mesh) {
+                        TerrainTouch(mesh);
+                } else {
+                        fprintf(stderr, "Couldn't read terrain chunk %s\n", path);
+                }
+                free(path);
+
+                pthread_mutex_lock(&terrain->mutex);
+                chunk->loaded = mesh;
+                chunk->state = TERRAIN_CHUNK_LOADED;
+        }
+        pthread_mutex_unlock(&terrain->mutex);
+
+        return NULL;
+}
+
+struct terrain *TerrainInit(char *file, int flags, uint64_t budget, struct job_system *jobs) {
+        struct terrain *terrain = (struct terrain *)malloc(sizeof(struct terrain));
+        memset(terrain, 0, sizeof(struct terrain));
+        terrain->file = strdup(file);
+        terrain->flags = flags & ~MESH_LOAD_CACHE;
+        terrain->transform = Mat4x4Identity();
+        terrain->stats.budget = budget;
+
+        char *sourceFile = TerrainSourcePath(file);
+        int ok = TerrainOpen(terrain, sourceFile);
+        if (!ok) {
+                ok = TerrainBuild(sourceFile, file, TERRAIN_CHUNKS, terrain->flags, jobs) &&
+                     TerrainOpen(terrain, sourceFile);
+        }
+        free(sourceFile);
+        if (!ok) {
+                fprintf(stderr, "Couldn't load terrain %s\n", file);
+                free(terrain->file);
+                free(terrain);
+                return NULL;
+        }
+
+        int count = terrain->chunksX * terrain->chunksZ;
+        terrain->order = (int *)malloc(sizeof(int) * count);
+        terrain->scores = (float *)malloc(sizeof(float) * count);
+        for (int i = 0; i < count; i++) {
+                terrain->order[i] = i;
+                terrain->scores[i] = FLT_MAX;
+        }
+
+        pthread_mutex_init(&terrain->mutex, NULL);
+        pthread_cond_init(&terrain->wake, NULL);
+        if (0 != pthread_create(&terrain->thread, NULL, TerrainPagingThread, terrain)) {
+                fprintf(stderr, "Couldn't start the terrain paging thread\n");
+                pthread_cond_destroy(&terrain->wake);
+                pthread_mutex_destroy(&terrain->mutex);
+                terrain->quit = 1;
+                TerrainDeinit(terrain);
+                return NULL;
+        }
+
+        return terrain;
+}
+
+void TerrainDeinit(struct terrain *terrain) {
+        if (NULL == terrain) {
+                return;
+        }
+
+        // quit is only set beforehand if the thread never started.
+        if (!terrain->quit) {
+                pthread_mutex_lock(&terrain->mutex);
+                terrain->quit = 1;
+                pthread_cond_broadcast(&terrain->wake);
+                pthread_mutex_unlock(&terrain->mutex);
+                pthread_join(terrain->thread, NULL);
+                pthread_cond_destroy(&terrain->wake);
+                pthread_mutex_destroy(&terrain->mutex);
+        }
+
+        for (int i = 0; i < terrain->chunksX * terrain->chunksZ; i++) {
+                MeshDeinit(terrain->chunks[i].mesh);
+                MeshDeinit(terrain->chunks[i].loaded);
+                MeshDeinit(terrain->chunks[i].placeholder);
+        }
+        free(terrain->chunks);
+        free(terrain->order);
+        free(terrain->scores);
+        free(terrain->file);
+        free(terrain);
+}
+
+void TerrainUpdate(struct terrain *terrain, struct vec3 camera, struct vec3 lookDir) {
+        if (0 != pthread_mutex_trylock(&terrain->mutex)) {
+                return;
+        }
+
+        int count = terrain->chunksX * terrain->chunksZ;
+        struct terrain_stats *stats = &terrain->stats;
+        terrain->camera = camera;
+
+        // Chunks are ranked by distance over the xz plane from a point ahead
+        // of the camera, so those being moved towards load first. Chunks
+        // already wanted get a head start so they don't thrash at the edge
+        // of the budget.
+        float chunkWidth = (terrain->bounds.max.x - terrain->bounds.min.x) / (float)terrain->chunksX;
+        float chunkDepth = (terrain->bounds.max.z - terrain->bounds.min.z) / (float)terrain->chunksZ;
+        float size = chunkWidth > chunkDepth ? chunkWidth : chunkDepth;
+        float length = sqrtf(lookDir.x * lookDir.x + lookDir.z * lookDir.z);
+        float lead = length > 0.0f ? TERRAIN_PREFETCH * size / length : 0.0f;
+        float focusX = camera.x + lookDir.x * lead;
+        float focusZ = camera.z + lookDir.z * lead;
+
+        for (int i = 0; i < count; i++) {
+                struct terrain_chunk *chunk = &terrain->chunks[i];
+                if (TERRAIN_CHUNK_LOADED == chunk->state) {
+                        if (NULL == chunk->loaded) {
+                                chunk->state = TERRAIN_CHUNK_FAILED;
+                                stats->bytes -= chunk->size;
+                        } else {
+                                chunk->mesh = chunk->loaded;
+                                chunk->loaded = NULL;
+                                chunk->lod = 0;
+                                chunk->state = TERRAIN_CHUNK_RESIDENT;
+                                stats->loads++;
+                        }
+                }
+
+                if (NULL == chunk->placeholder || TERRAIN_CHUNK_FAILED == chunk->state) {
+                        terrain->scores[i] = FLT_MAX;
+                        continue;
+                }
+                float dx = (chunk->bounds.min.x + chunk->bounds.max.x) * 0.5f - focusX;
+                float dz = (chunk->bounds.min.z + chunk->bounds.max.z) * 0.5f - focusZ;
+                terrain->scores[i] = sqrtf(dx * dx + dz * dz);
+                if (TERRAIN_CHUNK_UNLOADED != chunk->state) {
+                        terrain->scores[i] -= size * 0.25f;
+                }
+        }
+
+        // Insertion sort: the order barely changes from one update to the next.
+        for (int i = 1; i < count; i++) {
+                int chunk = terrain->order[i];
+                int j = i;
+                while (j > 0 && terrain->scores[terrain->order[j - 1]] > terrain->scores[chunk]) {
+                        terrain->order[j] = terrain->order[j - 1];
+                        j--;
+                }
+                terrain->order[j] = chunk;
+        }
+
+        // The nearest chunks that fit in the budget are wanted.
+        int wanted = 0;
+        uint64_t wantedBytes = 0;
+        while (wanted < count) {
+                struct terrain_chunk *chunk = &terrain->chunks[terrain->order[wanted]];
+                if (FLT_MAX == terrain->scores[terrain->order[wanted]] || wantedBytes + chunk->size > stats->budget) {
+                        break;
+                }
+                wantedBytes += chunk->size;
+                wanted++;
+        }
+
+        // Evict the rest first, making room for the loads below. Chunks
+        // being read are left alone and evicted once they arrive.
+        for (int i = wanted; i < count; i++) {
+                struct terrain_chunk *chunk = &terrain->chunks[terrain->order[i]];
+                if (TERRAIN_CHUNK_RESIDENT == chunk->state) {
+                        MeshDeinit(chunk->mesh);
+                        chunk->mesh = NULL;
+                        chunk->state = TERRAIN_CHUNK_UNLOADED;
+                        stats->bytes -= chunk->size;
+                        stats->evictions++;
+                } else if (TERRAIN_CHUNK_REQUESTED == chunk->state) {
+                        chunk->state = TERRAIN_CHUNK_UNLOADED;
+                        stats->bytes -= chunk->size;
+                }
+        }
+
+        int requested = 0;
+        for (int i = 0; i < wanted; i++) {
+                struct terrain_chunk *chunk = &terrain->chunks[terrain->order[i]];
+                if (TERRAIN_CHUNK_UNLOADED == chunk->state && stats->bytes + chunk->size <= stats->budget) {
+                        chunk->state = TERRAIN_CHUNK_REQUESTED;
+                        stats->bytes += chunk->size;
+                        requested = 1;
+                }
+        }
+
+        stats->resident = 0;
+        stats->pending = 0;
+        for (int i = 0; i < count; i++) {
+                enum terrain_chunk_state state = terrain->chunks[i].state;
+                stats->resident += TERRAIN_CHUNK_RESIDENT == state;
+                stats->pending += TERRAIN_CHUNK_REQUESTED == state || TERRAIN_CHUNK_LOADING == state || TERRAIN_CHUNK_LOADED == state;
+        }
+
+        if (requested) {
+                pthread_cond_signal(&terrain->wake);
+        }
+        pthread_mutex_unlock(&terrain->mutex);
+}
+
+void TerrainRecord(struct terrain *terrain, struct graphics_command_buffer *buffer, struct material material) {
+        terrain->stats.placeholders = 0;
+        for (int i = 0; i < terrain->chunksX * terrain->chunksZ; i++) {
+                struct terrain_chunk *chunk = &terrain->chunks[i];
+                if (NULL != chunk->mesh) {
+                        GraphicsRecordDrawMeshInstanced(buffer, chunk->mesh, &terrain->transform, &chunk->lod, 1, material);
+                } else if (NULL != chunk->placeholder) {
+                        GraphicsRecordDrawMeshInstanced(buffer, chunk->placeholder, &terrain->transform, &chunk->placeholderLod, 1, material);
+                        terrain->stats.placeholders++;
+                }
+        }
+}
+
+void TerrainDebug(struct terrain *terrain, char *name) {
+        struct terrain_stats *stats = &terrain->stats;
+        printf("%s: %d resident, %d pending, %d placeholders, %d loads, %d evictions, %.1f of %.1f KiB (placeholders %.1f KiB)\n",
+               name, stats->resident, stats->pending, stats->placeholders, stats->loads, stats->evictions,
+               (double)stats->bytes / 1024.0, (double)stats->budget / 1024.0, (double)stats->placeholderBytes / 1024.0);
+}
@@ -0,0 +1,192 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: terrain.h
+  Created: 2026-10-18
+  Updated: 2026-10-18
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file terrain.h
+//! Terrain streamed from disk in chunks.
+//!
+//! A terrain is an obj file cut into a grid of chunks over the xz plane.
+//! Each chunk is stored as a mesh cache file of its own, along with a much
+//! coarser placeholder made from its simplest level of detail. An index file
+//! records the grid and each chunk's bounds and size.
+//!
+//! Placeholders are always resident. Full chunks are loaded by a paging
+//! thread, nearest first, until a memory budget is reached; chunks ahead of
+//! the camera count as nearer than those behind it. Whatever isn't resident
+//! is drawn with its placeholder, so frames never wait on the disk.
+//!
+//! Only the thread that created the terrain may update or draw it.
+
+#ifndef TERRAIN_VERSION
+#define TERRAIN_VERSION "0.1.0" //!< include guard
+
+#include <stdint.h> // uint64_t
+#include <pthread.h> // pthread_t, pthread_mutex_t, pthread_cond_t
+
+#include "math.h"
+
+struct mesh;
+struct job_system;
+struct graphics_command_buffer;
+struct material;
+
+//! Chunks along each side of the grid when a terrain is built.
+#define TERRAIN_CHUNKS 8
+
+//! How far ahead of the camera chunks are prefetched, in chunk widths.
+#define TERRAIN_PREFETCH 1.5f
+
+//! Lifecycle of a chunk's full mesh
+enum terrain_chunk_state {
+        TERRAIN_CHUNK_UNLOADED, //!< not resident and not wanted
+        TERRAIN_CHUNK_REQUESTED, //!< waiting for the paging thread
+        TERRAIN_CHUNK_LOADING, //!< being read by the paging thread
+        TERRAIN_CHUNK_LOADED, //!< read, not yet picked up by TerrainUpdate()
+        TERRAIN_CHUNK_RESIDENT, //!< drawn in place of the placeholder
+        TERRAIN_CHUNK_FAILED, //!< couldn't be read; the placeholder is used for good
+};
+
+//! \brief One cell of a terrain's grid
+struct terrain_chunk {
+        struct aabb bounds; //!< world space bounds of the full mesh
+        uint64_t size; //!< bytes the full mesh occupies when resident
+        struct mesh *placeholder; //!< always resident coarse mesh, or NULL if the cell is empty
+        struct mesh *mesh; //!< full mesh while resident, otherwise NULL
+        struct mesh *loaded; //!< full mesh handed over by the paging thread
+        enum terrain_chunk_state state; //!< shared with the paging thread
+        int lod; //!< level of detail the full mesh was last drawn at
+        int placeholderLod; //!< level of detail the placeholder was last drawn at
+};
+
+//! \brief Counters describing the state of a terrain's paging
+struct terrain_stats {
+        int resident; //!< chunks drawn in full
+        int pending; //!< chunks requested or being read
+        int placeholders; //!< non-empty chunks drawn with their placeholder
+        int loads; //!< chunks read since the terrain was initialized
+        int evictions; //!< chunks evicted since the terrain was initialized
+        uint64_t bytes; //!< bytes of full meshes resident or being read
+        uint64_t budget; //!< most bytes of full meshes allowed
+        uint64_t placeholderBytes; //!< bytes of placeholders, which are always resident
+};
+
+//! \brief A streamed terrain and its paging thread
+struct terrain {
+        char *file; //!< path of the index file
+        int flags; //!< MESH_LOAD_* flags the chunks were built with
+        int chunksX; //!< chunks along the x axis
+        int chunksZ; //!< chunks along the z axis
+        struct terrain_chunk *chunks; //!< chunksX * chunksZ chunks, row by row along x
+        struct aabb bounds; //!< world space bounds of the whole terrain
+        struct mat4x4 transform; //!< identity; chunks are in world space
+
+        struct vec3 camera; //!< camera position at the last update
+        struct terrain_stats stats;
+
+        // Chunks ordered nearest first, rebuilt every update. The paging
+        // thread takes the first requested chunk in this order.
+        int *order;
+        float *scores;
+
+        pthread_t thread;
+        pthread_mutex_t mutex; //!< guards state, loaded and order
+        pthread_cond_t wake;
+        int quit;
+};
+
+//! \brief Initialize a terrain and start paging it
+//!
+//! file names the index; the obj file it's built from has the same path
+//! with .obj in place of the index's extension. If the index is missing,
+//! malformed or older than the obj file, the terrain is first rebuilt with
+//! TerrainBuild(). Only the placeholders are read here.
+//!
+//! \param[in] file path of the index file, usually ending in .terrain
+//! \param[in] flags bitwise or of MESH_LOAD_* flags to build chunks with
+//! \param[in] budget most bytes of full chunk meshes to keep resident
+//! \param[in,out] jobs job system to parse the obj file on if the terrain must be built, or NULL
+//! \return the terrain, or NULL if it couldn't be read or built
+struct terrain *
+TerrainInit(char *file, int flags, uint64_t budget, struct job_system *jobs);
+
+//! \brief Stop the paging thread and de-initialize a terrain
+//!
+//! Nothing may be drawing the terrain's meshes.
+//!
+//! \param[in,out] terrain the terrain to be de-initialized
+void
+TerrainDeinit(struct terrain *terrain);
+
+//! \brief Cut an obj file into chunks and write them out as a terrain
+//!
+//! Each triangle goes to the chunk its centroid lies over. Every non-empty
+//! chunk is built with MeshInitFromObjGroup() and written with
+//! MeshWriteCache(), followed by its placeholder. The index is written
+//! last, so an interrupted build is never mistaken for a finished one.
+//!
+//! The whole obj file is held in memory while building.
+//!
+//! \param[in] objFile path of the obj file to read
+//! \param[in] file path of the index file to write
+//! \param[in] chunks chunks along each side of the grid
+//! \param[in] flags bitwise or of MESH_LOAD_* flags to build chunks with
+//! \param[in,out] jobs job system to parse the obj file on, or NULL
+//! \return 1 on success, otherwise 0
+int
+TerrainBuild(char *objFile, char *file, int chunks, int flags, struct job_system *jobs);
+
+//! \brief Path of a chunk's mesh cache file
+//!
+//! \param[in] file path of the terrain's index file
+//! \param[in] chunk index of the chunk
+//! \param[in] placeholder 1 for the chunk's placeholder, 0 for its full mesh
+//! \return a newly allocated path to be freed by the caller
+char *
+TerrainChunkPath(char *file, int chunk, int placeholder);
+
+//! \brief Pick up loaded chunks, evict unwanted ones and queue new loads
+//!
+//! Chunks are ranked by their distance from a point TERRAIN_PREFETCH chunk
+//! widths ahead of the camera along lookDir, and wanted nearest first while
+//! they fit in the budget. Resident chunks no longer wanted are evicted
+//! straight away, so this must be called between frames, before the
+//! terrain is recorded. Never waits: if the paging thread holds the lock,
+//! the update is skipped until the next call.
+//!
+//! \param[in,out] terrain the terrain to update
+//! \param[in] camera world space camera position
+//! \param[in] lookDir world space direction the camera faces
+void
+TerrainUpdate(struct terrain *terrain, struct vec3 camera, struct vec3 lookDir);
+
+//! \brief Record a draw of every chunk into a command buffer
+//!
+//! Resident chunks are drawn in full; the rest with their placeholders. The
+//! recorded meshes stay valid until the next TerrainUpdate().
+//!
+//! \param[in,out] terrain the terrain to draw
+//! \param[in,out] buffer the command buffer to append to
+//! \param[in] material surface properties of every chunk
+void
+TerrainRecord(struct terrain *terrain, struct graphics_command_buffer *buffer, struct material material);
+
+//! \brief Print a terrain's paging counters
+//!
+//! \param[in] terrain the terrain to describe
+//! \param[in] name label printed with the counters
+void
+TerrainDebug(struct terrain *terrain, char *name);
+
+#endif // TERRAIN_VERSION
@@ -0,0 +1,138 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: arena_test.c
+  Created: 2026-10-19
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file arena_test.c
+
+#include "gstest.h"
+#include "../arena.c"
+
+int TestAlloc() {
+        struct arena *arena = ArenaInit(1000);
+        GSTestAssert(NULL == arena->blocks && 0 == arena->reserved, "memory was reserved before the first allocation");
+
+        // Fill every allocation with its own byte, then check none was
+        // overwritten by a later one.
+        unsigned char *ptrs[100];
+        size_t sizes[100];
+        for (int i = 0; i < 100; i++) {
+                sizes[i] = (size_t)(i * 37 % 300);
+                ptrs[i] = (unsigned char *)ArenaAlloc(arena, sizes[i]);
+                GSTestAssert(NULL != ptrs[i], "allocation %d failed", i);
+                GSTestAssert(0 == (uintptr_t)ptrs[i] % ARENA_ALIGNMENT, "allocation %d isn't aligned", i);
+                memset(ptrs[i], i, sizes[i]);
+        }
+        for (int i = 0; i < 100; i++) {
+                for (size_t b = 0; b < sizes[i]; b++) {
+                        GSTestAssert(i == ptrs[i][b], "allocation %d was overwritten", i);
+                }
+        }
+
+        GSTestAssert(arena->used == arena->peak, "used %zu but peak %zu", arena->used, arena->peak);
+        GSTestAssert(arena->used <= arena->reserved, "used %zu of %zu reserved", arena->used, arena->reserved);
+        GSTestAssert(arena->blockAllocations < 10, "%d blocks allocated", arena->blockAllocations);
+
+        GSTestAssert(NULL == ArenaAlloc(arena, SIZE_MAX), "allocated SIZE_MAX bytes");
+        GSTestAssert(NULL == ArenaAlloc(arena, SIZE_MAX - ARENA_ALIGNMENT), "allocated nearly SIZE_MAX bytes");
+
+        ArenaDeinit(arena);
+        ArenaDeinit(NULL);
+        return 1;
+}
+
+int TestGrow() {
+        struct arena *arena = ArenaInit(4096);
+
+        // The latest allocation grows in place while its block has room.
+        unsigned char *first = (unsigned char *)ArenaAlloc(arena, 100);
+        memset(first, 1, 100);
+        unsigned char *grown = (unsigned char *)ArenaGrow(arena, first, 100, 1000);
+        GSTestAssert(first == grown, "latest allocation moved while growing");
+        GSTestAssert(1024 == arena->used, "used %zu bytes, not 1024", arena->used);
+        grown = (unsigned char *)ArenaGrow(arena, grown, 1000, 500);
+        GSTestAssert(first == grown && 1024 == arena->used, "shrinking moved or released memory");
+
+        // Anything else is copied.
+        unsigned char *second = (unsigned char *)ArenaAlloc(arena, 10);
+        grown = (unsigned char *)ArenaGrow(arena, first, 100, 200);
+        GSTestAssert(first != grown && second != grown, "grew an earlier allocation in place");
+        for (int b = 0; b < 100; b++) {
+                GSTestAssert(1 == grown[b], "byte %d wasn't copied", b);
+        }
+
+        // As is the latest allocation once its block runs out.
+        unsigned char *moved = (unsigned char *)ArenaGrow(arena, grown, 200, 100000);
+        GSTestAssert(grown != moved, "grew past the end of a block");
+        for (int b = 0; b < 100; b++) {
+                GSTestAssert(1 == moved[b], "byte %d wasn't copied to a new block", b);
+        }
+
+        GSTestAssert(NULL != ArenaGrow(arena, NULL, 0, 50), "growing NULL didn't allocate");
+
+        ArenaDeinit(arena);
+        return 1;
+}
+
+int TestReset() {
+        struct arena *arena = ArenaInit(256);
+
+        // Overflow into several blocks, then reset into one holding them all.
+        size_t used = 0;
+        for (int i = 0; i < 50; i++) {
+                ArenaAlloc(arena, 1000);
+                used += 1024;
+        }
+        GSTestAssert(NULL != arena->blocks->next, "50 allocations fit in one block");
+        GSTestAssert(used == arena->used, "used %zu, not %zu", arena->used, used);
+        size_t reserved = arena->reserved;
+
+        ArenaReset(arena);
+        GSTestAssert(NULL == arena->blocks->next, "blocks weren't merged");
+        GSTestAssert(reserved == arena->reserved, "reset reserved %zu, not %zu", arena->reserved, reserved);
+        GSTestAssert(0 == arena->used && used == arena->peak, "used %zu and peak %zu after reset", arena->used, arena->peak);
+
+        // The same workload now never allocates a block.
+        int blocks = arena->blockAllocations;
+        for (int frame = 0; frame < 10; frame++) {
+                for (int i = 0; i < 50; i++) {
+                        ArenaAlloc(arena, 1000);
+                }
+                ArenaReset(arena);
+        }
+        GSTestAssert(blocks == arena->blockAllocations, "%d more blocks allocated", arena->blockAllocations - blocks);
+        GSTestAssert(used == arena->peak, "peak %zu, not %zu", arena->peak, used);
+
+        // A workload that grows slowly, from 50 allocations to 149, doubles
+        // the arena twice; each time a block is allocated to overflow into
+        // and another to merge into.
+        for (int frame = 0; frame < 100; frame++) {
+                for (int i = 0; i < 50 + frame; i++) {
+                        ArenaAlloc(arena, 1000);
+                }
+                ArenaReset(arena);
+        }
+        GSTestAssert(4 == arena->blockAllocations - blocks, "%d more blocks allocated, not 4", arena->blockAllocations - blocks);
+
+        ArenaDeinit(arena);
+        return 1;
+}
+
+int main(int argc, char **argv) {
+        GSTestRun(TestAlloc);
+        GSTestRun(TestGrow);
+        GSTestRun(TestReset);
+
+        return GSTestSummary("arena");
+}
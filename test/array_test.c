@@ -0,0 +1,113 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: array_test.c
+  Created: 2026-10-19
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file array_test.c
+
+#include "gstest.h"
+#include "../array.c"
+
+//! \brief An element larger than a pointer, to catch stride mistakes
+struct element {
+        int value;
+        char padding[20];
+};
+
+int TestPushGet() {
+        struct array *array = ArrayInit(sizeof(struct element), 0);
+        GSTestAssert(NULL != array && 0 == array->count, "couldn't initialize an empty array");
+        GSTestAssert(NULL == ArrayGet(array, 0), "got an element from an empty array");
+
+        // Push one and several at a time, growing through many doublings.
+        int pushed = 0;
+        for (int round = 0; round < 200; round++) {
+                int count = 1 + round % 7;
+                struct element *first = (struct element *)ArrayPush(array, count);
+                GSTestAssert(NULL != first, "push of %d failed", count);
+                for (int i = 0; i < count; i++) {
+                        first[i].value = pushed++;
+                }
+        }
+        GSTestAssert(pushed == array->count, "%d elements, not %d", array->count, pushed);
+        GSTestAssert(array->capacity >= array->count && array->capacity < 2 * array->count, "capacity %d for %d elements", array->capacity, array->count);
+
+        for (int i = 0; i < pushed; i++) {
+                struct element *element = (struct element *)ArrayGet(array, i);
+                GSTestAssert(NULL != element && i == element->value, "element %d is wrong", i);
+        }
+        GSTestAssert(NULL == ArrayGet(array, -1), "got element -1");
+        GSTestAssert(NULL == ArrayGet(array, pushed), "got an element past the end");
+
+        // Pushing nothing returns where the next element would go.
+        GSTestAssert(NULL != ArrayPush(array, 0) && pushed == array->count, "pushing nothing failed or grew the array");
+        GSTestAssert(NULL == ArrayPush(array, -1), "pushed -1 elements");
+        GSTestAssert(NULL == ArrayPush(array, INT_MAX), "pushed INT_MAX more elements");
+        GSTestAssert(pushed == array->count, "failed pushes changed the count");
+
+        ArrayDeinit(array);
+        ArrayDeinit(NULL);
+        return 1;
+}
+
+int TestTruncateReset() {
+        struct array *array = ArrayInit(sizeof(int), 4);
+        GSTestAssert(4 == array->capacity, "capacity %d, not 4", array->capacity);
+
+        int *values = (int *)ArrayPush(array, 10);
+        for (int i = 0; i < 10; i++) {
+                values[i] = i;
+        }
+        int capacity = array->capacity;
+
+        // Truncating only ever shortens.
+        ArrayTruncate(array, 20);
+        GSTestAssert(10 == array->count, "truncating to 20 made %d elements", array->count);
+        ArrayTruncate(array, -1);
+        GSTestAssert(10 == array->count, "truncating to -1 made %d elements", array->count);
+        ArrayTruncate(array, 6);
+        GSTestAssert(6 == array->count && NULL == ArrayGet(array, 6), "truncating to 6 made %d elements", array->count);
+        GSTestAssert(5 == *(int *)ArrayGet(array, 5), "truncating changed the elements kept");
+
+        // Resetting keeps the storage, so refilling doesn't allocate.
+        unsigned char *data = array->data;
+        ArrayReset(array);
+        GSTestAssert(0 == array->count && capacity == array->capacity, "reset left %d elements and capacity %d", array->count, array->capacity);
+        GSTestAssert(NULL != ArrayPush(array, capacity), "refilling failed");
+        GSTestAssert(data == array->data, "refilling moved the storage");
+
+        ArrayDeinit(array);
+        return 1;
+}
+
+int TestHugeElements() {
+        // Too large to ever hold more than one element.
+        struct array *array = ArrayInit(SIZE_MAX / 2, 1);
+        GSTestAssert(NULL == array, "allocated an element of SIZE_MAX / 2 bytes");
+
+        array = ArrayInit(SIZE_MAX / 4, 0);
+        GSTestAssert(NULL != array, "couldn't initialize an empty array of huge elements");
+        GSTestAssert(NULL == ArrayPush(array, 8), "pushed 8 elements of SIZE_MAX / 4 bytes");
+        GSTestAssert(0 == array->count, "a failed push changed the count");
+        ArrayDeinit(array);
+        return 1;
+}
+
+int main(int argc, char **argv) {
+        GSTestRun(TestPushGet);
+        GSTestRun(TestTruncateReset);
+        GSTestRun(TestHugeElements);
+
+        return GSTestSummary("array");
+}
@@ -0,0 +1,90 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: graphics_test.c
+  Created: 2026-10-19
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file graphics_test.c
+
+#include "gstest.h"
+#include "../graphics.c"
+
+//! Screen height the tests project onto.
+#define TEST_HEIGHT 480
+
+//! \brief A unit bounding sphere with three levels of detail, each coarser than the last
+static struct mesh TestMesh() {
+        struct mesh mesh;
+        memset(&mesh, 0, sizeof(struct mesh));
+        mesh.sphere.center = Vec3Init(0.0f, 0.0f, 0.0f);
+        mesh.sphere.radius = 1.0f;
+        mesh.lodCount = 3;
+        mesh.lods[0].error = 0.001f;
+        mesh.lods[1].error = 0.01f;
+        mesh.lods[2].error = 0.1f;
+        return mesh;
+}
+
+//! \brief Scale uniformly, then move away from the camera
+static struct mat4x4 ScaleAndMove(float scale, float distance) {
+        struct mat4x4 mat = Mat4x4Identity();
+        mat.m[0][0] = scale;
+        mat.m[1][1] = scale;
+        mat.m[2][2] = scale;
+        mat.m[3][2] = distance;
+        return mat;
+}
+
+int TestSelectLODUnitScale() {
+        struct mesh mesh = TestMesh();
+        struct mat4x4 proj = Mat4x4Project(90.0f, 0.75f, 0.1f, 1000.0f);
+
+        struct mat4x4 near = ScaleAndMove(1.0f, 2.0f);
+        int level = GraphicsSelectLOD(&mesh, &near, 1.0f, &proj, TEST_HEIGHT, 0);
+        GSTestAssert(1 == level, "level %d up close, not 1", level);
+
+        struct mat4x4 far = ScaleAndMove(1.0f, 1000.0f);
+        level = GraphicsSelectLOD(&mesh, &far, 1.0f, &proj, TEST_HEIGHT, 0);
+        GSTestAssert(3 == level, "level %d far away, not 3", level);
+
+        struct mat4x4 inside = ScaleAndMove(1.0f, 0.5f);
+        level = GraphicsSelectLOD(&mesh, &inside, 1.0f, &proj, TEST_HEIGHT, 3);
+        GSTestAssert(0 == level, "level %d inside the sphere, not 0", level);
+        return 1;
+}
+
+int TestSelectLODScaled() {
+        struct mesh mesh = TestMesh();
+        struct mat4x4 proj = Mat4x4Project(90.0f, 0.75f, 0.1f, 1000.0f);
+
+        // Four times larger and four times further away looks the same, so
+        // it must be drawn at the same level.
+        struct mat4x4 unit = ScaleAndMove(1.0f, 10.0f);
+        struct mat4x4 scaled = ScaleAndMove(4.0f, 40.0f);
+        int unitLevel = GraphicsSelectLOD(&mesh, &unit, 1.0f, &proj, TEST_HEIGHT, 0);
+        int scaledLevel = GraphicsSelectLOD(&mesh, &scaled, 4.0f, &proj, TEST_HEIGHT, 0);
+        GSTestAssert(unitLevel == scaledLevel, "level %d scaled, not %d", scaledLevel, unitLevel);
+
+        // Four times larger at the same distance needs more detail.
+        struct mat4x4 closer = ScaleAndMove(4.0f, 10.0f);
+        int closerLevel = GraphicsSelectLOD(&mesh, &closer, 4.0f, &proj, TEST_HEIGHT, 0);
+        GSTestAssert(closerLevel < unitLevel, "level %d scaled up, not finer than %d", closerLevel, unitLevel);
+        return 1;
+}
+
+int main(int argc, char **argv) {
+        GSTestRun(TestSelectLODUnitScale);
+        GSTestRun(TestSelectLODScaled);
+
+        return GSTestSummary("graphics");
+}
@@ -0,0 +1,73 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: gstest.h
+  Created: 2026-10-19
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file gstest.h
+//! A minimal unit test harness.
+//!
+//! Each test is a function taking no arguments and returning 1 if it passed.
+//! GSTestAssert() reports a failed check and returns 0 from the test.
+//! GSTestRun() runs a test and tallies the result, and GSTestSummary() prints
+//! the tally and returns the exit status for main.
+//!
+//! Every test file is one translation unit and includes this header once; it
+//! usually includes the .c file under test as well, so static functions can
+//! be tested and the Makefile leaves that module out when linking.
+
+#ifndef GSTEST_VERSION
+#define GSTEST_VERSION "0.1.0" //!< include guard
+
+#include <stdio.h> // fprintf, printf
+#include <stdlib.h> // EXIT_SUCCESS, EXIT_FAILURE
+
+static int gsTestPassed = 0; //!< tests that passed so far
+static int gsTestFailed = 0; //!< tests that failed so far
+
+//! \brief Fail the current test unless a condition holds
+//!
+//! \param[in] expr condition to check
+//! \param[in] ... printf format and arguments describing the failure
+#define GSTestAssert(expr, ...) \
+        do { \
+                if (!(expr)) { \
+                        fprintf(stderr, "%s:%d: %s: ", __FILE__, __LINE__, __func__); \
+                        fprintf(stderr, __VA_ARGS__); \
+                        fprintf(stderr, "\n"); \
+                        return 0; \
+                } \
+        } while (0)
+
+//! \brief Run a test and tally its result
+//!
+//! \param[in] test function taking no arguments and returning 1 on success
+#define GSTestRun(test) \
+        do { \
+                if (test()) { \
+                        gsTestPassed++; \
+                } else { \
+                        fprintf(stderr, "FAIL %s\n", #test); \
+                        gsTestFailed++; \
+                } \
+        } while (0)
+
+//! \brief Print how many tests passed and failed
+//!
+//! \param[in] name label printed with the tally
+//! \return EXIT_SUCCESS if every test passed, EXIT_FAILURE otherwise
+#define GSTestSummary(name) \
+        (printf("%s: %d passed, %d failed\n", (name), gsTestPassed, gsTestFailed), \
+         0 == gsTestFailed ? EXIT_SUCCESS : EXIT_FAILURE)
+
+#endif // GSTEST_VERSION
@@ -0,0 +1,199 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: job_test.c
+  Created: 2026-10-19
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file job_test.c
+
+#include "gstest.h"
+#include "../job.c"
+
+//! Thieves racing the owner in TestDequeConcurrent().
+#define TEST_THIEVES 3
+//! Jobs pushed per round of TestDequeConcurrent().
+#define TEST_BATCH 1000
+//! Rounds of TestDequeConcurrent().
+#define TEST_ROUNDS 200
+
+static struct job jobs[JOB_DEQUE_SIZE];
+static struct job_deque deque;
+
+static atomic_int claimed[TEST_BATCH];
+static atomic_int stolen;
+static atomic_int done;
+
+int TestDequeOwner() {
+        memset(&deque, 0, sizeof(deque));
+        GSTestAssert(NULL == JobDequeTake(&deque), "took from an empty deque");
+        GSTestAssert(NULL == JobDequeSteal(&deque), "stole from an empty deque");
+
+        for (int i = 0; i < JOB_DEQUE_SIZE; i++) {
+                GSTestAssert(JobDequePush(&deque, &jobs[i]), "push %d failed", i);
+        }
+        GSTestAssert(!JobDequePush(&deque, &jobs[0]), "pushed onto a full deque");
+
+        // The owner takes the newest jobs and thieves steal the oldest.
+        GSTestAssert(&jobs[JOB_DEQUE_SIZE - 1] == JobDequeTake(&deque), "didn't take the newest job");
+        GSTestAssert(&jobs[0] == JobDequeSteal(&deque), "didn't steal the oldest job");
+        GSTestAssert(&jobs[1] == JobDequeSteal(&deque), "didn't steal the next oldest job");
+        for (int i = JOB_DEQUE_SIZE - 2; i >= 2; i--) {
+                struct job *job = JobDequeTake(&deque);
+                GSTestAssert(&jobs[i] == job, "took job %d, not %d", (int)(job - jobs), i);
+        }
+        GSTestAssert(NULL == JobDequeTake(&deque), "took from an emptied deque");
+        GSTestAssert(NULL == JobDequeSteal(&deque), "stole from an emptied deque");
+
+        // Indices wrap around the ring once it has been used.
+        for (int i = 0; i < 10; i++) {
+                GSTestAssert(JobDequePush(&deque, &jobs[i]), "push %d after wrapping failed", i);
+        }
+        for (int i = 0; i < 10; i++) {
+                struct job *job = JobDequeSteal(&deque);
+                GSTestAssert(&jobs[i] == job, "stole job %d after wrapping, not %d", (int)(job - jobs), i);
+        }
+        return 1;
+}
+
+static void *Thief(void *arg) {
+        while (!atomic_load(&done)) {
+                struct job *job = JobDequeSteal(&deque);
+                if (NULL != job) {
+                        atomic_fetch_add(&claimed[job - jobs], 1);
+                        atomic_fetch_add(&stolen, 1);
+                }
+        }
+        return NULL;
+}
+
+int TestDequeConcurrent() {
+        memset(&deque, 0, sizeof(deque));
+        for (int i = 0; i < TEST_BATCH; i++) {
+                atomic_init(&claimed[i], 0);
+        }
+        atomic_init(&stolen, 0);
+        atomic_init(&done, 0);
+
+        pthread_t thieves[TEST_THIEVES];
+        for (int i = 0; i < TEST_THIEVES; i++) {
+                pthread_create(&thieves[i], NULL, Thief, NULL);
+        }
+
+        // Push a batch a few jobs at a time, taking one after each few, then
+        // take whatever the thieves leave.
+        for (int round = 0; round < TEST_ROUNDS; round++) {
+                for (int i = 0; i < TEST_BATCH; i++) {
+                        JobDequePush(&deque, &jobs[i]);
+                        if (3 == i % 4) {
+                                struct job *job = JobDequeTake(&deque);
+                                if (NULL != job) {
+                                        atomic_fetch_add(&claimed[job - jobs], 1);
+                                }
+                        }
+                }
+                struct job *job;
+                while (NULL != (job = JobDequeTake(&deque))) {
+                        atomic_fetch_add(&claimed[job - jobs], 1);
+                }
+        }
+
+        atomic_store(&done, 1);
+        for (int i = 0; i < TEST_THIEVES; i++) {
+                pthread_join(thieves[i], NULL);
+        }
+
+        for (int i = 0; i < TEST_BATCH; i++) {
+                int count = atomic_load(&claimed[i]);
+                GSTestAssert(TEST_ROUNDS == count, "job %d claimed %d times, not %d", i, count, TEST_ROUNDS);
+        }
+        printf("thieves stole %d of %d jobs\n", atomic_load(&stolen), TEST_BATCH * TEST_ROUNDS);
+        return 1;
+}
+
+static atomic_int visits[10000];
+
+static void Visit(void *data, int first, int count) {
+        for (int i = first; i < first + count; i++) {
+                atomic_fetch_add(&visits[i], 1);
+        }
+}
+
+int TestParallelFor() {
+        struct job_system *system = JobSystemInit(4);
+        GSTestAssert(NULL != system, "couldn't start a job system");
+
+        int count = (int)(sizeof(visits) / sizeof(visits[0]));
+        for (int chunkSize = 1; chunkSize <= 1000; chunkSize *= 10) {
+                for (int i = 0; i < count; i++) {
+                        atomic_init(&visits[i], 0);
+                }
+                JobParallelFor(system, Visit, NULL, count, chunkSize);
+                for (int i = 0; i < count; i++) {
+                        int n = atomic_load(&visits[i]);
+                        GSTestAssert(1 == n, "index %d visited %d times with chunks of %d", i, n, chunkSize);
+                }
+        }
+
+        JobSystemDeinit(system);
+        return 1;
+}
+
+static atomic_int sequence;
+
+static void Stamp(void *data) {
+        atomic_int *stamp = *(atomic_int **)data;
+        atomic_store(stamp, atomic_fetch_add(&sequence, 1) + 1);
+}
+
+int TestDependencies() {
+        struct job_system *system = JobSystemInit(4);
+        GSTestAssert(NULL != system, "couldn't start a job system");
+
+        for (int round = 0; round < 100; round++) {
+                atomic_int first, second, child;
+                atomic_init(&first, 0);
+                atomic_init(&second, 0);
+                atomic_init(&child, 0);
+                atomic_init(&sequence, 0);
+
+                atomic_int *stamp = &first;
+                struct job *a = JobCreate(system, Stamp, &stamp, sizeof(stamp), NULL);
+                stamp = &second;
+                struct job *b = JobCreate(system, Stamp, &stamp, sizeof(stamp), NULL);
+                stamp = &child;
+                struct job *c = JobCreate(system, Stamp, &stamp, sizeof(stamp), b);
+                JobDependsOn(b, a);
+
+                // b is run first but has to wait for a.
+                JobRun(system, b);
+                JobRun(system, c);
+                JobRun(system, a);
+                JobWait(system, b);
+
+                GSTestAssert(0 != atomic_load(&first), "dependency didn't run");
+                GSTestAssert(atomic_load(&second) > atomic_load(&first), "job ran before its dependency");
+                GSTestAssert(0 != atomic_load(&child), "wait returned before a child finished");
+        }
+
+        JobSystemDeinit(system);
+        return 1;
+}
+
+int main(int argc, char **argv) {
+        GSTestRun(TestDequeOwner);
+        GSTestRun(TestDequeConcurrent);
+        GSTestRun(TestParallelFor);
+        GSTestRun(TestDependencies);
+
+        return GSTestSummary("job");
+}
@@ -0,0 +1,235 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: mesh_test.c
+  Created: 2026-10-19
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file mesh_test.c
+
+#include <math.h> // sinf, cosf, fabsf, acosf
+
+#include "gstest.h"
+#include "../mesh.c"
+
+//! Vertices along each side of the grid TestCorruptCache() builds.
+#define TEST_GRID 24
+
+//! Flags the cache in TestCorruptCache() is written and read with.
+#define TEST_FLAGS (MESH_LOAD_MESHLETS | MESH_LOAD_LODS)
+
+//! \brief Write a rippled, textured grid to a new temporary obj file
+//!
+//! \param[out] path room for the file's path; at least 32 bytes
+//! \return 1 on success, otherwise 0
+static int WriteGrid(char *path) {
+        strcpy(path, "/tmp/mesh_test_XXXXXX");
+        int fd = mkstemp(path);
+        if (fd < 0) {
+                return 0;
+        }
+        FILE *file = fdopen(fd, "w");
+        for (int z = 0; z < TEST_GRID; z++) {
+                for (int x = 0; x < TEST_GRID; x++) {
+                        fprintf(file, "v %d %f %d\n", x, sinf(x * 0.5f) * cosf(z * 0.3f), z);
+                        fprintf(file, "vt %f %f\n", (float)x / (TEST_GRID - 1), (float)z / (TEST_GRID - 1));
+                }
+        }
+        for (int z = 0; z + 1 < TEST_GRID; z++) {
+                for (int x = 0; x + 1 < TEST_GRID; x++) {
+                        int v = z * TEST_GRID + x + 1;
+                        int a = v + TEST_GRID;
+                        fprintf(file, "f %d/%d %d/%d %d/%d\n", v, v, a, a, v + 1, v + 1);
+                        fprintf(file, "f %d/%d %d/%d %d/%d\n", v + 1, v + 1, a, a, a + 1, a + 1);
+                }
+        }
+        return 0 == fclose(file);
+}
+
+//! \brief Write a copy of a cache file with one 32 bit word replaced
+//!
+//! \param[out] path room for the copy's path; at least 32 bytes
+//! \param[in] data contents of the cache file
+//! \param[in] size bytes of data
+//! \param[in] offset byte offset of the word to replace
+//! \param[in] value the word's new value
+//! \return 1 on success, otherwise 0
+static int WriteCorrupted(char *path, char *data, size_t size, uint64_t offset, uint32_t value) {
+        strcpy(path, "/tmp/mesh_test_XXXXXX");
+        int fd = mkstemp(path);
+        if (fd < 0) {
+                return 0;
+        }
+        uint32_t original;
+        memcpy(&original, data + offset, sizeof(uint32_t));
+        memcpy(data + offset, &value, sizeof(uint32_t));
+        int ok = write(fd, data, size) == (ssize_t)size;
+        memcpy(data + offset, &original, sizeof(uint32_t));
+        close(fd);
+        return ok;
+}
+
+//! \brief Whether MeshInitFromCache() rejects a copy of a cache file with one word replaced
+static int Rejects(char *data, size_t size, uint64_t offset, uint32_t value) {
+        char path[32];
+        if (!WriteCorrupted(path, data, size, offset, value)) {
+                return 0;
+        }
+        struct mesh *mesh = MeshInitFromCache(path, NULL, TEST_FLAGS, NULL);
+        unlink(path);
+        MeshDeinit(mesh);
+        return NULL == mesh;
+}
+
+//! \brief Load the grid WriteGrid() writes
+//!
+//! \param[in] flags MESH_LOAD_* flags to load it with
+//! \return the mesh, or NULL if it couldn't be written or loaded
+static struct mesh *LoadGrid(int flags) {
+        char objFile[32];
+        if (!WriteGrid(objFile)) {
+                return NULL;
+        }
+        int count;
+        struct mesh **meshes = MeshInitFromObj(objFile, flags, NULL, &count);
+        unlink(objFile);
+        if (NULL == meshes) {
+                return NULL;
+        }
+        struct mesh *mesh = meshes[0];
+        for (int i = 1; i < count; i++) {
+                MeshDeinit(meshes[i]);
+        }
+        free(meshes);
+        return mesh;
+}
+
+int TestCorruptCache() {
+        struct mesh *built = LoadGrid(TEST_FLAGS);
+        GSTestAssert(NULL != built, "couldn't load the grid");
+        GSTestAssert(built->nodeCount > 1 && built->meshletCount > 1 && built->lodCount > 0,
+                     "%d nodes, %d meshlets and %d levels of detail", built->nodeCount, built->meshletCount, built->lodCount);
+
+        char cacheFile[32];
+        strcpy(cacheFile, "/tmp/mesh_test_XXXXXX");
+        close(mkstemp(cacheFile));
+        GSTestAssert(MeshWriteCache(built, cacheFile, NULL, TEST_FLAGS, 1), "couldn't write the cache");
+
+        FILE *file = fopen(cacheFile, "rb");
+        fseek(file, 0, SEEK_END);
+        size_t size = (size_t)ftell(file);
+        fseek(file, 0, SEEK_SET);
+        char *data = (char *)malloc(size);
+        GSTestAssert(size == fread(data, 1, size, file), "couldn't read the cache");
+        fclose(file);
+
+        struct mesh *mesh = MeshInitFromCache(cacheFile, NULL, TEST_FLAGS, NULL);
+        unlink(cacheFile);
+        GSTestAssert(NULL != mesh, "couldn't load the intact cache");
+        GSTestAssert(built->triCount == mesh->triCount && built->nodeCount == mesh->nodeCount &&
+                     built->meshletCount == mesh->meshletCount && built->lodCount == mesh->lodCount,
+                     "the cache doesn't match the mesh");
+        MeshDeinit(mesh);
+
+        struct mesh_cache_header *header = (struct mesh_cache_header *)data;
+        uint32_t vertexCount = (uint32_t)header->vertexCount;
+        uint32_t nodeCount = (uint32_t)header->nodeCount;
+        uint32_t triCount = (uint32_t)header->triCount;
+
+        // Indices past the vertices, in the mesh and in a level of detail.
+        uint64_t index = header->indices + sizeof(unsigned int) * (3 * triCount - 1);
+        GSTestAssert(Rejects(data, size, index, vertexCount), "accepted an index past the vertices");
+        GSTestAssert(Rejects(data, size, index, UINT32_MAX), "accepted index UINT32_MAX");
+        uint64_t lodIndex = header->lods[header->lodCount - 1].indices;
+        GSTestAssert(Rejects(data, size, lodIndex, vertexCount), "accepted a level of detail index past the vertices");
+
+        // Children past the nodes, pointing back up the tree, or shared.
+        uint64_t rootLeft = header->nodes + offsetof(struct bvh_node, left);
+        uint64_t childLeft = rootLeft + sizeof(struct bvh_node);
+        GSTestAssert(Rejects(data, size, rootLeft, nodeCount - 1), "accepted a right child past the nodes");
+        GSTestAssert(Rejects(data, size, rootLeft, nodeCount), "accepted a child past the nodes");
+        GSTestAssert(Rejects(data, size, childLeft, 0x7FFFFFFF), "accepted child INT_MAX");
+        GSTestAssert(Rejects(data, size, childLeft, 1), "accepted a node that is its own child");
+        struct bvh_node *nodes = (struct bvh_node *)(data + header->nodes);
+        GSTestAssert(0 != nodes[1].left, "the root's left child is a leaf");
+        GSTestAssert(Rejects(data, size, childLeft + sizeof(struct bvh_node), (uint32_t)nodes[1].left), "accepted children shared by two nodes");
+
+        // Node and meshlet ranges past the triangles.
+        uint64_t rootCount = header->nodes + offsetof(struct bvh_node, triCount);
+        uint64_t childFirst = header->nodes + sizeof(struct bvh_node) + offsetof(struct bvh_node, firstTri);
+        GSTestAssert(Rejects(data, size, rootCount, triCount + 1), "accepted a root past the triangles");
+        GSTestAssert(Rejects(data, size, childFirst, triCount), "accepted a child range outside its parent");
+        uint64_t meshletFirst = header->meshlets + offsetof(struct meshlet, firstTri);
+        uint64_t meshletCount = header->meshlets + offsetof(struct meshlet, triCount);
+        GSTestAssert(Rejects(data, size, meshletFirst, triCount), "accepted a meshlet past the triangles");
+        GSTestAssert(Rejects(data, size, meshletCount, 0x80000000), "accepted a negative meshlet");
+        GSTestAssert(Rejects(data, size, meshletCount, triCount), "accepted overlapping meshlets");
+
+        // A truncated file.
+        GSTestAssert(Rejects(data, size - MESH_CACHE_ALIGNMENT, 0, MESH_CACHE_MAGIC), "accepted a truncated file");
+
+        free(data);
+        MeshDeinit(built);
+        return 1;
+}
+
+int TestQuantize() {
+        struct mesh *mesh = LoadGrid(0);
+        GSTestAssert(NULL != mesh, "couldn't load the grid");
+        int vertexCount = mesh->vertexCount;
+        struct vec3 *positions = (struct vec3 *)malloc(sizeof(struct vec3) * vertexCount);
+        struct vec3 *normals = (struct vec3 *)malloc(sizeof(struct vec3) * vertexCount);
+        struct vec2 *uvs = (struct vec2 *)malloc(sizeof(struct vec2) * vertexCount);
+        memcpy(positions, mesh->positions, sizeof(struct vec3) * vertexCount);
+        memcpy(normals, mesh->normals, sizeof(struct vec3) * vertexCount);
+        memcpy(uvs, mesh->uvs, sizeof(struct vec2) * vertexCount);
+
+        MeshQuantize(mesh);
+        GSTestAssert(NULL != mesh->packed, "no packed vertices");
+        GSTestAssert(NULL == mesh->positions && NULL == mesh->normals && NULL == mesh->uvs, "the float arrays weren't released");
+        GSTestAssert(!MeshWriteCache(mesh, "/tmp/mesh_test_quantized", NULL, 0, 1), "cached a quantized mesh");
+        GSTestAssert(mesh->uvScale.u > 0.0f && mesh->uvScale.v > 0.0f, "the texture coordinates weren't read");
+
+        // Every vertex decodes to within half a step, plus rounding.
+        struct mat4x4 unpack = MeshUnpackMatrix(mesh);
+        for (int i = 0; i < vertexCount; i++) {
+                struct mesh_vertex *vertex = &mesh->packed[i];
+                struct vec3 packed = Vec3Init((float)vertex->position[0], (float)vertex->position[1], (float)vertex->position[2]);
+                struct vec3 position = Mat4x4MultiplyVec3(unpack, packed);
+                for (int a = 0; a < 3; a++) {
+                        float error = fabsf(position.p[a] - positions[i].p[a]);
+                        GSTestAssert(error <= mesh->packScale.p[a] * 0.5f + 1e-4f, "vertex %d axis %d is off by %f", i, a, error);
+                }
+
+                struct vec2 uv = MeshUnpackUV(mesh, vertex);
+                GSTestAssert(fabsf(uv.u - uvs[i].u) <= mesh->uvScale.u * 0.5f + 1e-6f &&
+                             fabsf(uv.v - uvs[i].v) <= mesh->uvScale.v * 0.5f + 1e-6f,
+                             "vertex %d texture coordinates are off", i);
+
+                struct vec3 normal = MeshUnpackNormal(vertex);
+                float cosine = Vec3DotProduct(normal, normals[i]);
+                GSTestAssert(cosine > 0.999f, "vertex %d normal is off by %f degrees", i, acosf(cosine) * 180.0f / 3.14159265f);
+        }
+
+        free(positions);
+        free(normals);
+        free(uvs);
+        MeshDeinit(mesh);
+        return 1;
+}
+
+int main(int argc, char **argv) {
+        GSTestRun(TestCorruptCache);
+        GSTestRun(TestQuantize);
+
+        return GSTestSummary("mesh");
+}
@@ -0,0 +1,387 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: obj_test.c
+  Created: 2026-10-19
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file obj_test.c
+
+#include <math.h> // pow, sin, cos, sinf, cosf, sqrtf, fabsf
+
+#include "gstest.h"
+#include "../obj.c"
+
+//! \brief Write text to a new temporary file
+//!
+//! \param[out] path room for the file's path; at least 32 bytes
+//! \param[in] text the file's contents
+//! \param[in] size bytes of text
+//! \return 1 on success, otherwise 0
+static int WriteTemporary(char *path, const char *text, size_t size) {
+        strcpy(path, "/tmp/obj_test_XXXXXX");
+        int fd = mkstemp(path);
+        if (fd < 0) {
+                return 0;
+        }
+        int ok = write(fd, text, size) == (ssize_t)size;
+        close(fd);
+        return ok;
+}
+
+//! \brief Parse a NUL-terminated string with ObjParseFloat() and strtod()
+//!
+//! \param[in] text the number, possibly followed by more text
+//! \param[out] parsed number read by ObjParseFloat()
+//! \param[out] expected number read by strtod(), rounded to float
+//! \param[out] length characters ObjParseFloat() read
+//! \return ObjParseFloat()'s result
+static int ParseBoth(const char *text, float *parsed, float *expected, int *length) {
+        const char *cursor = text;
+        int ok = ObjParseFloat(&cursor, text + strlen(text), parsed);
+        *length = (int)(cursor - text);
+        *expected = (float)strtod(text, NULL);
+        return ok;
+}
+
+int TestParseFloat() {
+        const char *numbers[] = {
+                "0", "-0", "1", "-1.5", "+2.25", "3.14159", ".5", "5.", "-.125",
+                "1e5", "1E5", "1.5e-3", "-2.5E+7", "0.000001", "123456.789",
+                "0.1", "0.2", "0.3", "16777217", "3.4028235e38", "1e-30",
+                "1.17549435e-38", "12345678901234567890", "0.000000000000000000000000001",
+                "9007199254740993", "1.0000000000000000000001", "-0.0000001192092896",
+        };
+        for (int i = 0; i < (int)(sizeof(numbers) / sizeof(numbers[0])); i++) {
+                float parsed, expected;
+                int length;
+                GSTestAssert(ParseBoth(numbers[i], &parsed, &expected, &length), "%s wasn't parsed", numbers[i]);
+                GSTestAssert(0 == memcmp(&parsed, &expected, sizeof(float)), "%s parsed as %.9g, not %.9g", numbers[i], parsed, expected);
+                GSTestAssert((int)strlen(numbers[i]) == length, "%s stopped after %d characters", numbers[i], length);
+        }
+
+        // Every way an exporter might print a float.
+        char text[64];
+        unsigned int seed = 1;
+        const char *formats[] = { "%f", "%.9g", "%.17g", "%e", "%.3f" };
+        for (int i = 0; i < 100000; i++) {
+                seed = seed * 1664525u + 1013904223u;
+                double magnitude = pow(10.0, (double)(seed % 13) - 6.0);
+                double value = ((double)(seed >> 8) / (double)(1 << 24) - 0.5) * magnitude;
+                snprintf(text, sizeof(text), formats[i % 5], value);
+
+                float parsed, expected;
+                int length;
+                GSTestAssert(ParseBoth(text, &parsed, &expected, &length), "%s wasn't parsed", text);
+                GSTestAssert(0 == memcmp(&parsed, &expected, sizeof(float)), "%s parsed as %.9g, not %.9g", text, parsed, expected);
+        }
+        return 1;
+}
+
+int TestParseFloatBounds() {
+        float value = 0.0f;
+
+        const char *none[] = { "", "-", "+", ".", "-.", "e5", "x1" };
+        for (int i = 0; i < (int)(sizeof(none) / sizeof(none[0])); i++) {
+                const char *cursor = none[i];
+                GSTestAssert(!ObjParseFloat(&cursor, none[i] + strlen(none[i]), &value), "\"%s\" was parsed", none[i]);
+                GSTestAssert(none[i] == cursor, "\"%s\" moved the cursor", none[i]);
+        }
+
+        // An exponent marker without digits isn't part of the number.
+        const char *text = "2.5e/1";
+        const char *cursor = text;
+        GSTestAssert(ObjParseFloat(&cursor, text + strlen(text), &value) && 2.5f == value, "2.5e/1 wasn't parsed as 2.5");
+        GSTestAssert(text + 3 == cursor, "2.5e/1 stopped after %d characters, not 3", (int)(cursor - text));
+
+        // The text needn't be NUL-terminated; nothing past end is read.
+        text = "1.25e3";
+        cursor = text;
+        GSTestAssert(ObjParseFloat(&cursor, text + 4, &value) && 1.25f == value, "1.25 cut from 1.25e3 parsed as %g", value);
+        GSTestAssert(text + 4 == cursor, "1.25 cut from 1.25e3 stopped after %d characters", (int)(cursor - text));
+        cursor = text;
+        GSTestAssert(ObjParseFloat(&cursor, text + 5, &value) && 1.25f == value, "1.25e cut from 1.25e3 parsed as %g", value);
+        GSTestAssert(text + 4 == cursor, "1.25e cut from 1.25e3 stopped after %d characters", (int)(cursor - text));
+        return 1;
+}
+
+int TestParseInt() {
+        const char *text[] = { "42", "-7", "+3", "0", "2147483647", "99999999999", "-99999999999", "12/5" };
+        int expected[] = { 42, -7, 3, 0, INT32_MAX, INT32_MAX, -INT32_MAX, 12 };
+        int length[] = { 2, 2, 2, 1, 10, 11, 12, 2 };
+        for (int i = 0; i < (int)(sizeof(text) / sizeof(text[0])); i++) {
+                const char *cursor = text[i];
+                int value;
+                GSTestAssert(ObjParseInt(&cursor, text[i] + strlen(text[i]), &value), "%s wasn't parsed", text[i]);
+                GSTestAssert(expected[i] == value, "%s parsed as %d, not %d", text[i], value, expected[i]);
+                GSTestAssert(length[i] == (int)(cursor - text[i]), "%s stopped after %d characters", text[i], (int)(cursor - text[i]));
+        }
+
+        const char *none[] = { "", "-", "x", "/1" };
+        for (int i = 0; i < (int)(sizeof(none) / sizeof(none[0])); i++) {
+                const char *cursor = none[i];
+                int value;
+                GSTestAssert(!ObjParseInt(&cursor, none[i] + strlen(none[i]), &value), "\"%s\" was parsed", none[i]);
+                GSTestAssert(none[i] == cursor, "\"%s\" moved the cursor", none[i]);
+        }
+        return 1;
+}
+
+int TestParseParallel() {
+        // A grid a few OBJ_CHUNK_BYTES long, with relative indices and
+        // material changes falling in every chunk.
+        int side = 300;
+        size_t capacity = (size_t)side * side * 160 + 1024;
+        char *text = (char *)malloc(capacity);
+        size_t size = 0;
+        int triCount = 0;
+        size += sprintf(text + size, "# grid\nmtllib grid.mtl\n");
+        for (int z = 0; z < side; z++) {
+                for (int x = 0; x < side; x++) {
+                        size += sprintf(text + size, "v %d.5 %f -%d\nvt %f %f\nvn 0 1 0\n", x, sin(x * 0.1) * cos(z * 0.1), z, x / (float)side, z / (float)side);
+                }
+        }
+        for (int z = 0; z + 1 < side; z++) {
+                if (0 == z % 37) {
+                        size += sprintf(text + size, "usemtl m%d\n", z % 3);
+                }
+                for (int x = 0; x + 1 < side; x++) {
+                        int a = z * side + x + 1;
+                        if (x % 2) {
+                                size += sprintf(text + size, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n",
+                                                a, a, a, a + 1, a + 1, a + 1, a + side + 1, a + side + 1, a + side + 1, a + side, a + side, a + side);
+                                triCount += 2;
+                        } else {
+                                int n = side * side;
+                                size += sprintf(text + size, "f %d %d//%d %d/%d\n", a - n - 1, a + 1 - n - 1, a + 1, a + side, a + side);
+                                triCount++;
+                        }
+                }
+        }
+        GSTestAssert(size < capacity, "grid overflowed its buffer");
+        GSTestAssert(size > 3 * OBJ_CHUNK_BYTES, "grid is only %zu bytes", size);
+
+        char path[32];
+        int written = WriteTemporary(path, text, size);
+        free(text);
+        GSTestAssert(written, "couldn't write a temporary file");
+
+        struct job_system *jobs = JobSystemInit(4);
+        struct obj *serial = ObjInit(path, NULL);
+        struct obj *parallel = ObjInit(path, jobs);
+        unlink(path);
+        JobSystemDeinit(jobs);
+        GSTestAssert(NULL != serial && NULL != parallel, "couldn't parse the grid");
+
+        GSTestAssert(side * side == serial->positionCount, "%d positions, not %d", serial->positionCount, side * side);
+        GSTestAssert(triCount == serial->triCount, "%d triangles, not %d", serial->triCount, triCount);
+        GSTestAssert(3 == serial->materialCount, "%d materials, not 3", serial->materialCount);
+
+        GSTestAssert(serial->positionCount == parallel->positionCount && serial->texcoordCount == parallel->texcoordCount &&
+                     serial->normalCount == parallel->normalCount && serial->triCount == parallel->triCount &&
+                     serial->materialCount == parallel->materialCount, "parallel counts differ");
+        GSTestAssert(0 == memcmp(serial->positions, parallel->positions, sizeof(struct vec3) * serial->positionCount), "parallel positions differ");
+        GSTestAssert(0 == memcmp(serial->texcoords, parallel->texcoords, sizeof(struct vec2) * serial->texcoordCount), "parallel texcoords differ");
+        GSTestAssert(0 == memcmp(serial->normals, parallel->normals, sizeof(struct vec3) * serial->normalCount), "parallel normals differ");
+        GSTestAssert(0 == memcmp(serial->corners, parallel->corners, sizeof(struct obj_corner) * 3 * serial->triCount), "parallel corners differ");
+        GSTestAssert(0 == memcmp(serial->triMaterials, parallel->triMaterials, sizeof(int) * serial->triCount), "parallel materials differ");
+        for (int i = 0; i < serial->materialCount; i++) {
+                GSTestAssert(0 == strcmp(serial->materials[i], parallel->materials[i]), "parallel material %d differs", i);
+        }
+
+        ObjDeinit(serial);
+        ObjDeinit(parallel);
+        return 1;
+}
+
+//! Most vertices in a polygon the triangulation tests use.
+#define TEST_MAX_POLYGON 16
+
+//! \brief Twice the area of triangle abc, signed by its winding about normal
+static float TwiceArea(struct vec3 a, struct vec3 b, struct vec3 c, struct vec3 normal) {
+        return Vec3DotProduct(Vec3CrossProduct(Vec3Subtract(b, a), Vec3Subtract(c, a)), normal);
+}
+
+//! \brief Triangulate a polygon and check the triangles tile it exactly
+//!
+//! Triangles that all keep the polygon's winding and add up to its area can't
+//! overlap or leave gaps, so they're a valid triangulation. Collinear vertices
+//! may be clipped off as slivers with no area.
+//!
+//! \param[in] positions the polygon's vertices, in order
+//! \param[in] size number of vertices
+//! \param[out] out room for 3 * (size - 2) corners
+//! \return 1 if the triangulation is valid, otherwise 0
+static int Triangulates(struct vec3 *positions, int size, struct obj_corner *out) {
+        struct obj_corner face[TEST_MAX_POLYGON];
+        for (int i = 0; i < size; i++) {
+                face[i].position = i;
+                face[i].texcoord = 100 + i;
+                face[i].normal = 200 + i;
+        }
+
+        int *scratch = NULL;
+        int scratchCapacity = 0;
+        ObjTriangulate(positions, face, size, out, &scratch, &scratchCapacity);
+        free(scratch);
+
+        // The polygon's normal, scaled by twice its area.
+        struct vec3 normal = { 0 };
+        for (int i = 1; i + 1 < size; i++) {
+                struct vec3 cross = Vec3CrossProduct(Vec3Subtract(positions[i], positions[0]), Vec3Subtract(positions[i + 1], positions[0]));
+                normal.x += cross.x;
+                normal.y += cross.y;
+                normal.z += cross.z;
+        }
+        float polygonArea = sqrtf(Vec3DotProduct(normal, normal));
+        struct vec3 unit = Vec3Normalize(normal);
+
+        float area = 0.0f;
+        for (int t = 0; t < size - 2; t++) {
+                struct obj_corner *corners = &out[t * 3];
+                for (int c = 0; c < 3; c++) {
+                        GSTestAssert(corners[c].position >= 0 && corners[c].position < size, "triangle %d has vertex %d", t, corners[c].position);
+                        GSTestAssert(100 + corners[c].position == corners[c].texcoord && 200 + corners[c].position == corners[c].normal, "triangle %d lost a corner's attributes", t);
+                }
+                float twiceArea = TwiceArea(positions[corners[0].position], positions[corners[1].position], positions[corners[2].position], unit);
+                GSTestAssert(twiceArea >= -1e-4f * polygonArea, "triangle %d is wound backwards", t);
+                area += twiceArea;
+        }
+        GSTestAssert(fabsf(area - polygonArea) <= 1e-4f * polygonArea, "triangles cover %g, not %g", area, polygonArea);
+        return 1;
+}
+
+int TestTriangulateConvex() {
+        struct vec3 positions[6];
+        for (int i = 0; i < 6; i++) {
+                positions[i] = Vec3Init(cosf(i * 1.0472f), sinf(i * 1.0472f), 0.0f);
+        }
+
+        struct obj_corner out[12];
+        GSTestAssert(Triangulates(positions, 6, out), "hexagon wasn't triangulated");
+        for (int t = 0; t < 4; t++) {
+                GSTestAssert(0 == out[t * 3].position && t + 1 == out[t * 3 + 1].position && t + 2 == out[t * 3 + 2].position,
+                             "triangle %d isn't part of a fan around vertex 0", t);
+        }
+        return 1;
+}
+
+int TestTriangulateConcave() {
+        // An arrow pointing along x, with a notch at vertex 0 a fan around it
+        // would cross, and a comb with several notches; in both windings and
+        // tilted out of every axis plane.
+        static float arrow[][2] = {
+                { 1, 0 }, { 0, 1 }, { 3, 0 }, { 0, -1 }, { 0.5f, 0 },
+        };
+        static float comb[][2] = {
+                { 0, 0 }, { 5, 0 }, { 5, 3 }, { 4, 3 }, { 4, 1 },
+                { 3, 1 }, { 3, 3 }, { 1, 3 }, { 1, 1 }, { 0, 1 },
+        };
+        float (*polygons[])[2] = { arrow, comb };
+        int sizes[] = { 5, 10 };
+
+        struct mat4x4 tilt = Mat4x4Multiply(Mat4x4RotateX(0.7f), Mat4x4RotateY(-1.1f));
+        for (int p = 0; p < 2; p++) {
+                for (int variant = 0; variant < 4; variant++) {
+                        struct vec3 positions[TEST_MAX_POLYGON];
+                        for (int i = 0; i < sizes[p]; i++) {
+                                float *point = polygons[p][variant & 1 ? sizes[p] - 1 - i : i];
+                                positions[i] = Vec3Init(point[0], point[1], 0.0f);
+                                if (variant & 2) {
+                                        positions[i] = Mat4x4MultiplyVec3(tilt, positions[i]);
+                                }
+                        }
+                        struct obj_corner out[3 * TEST_MAX_POLYGON];
+                        GSTestAssert(Triangulates(positions, sizes[p], out), "polygon %d variant %d wasn't triangulated", p, variant);
+                }
+        }
+        return 1;
+}
+
+int TestTriangulateDegenerate() {
+        // No ears at all: every vertex on one line. The result is a fan, and
+        // the right number of triangles.
+        struct vec3 positions[5];
+        for (int i = 0; i < 5; i++) {
+                positions[i] = Vec3Init((float)i, 0.0f, 0.0f);
+        }
+        struct obj_corner face[5];
+        for (int i = 0; i < 5; i++) {
+                face[i].position = i;
+                face[i].texcoord = -1;
+                face[i].normal = -1;
+        }
+        struct obj_corner out[9];
+        memset(out, 0xff, sizeof(out));
+        int *scratch = NULL;
+        int scratchCapacity = 0;
+        ObjTriangulate(positions, face, 5, out, &scratch, &scratchCapacity);
+        free(scratch);
+        for (int c = 0; c < 9; c++) {
+                GSTestAssert(out[c].position >= 0 && out[c].position < 5, "corner %d is %d", c, out[c].position);
+        }
+        return 1;
+}
+
+int TestFaceForms() {
+        const char *text =
+                "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+                "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+                "vn 0 0 1\nvn 0 0 -1\n"
+                "f 1 2 3\n"
+                "f 1/1 2/2 3/3\n"
+                "f 1//2 2//2 3//1\n"
+                "f 1/4/1 2/3/2 3/2/1\n"
+                "f -4/-4/-2 -3/-3/-2 -2/-2/-2 -1/-1/-2\n";
+
+        char path[32];
+        GSTestAssert(WriteTemporary(path, text, strlen(text)), "couldn't write a temporary file");
+        struct obj *obj = ObjInit(path, NULL);
+        unlink(path);
+        GSTestAssert(NULL != obj, "couldn't parse the faces");
+        GSTestAssert(6 == obj->triCount, "%d triangles, not 6", obj->triCount);
+
+        struct obj_corner expected[] = {
+                { 0, -1, -1 }, { 1, -1, -1 }, { 2, -1, -1 },
+                { 0, 0, -1 }, { 1, 1, -1 }, { 2, 2, -1 },
+                { 0, -1, 1 }, { 1, -1, 1 }, { 2, -1, 0 },
+                { 0, 3, 0 }, { 1, 2, 1 }, { 2, 1, 0 },
+        };
+        for (int c = 0; c < 12; c++) {
+                struct obj_corner got = obj->corners[c];
+                GSTestAssert(expected[c].position == got.position && expected[c].texcoord == got.texcoord && expected[c].normal == got.normal,
+                             "corner %d is %d/%d/%d, not %d/%d/%d", c, got.position, got.texcoord, got.normal,
+                             expected[c].position, expected[c].texcoord, expected[c].normal);
+        }
+
+        // The quad, with relative indices, becomes two triangles.
+        for (int c = 12; c < 18; c++) {
+                struct obj_corner got = obj->corners[c];
+                GSTestAssert(got.position == got.texcoord && 0 == got.normal, "quad corner %d is %d/%d/%d", c, got.position, got.texcoord, got.normal);
+        }
+
+        ObjDeinit(obj);
+        return 1;
+}
+
+int main(int argc, char **argv) {
+        GSTestRun(TestParseFloat);
+        GSTestRun(TestParseFloatBounds);
+        GSTestRun(TestParseInt);
+        GSTestRun(TestParseParallel);
+        GSTestRun(TestTriangulateConvex);
+        GSTestRun(TestTriangulateConcave);
+        GSTestRun(TestTriangulateDegenerate);
+        GSTestRun(TestFaceForms);
+
+        return GSTestSummary("obj");
+}
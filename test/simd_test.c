@@ -0,0 +1,335 @@
+/******************************************************************************
+  GrooveStomp's 3D Software Renderer
+  Copyright (c) 2019 Aaron Oman (GrooveStomp)
+
+  File: simd_test.c
+  Created: 2026-10-19
+  Updated: 2026-10-19
+  Author: Aaron Oman
+  Notice: GNU GPLv3 License
+
+  Based off of: One Lone Coder Console Game Engine Copyright (C) 2018 Javidx9
+  This program comes with ABSOLUTELY NO WARRANTY.
+  This is free software, and you are welcome to redistribute it under certain
+  conditions; See LICENSE for details.
+ ******************************************************************************/
+
+//! \file simd_test.c
+//! Checks every function in simd.h against its scalar counterpart in math.h.
+//!
+//! simd.c is compiled in twice: once as built, using SSE where the compiler
+//! targets it, and once with SIMD_NO_SSE defined and its functions renamed,
+//! so the scalar fallback is tested on the same machine. Both must match
+//! math.c bit for bit.
+//!
+//! Run with the argument "bench" to time both paths against math.c instead.
+
+#include <string.h> // memcmp, strcmp
+#include <time.h> // clock_gettime
+
+#include "gstest.h"
+#include "../simd.c"
+
+#define SIMD_NO_SSE
+#define SimdMat4x4MultiplyVec3 ScalarMat4x4MultiplyVec3
+#define SimdMat4x4Multiply ScalarMat4x4Multiply
+#define SimdVec3TransformBatch ScalarVec3TransformBatch
+#define SimdVec3NormalizeBatch ScalarVec3NormalizeBatch
+#define SimdVec3CrossProductBatch ScalarVec3CrossProductBatch
+#define SimdMat4x4MultiplyBatch ScalarMat4x4MultiplyBatch
+#define SimdFrustumTestSpheres ScalarFrustumTestSpheres
+#include "../simd.c"
+#undef SimdMat4x4MultiplyVec3
+#undef SimdMat4x4Multiply
+#undef SimdVec3TransformBatch
+#undef SimdVec3NormalizeBatch
+#undef SimdVec3CrossProductBatch
+#undef SimdMat4x4MultiplyBatch
+#undef SimdFrustumTestSpheres
+
+//! Elements in each batch; not a multiple of four, so remainders are covered.
+#define TEST_COUNT 1027
+
+//! \brief One implementation of the simd.h API
+struct simd_impl {
+        char *name;
+        struct vec3 (*multiplyVec3)(const struct mat4x4 *, const struct vec3 *);
+        void (*multiply)(struct mat4x4 *, const struct mat4x4 *, const struct mat4x4 *);
+        void (*transformBatch)(const struct mat4x4 *, const struct vec3 *, struct vec3 *, int);
+        void (*normalizeBatch)(const struct vec3 *, struct vec3 *, int);
+        void (*crossProductBatch)(const struct vec3 *, const struct vec3 *, struct vec3 *, int);
+        void (*multiplyBatch)(const struct mat4x4 *, const struct mat4x4 *, struct mat4x4 *, int);
+        void (*frustumTestSpheres)(const struct frustum *, const struct sphere *, int *, int);
+};
+
+//! The implementations under test.
+static struct simd_impl impls[] = {
+        {
+                "simd",
+                SimdMat4x4MultiplyVec3, SimdMat4x4Multiply, SimdVec3TransformBatch, SimdVec3NormalizeBatch,
+                SimdVec3CrossProductBatch, SimdMat4x4MultiplyBatch, SimdFrustumTestSpheres,
+        },
+        {
+                "scalar",
+                ScalarMat4x4MultiplyVec3, ScalarMat4x4Multiply, ScalarVec3TransformBatch, ScalarVec3NormalizeBatch,
+                ScalarVec3CrossProductBatch, ScalarMat4x4MultiplyBatch, ScalarFrustumTestSpheres,
+        },
+};
+
+//! Number of implementations under test.
+#define IMPL_COUNT (int)(sizeof(impls) / sizeof(impls[0]))
+
+static unsigned int seed = 1;
+
+//! \brief A repeatable pseudo-random float in [-10, 10)
+static float Random() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / (float)(1 << 24) * 20.0f - 10.0f;
+}
+
+static struct vec3 RandomVec3() {
+        struct vec3 v;
+        v.x = Random();
+        v.y = Random();
+        v.z = Random();
+        v.w = Random();
+        return v;
+}
+
+static struct mat4x4 RandomMat4x4() {
+        struct mat4x4 m;
+        for (int row = 0; row < 4; row++) {
+                for (int col = 0; col < 4; col++) {
+                        m.m[row][col] = Random();
+                }
+        }
+        return m;
+}
+
+static struct vec3 in[TEST_COUNT];
+static struct vec3 in2[TEST_COUNT];
+static struct vec3 out[TEST_COUNT];
+static struct mat4x4 mats[TEST_COUNT];
+static struct mat4x4 matsOut[TEST_COUNT];
+static struct sphere spheres[TEST_COUNT];
+static int results[TEST_COUNT];
+
+static void RandomizeInputs() {
+        for (int i = 0; i < TEST_COUNT; i++) {
+                in[i] = RandomVec3();
+                in2[i] = RandomVec3();
+                mats[i] = RandomMat4x4();
+                spheres[i].center = RandomVec3();
+                spheres[i].center.w = 1.0f;
+                spheres[i].radius = Random() + 10.0f;
+        }
+}
+
+int TestMultiplyVec3() {
+        for (int m = 0; m < IMPL_COUNT; m++) {
+                for (int i = 0; i < TEST_COUNT; i++) {
+                        struct vec3 want = Mat4x4MultiplyVec3(mats[i], in[i]);
+                        struct vec3 got = impls[m].multiplyVec3(&mats[i], &in[i]);
+                        GSTestAssert(0 == memcmp(want.p, got.p, sizeof(want.p)), "%s: element %d differs", impls[m].name, i);
+                }
+        }
+        return 1;
+}
+
+int TestMultiply() {
+        for (int m = 0; m < IMPL_COUNT; m++) {
+                for (int i = 0; i + 1 < TEST_COUNT; i++) {
+                        struct mat4x4 want = Mat4x4Multiply(mats[i], mats[i + 1]);
+                        struct mat4x4 got;
+                        impls[m].multiply(&got, &mats[i], &mats[i + 1]);
+                        GSTestAssert(0 == memcmp(want.m, got.m, sizeof(want.m)), "%s: element %d differs", impls[m].name, i);
+
+                        got = mats[i];
+                        impls[m].multiply(&got, &got, &mats[i + 1]);
+                        GSTestAssert(0 == memcmp(want.m, got.m, sizeof(want.m)), "%s: element %d differs when out aliases left", impls[m].name, i);
+
+                        got = mats[i + 1];
+                        impls[m].multiply(&got, &mats[i], &got);
+                        GSTestAssert(0 == memcmp(want.m, got.m, sizeof(want.m)), "%s: element %d differs when out aliases right", impls[m].name, i);
+                }
+        }
+        return 1;
+}
+
+int TestTransformBatch() {
+        for (int m = 0; m < IMPL_COUNT; m++) {
+                impls[m].transformBatch(&mats[0], in, out, TEST_COUNT);
+                for (int i = 0; i < TEST_COUNT; i++) {
+                        struct vec3 want = Mat4x4MultiplyVec3(mats[0], in[i]);
+                        GSTestAssert(0 == memcmp(want.p, out[i].p, sizeof(want.p)), "%s: element %d differs", impls[m].name, i);
+                }
+        }
+        return 1;
+}
+
+int TestNormalizeBatch() {
+        for (int m = 0; m < IMPL_COUNT; m++) {
+                impls[m].normalizeBatch(in, out, TEST_COUNT);
+                for (int i = 0; i < TEST_COUNT; i++) {
+                        struct vec3 want = Vec3Normalize(in[i]);
+                        GSTestAssert(0 == memcmp(want.p, out[i].p, sizeof(want.p)), "%s: element %d differs", impls[m].name, i);
+                }
+        }
+        return 1;
+}
+
+int TestCrossProductBatch() {
+        for (int m = 0; m < IMPL_COUNT; m++) {
+                impls[m].crossProductBatch(in, in2, out, TEST_COUNT);
+                for (int i = 0; i < TEST_COUNT; i++) {
+                        struct vec3 want = Vec3CrossProduct(in[i], in2[i]);
+                        GSTestAssert(0 == memcmp(want.p, out[i].p, sizeof(want.p)), "%s: element %d differs", impls[m].name, i);
+                }
+        }
+        return 1;
+}
+
+int TestMultiplyBatch() {
+        for (int m = 0; m < IMPL_COUNT; m++) {
+                impls[m].multiplyBatch(mats, &mats[0], matsOut, TEST_COUNT);
+                for (int i = 0; i < TEST_COUNT; i++) {
+                        struct mat4x4 want = Mat4x4Multiply(mats[i], mats[0]);
+                        GSTestAssert(0 == memcmp(want.m, matsOut[i].m, sizeof(want.m)), "%s: element %d differs", impls[m].name, i);
+                }
+        }
+        return 1;
+}
+
+int TestFrustumTestSpheres() {
+        struct frustum frustum = FrustumInit(Mat4x4Project(90.0f, 0.75f, 0.1f, 20.0f));
+
+        int seen[3] = { 0 };
+        for (int m = 0; m < IMPL_COUNT; m++) {
+                impls[m].frustumTestSpheres(&frustum, spheres, results, TEST_COUNT);
+                for (int i = 0; i < TEST_COUNT; i++) {
+                        int want = FrustumTestSphere(&frustum, spheres[i]);
+                        GSTestAssert(want == results[i], "%s: sphere %d is %d, not %d", impls[m].name, i, results[i], want);
+                        seen[want] = 1;
+                }
+        }
+        GSTestAssert(seen[FRUSTUM_OUTSIDE] && seen[FRUSTUM_INTERSECT] && seen[FRUSTUM_INSIDE], "spheres don't cover every outcome");
+        return 1;
+}
+
+//! Vectors or matrices per benchmark pass; fits comfortably in L1 and L2.
+#define BENCH_COUNT 1024
+//! Passes over each benchmark's inputs.
+#define BENCH_PASSES 20000
+
+static double Seconds() {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+//! \brief Print the time taken per element since start
+static void BenchReport(char *what, char *name, double start, float checksum) {
+        double ns = (Seconds() - start) * 1e9 / ((double)BENCH_COUNT * BENCH_PASSES);
+        printf("%-20s %-8s %6.2f ns (checksum %g)\n", what, name, ns, checksum);
+}
+
+//! \brief Time math.c and every implementation in impls on the same inputs
+static void Bench() {
+        double start;
+        float sum;
+
+        start = Seconds();
+        sum = 0.0f;
+        for (int p = 0; p < BENCH_PASSES; p++) {
+                for (int i = 0; i < BENCH_COUNT; i++) {
+                        out[i] = Mat4x4MultiplyVec3(mats[0], in[i]);
+                }
+                sum += out[p % BENCH_COUNT].x;
+        }
+        BenchReport("transform", "math", start, sum);
+        for (int m = 0; m < IMPL_COUNT; m++) {
+                start = Seconds();
+                sum = 0.0f;
+                for (int p = 0; p < BENCH_PASSES; p++) {
+                        impls[m].transformBatch(&mats[0], in, out, BENCH_COUNT);
+                        sum += out[p % BENCH_COUNT].x;
+                }
+                BenchReport("transform", impls[m].name, start, sum);
+        }
+
+        start = Seconds();
+        sum = 0.0f;
+        for (int p = 0; p < BENCH_PASSES; p++) {
+                for (int i = 0; i < BENCH_COUNT; i++) {
+                        out[i] = Vec3Normalize(in[i]);
+                }
+                sum += out[p % BENCH_COUNT].x;
+        }
+        BenchReport("normalize", "math", start, sum);
+        for (int m = 0; m < IMPL_COUNT; m++) {
+                start = Seconds();
+                sum = 0.0f;
+                for (int p = 0; p < BENCH_PASSES; p++) {
+                        impls[m].normalizeBatch(in, out, BENCH_COUNT);
+                        sum += out[p % BENCH_COUNT].x;
+                }
+                BenchReport("normalize", impls[m].name, start, sum);
+        }
+
+        start = Seconds();
+        sum = 0.0f;
+        for (int p = 0; p < BENCH_PASSES; p++) {
+                for (int i = 0; i < BENCH_COUNT; i++) {
+                        out[i] = Vec3CrossProduct(in[i], in2[i]);
+                }
+                sum += out[p % BENCH_COUNT].x;
+        }
+        BenchReport("cross product", "math", start, sum);
+        for (int m = 0; m < IMPL_COUNT; m++) {
+                start = Seconds();
+                sum = 0.0f;
+                for (int p = 0; p < BENCH_PASSES; p++) {
+                        impls[m].crossProductBatch(in, in2, out, BENCH_COUNT);
+                        sum += out[p % BENCH_COUNT].x;
+                }
+                BenchReport("cross product", impls[m].name, start, sum);
+        }
+
+        start = Seconds();
+        sum = 0.0f;
+        for (int p = 0; p < BENCH_PASSES; p++) {
+                for (int i = 0; i < BENCH_COUNT; i++) {
+                        matsOut[i] = Mat4x4Multiply(mats[i], mats[0]);
+                }
+                sum += matsOut[p % BENCH_COUNT].m[0][0];
+        }
+        BenchReport("matrix multiply", "math", start, sum);
+        for (int m = 0; m < IMPL_COUNT; m++) {
+                start = Seconds();
+                sum = 0.0f;
+                for (int p = 0; p < BENCH_PASSES; p++) {
+                        impls[m].multiplyBatch(mats, &mats[0], matsOut, BENCH_COUNT);
+                        sum += matsOut[p % BENCH_COUNT].m[0][0];
+                }
+                BenchReport("matrix multiply", impls[m].name, start, sum);
+        }
+}
+
+int main(int argc, char **argv) {
+        RandomizeInputs();
+
+        if (argc > 1 && 0 == strcmp(argv[1], "bench")) {
+                Bench();
+                return EXIT_SUCCESS;
+        }
+
+        GSTestRun(TestMultiplyVec3);
+        GSTestRun(TestMultiply);
+        GSTestRun(TestTransformBatch);
+        GSTestRun(TestNormalizeBatch);
+        GSTestRun(TestCrossProductBatch);
+        GSTestRun(TestMultiplyBatch);
+        GSTestRun(TestFrustumTestSpheres);
+
+        return GSTestSummary("simd");
+}
@@ -4,7 +4,7 @@
 
   File: texture.c
   Created: 2019-08-18
-  Updated: 2019-08-26
+  Updated: 2026-10-18
   Author: Aaron Oman
   Notice: GNU GPLv3 License
 
@@ -16,8 +16,9 @@
 
 //! \file texture.c
 
-#include <stdlib.h> // malloc, sizeof
-#include <string.h> // memset
+#include <stdlib.h> // malloc, realloc, sizeof
+#include <string.h> // memset, strcmp, strdup
+#include <stdio.h> // fprintf
 
 #include "texture.h"
 
@@ -31,6 +32,7 @@ struct texture *TextureInitFromFile(char *file) {
 
         t->data = stbi_load(file, &t->width, &t->height, &t->numBytesPerPixel, 4);
         if (NULL == t->data) {
+                free(t);
                 return NULL;
         }
 
@@ -70,3 +72,45 @@ unsigned int TextureSample(struct texture *t, float u, float v) {
 
         return result;
 }
+
+struct texture_cache *TextureCacheInit(void) {
+        struct texture_cache *cache = (struct texture_cache *)malloc(sizeof(struct texture_cache));
+        memset(cache, 0, sizeof(struct texture_cache));
+        return cache;
+}
+
+void TextureCacheDeinit(struct texture_cache *cache) {
+        if (NULL == cache)
+                return;
+
+        for (int i = 0; i < cache->count; i++) {
+                free(cache->files[i]);
+                TextureDeinit(cache->textures[i]);
+        }
+        free(cache->files);
+        free(cache->textures);
+        free(cache);
+}
+
+struct texture *TextureCacheGet(struct texture_cache *cache, char *file) {
+        for (int i = 0; i < cache->count; i++) {
+                if (0 == strcmp(cache->files[i], file)) {
+                        return cache->textures[i];
+                }
+        }
+
+        if (cache->count == cache->capacity) {
+                cache->capacity = cache->capacity < 8 ? 8 : cache->capacity * 2;
+                cache->files = (char **)realloc(cache->files, sizeof(char *) * cache->capacity);
+                cache->textures = (struct texture **)realloc(cache->textures, sizeof(struct texture *) * cache->capacity);
+        }
+
+        struct texture *texture = TextureInitFromFile(file);
+        if (NULL == texture) {
+                fprintf(stderr, "Couldn't load texture %s\n", file);
+        }
+        cache->files[cache->count] = strdup(file);
+        cache->textures[cache->count] = texture;
+        cache->count++;
+        return texture;
+}
@@ -4,7 +4,7 @@
 
   File: texture.h
   Created: 2019-08-18
-  Updated: 2019-08-27
+  Updated: 2026-10-18
   Author: Aaron Oman
   Notice: GNU GPLv3 License
 
@@ -32,7 +32,7 @@ struct texture {
 //! This uses [stb_image](https://github.com/nothings/stb/blob/master/stb_image.h), and thus all the image formats supported by that library.
 //!
 //! \param[in] file Path to the image file to load
-//! \return an initialized texture object
+//! \return an initialized texture object, or NULL if the file couldn't be loaded
 struct texture *
 TextureInitFromFile(char *file);
 
@@ -53,4 +53,38 @@ TextureDeinit(struct texture *texture);
 unsigned int
 TextureSample(struct texture *texture, float u, float v);
 
+//! \brief Textures loaded by file name, each loaded at most once
+//!
+//! Texture i was loaded from files[i]. Files that couldn't be loaded are
+//! remembered with a NULL texture so they aren't retried.
+struct texture_cache {
+        char **files;
+        struct texture **textures;
+        int count;
+        int capacity;
+};
+
+//! \brief Initialize a new, empty texture cache
+//!
+//! \return the initialized texture cache
+struct texture_cache *
+TextureCacheInit(void);
+
+//! \brief De-initialize a texture cache and every texture in it
+//!
+//! \param[in,out] cache the texture cache to de-initialize
+void
+TextureCacheDeinit(struct texture_cache *cache);
+
+//! \brief Find a texture, loading it with TextureInitFromFile() if it isn't cached
+//!
+//! The texture belongs to the cache and stays valid until the cache is
+//! de-initialized.
+//!
+//! \param[in,out] cache the texture cache to search
+//! \param[in] file path to the image file
+//! \return the texture, or NULL if the file couldn't be loaded
+struct texture *
+TextureCacheGet(struct texture_cache *cache, char *file);
+
 #endif // TEXTURE_VERSION